@@ -3,6 +3,18 @@
 namespace mrta
 {
 
+// Parameter change event, identified by the index of the parameter
+// in the ParameterInfo vector of the ParameterManager
+// The time is the high resolution tick count of the change for events coming
+// from the APVTS listeners, or the sample offset in the next block for events
+// pushed with ParameterManager::pushParameterEvent()
+struct ParameterEvent
+{
+    uint16_t index { 0 };
+    float value { 0.f };
+    int64_t time { 0 };
+};
+
 template<size_t Capacity>
 class ParameterFIFO
 {
@@ -18,7 +30,7 @@ public:
         abstractFIFO.reset();
     }
 
-    bool pushParameter(const juce::String& parameterID, float newValue)
+    bool pushParameter(uint16_t index, float newValue, int64_t time = 0)
     {
         if (abstractFIFO.getFreeSpace() == 0)
             return false;
@@ -26,33 +38,40 @@ public:
         auto scope = abstractFIFO.write(1);
 
         if (scope.blockSize1 > 0)
-            buffer[scope.startIndex1] = std::make_pair(parameterID, newValue);
+            buffer[scope.startIndex1] = { index, newValue, time };
 
         if (scope.blockSize2 > 0)
-            buffer[scope.startIndex2] = std::make_pair(parameterID, newValue);
+            buffer[scope.startIndex2] = { index, newValue, time };
 
         return true;
     }
 
-    std::pair<bool, std::pair<juce::String, float>> popParameter()
+    // Pops the oldest event into 'event', returns false if the queue is empty
+    bool popParameter(ParameterEvent& event)
     {
         if (abstractFIFO.getNumReady() == 0)
-            return {};
+            return false;
 
         auto scope = abstractFIFO.read(1);
 
         if (scope.blockSize1 > 0)
-            return { true, buffer[scope.startIndex1] };
+        {
+            event = buffer[scope.startIndex1];
+            return true;
+        }
 
         if (scope.blockSize2 > 0)
-            return {true, buffer[scope.startIndex2] };
+        {
+            event = buffer[scope.startIndex2];
+            return true;
+        }
 
-        return { false, { "", 0.f } };
+        return false;
     }
 
 private:
     juce::AbstractFifo abstractFIFO;
-    std::array<std::pair<juce::String, float>, Capacity> buffer;
+    std::array<ParameterEvent, Capacity> buffer;
 
     JUCE_DECLARE_NON_COPYABLE(ParameterFIFO)
     JUCE_DECLARE_NON_MOVEABLE(ParameterFIFO)
@@ -49,57 +49,193 @@ juce::AudioProcessorValueTreeState::ParameterLayout createParameterLayout(const
     return layout;
 }
 
-ParameterManager::ParameterManager(juce::AudioProcessor& audioProcessor, const juce::String& identifier, const std::vector<mrta::ParameterInfo>& _parameters) :
+ParameterManager::ParameterManager(juce::AudioProcessor& audioProcessor, const juce::String& identifier, const std::vector<mrta::ParameterInfo>& _parameters, QueueMode _queueMode) :
     apvts(audioProcessor, nullptr, identifier, createParameterLayout(_parameters)),
-    parameters { _parameters }
+    parameters { _parameters },
+    queueMode { _queueMode },
+    table(_parameters.size()),
+    callbacks(_parameters.size()),
+    listeners(_parameters.size())
 {
+    // Events carry 16 bit indices
+    jassert(parameters.size() <= std::numeric_limits<uint16_t>::max());
+
+    rawValues.reserve(parameters.size());
+    for (const auto& info : parameters)
+        rawValues.push_back(apvts.getRawParameterValue(info.ID));
 }
 
 ParameterManager::~ParameterManager()
 {
-    for (const auto& c : callbacks)
-        apvts.removeParameterListener(c.first, this);
+    for (size_t i = 0; i < listeners.size(); ++i)
+        if (listeners[i] != nullptr)
+            apvts.removeParameterListener(parameters[i].ID, listeners[i].get());
 }
 
 bool ParameterManager::registerParameterCallback(const juce::String& ID, Callback cb)
 {
-    if (ID.isNotEmpty() && cb)
+    const int index { getParameterIndex(ID) };
+    if (index >= 0 && cb)
     {
-        if (callbacks.find(ID) == callbacks.end())
+        const size_t i { static_cast<size_t>(index) };
+        if (!callbacks[i])
         {
-            apvts.addParameterListener(ID, this);
-            callbacks[ID] = cb;
+            callbacks[i] = cb;
+            listeners[i] = std::make_unique<ParameterListener>(*this, static_cast<uint16_t>(index));
+            apvts.addParameterListener(ID, listeners[i].get());
             return true;
         }
     }
     return false;
 }
 
+int ParameterManager::getParameterIndex(const juce::String& ID) const
+{
+    if (ID.isEmpty())
+        return -1;
+
+    for (size_t i = 0; i < parameters.size(); ++i)
+        if (parameters[i].ID == ID)
+            return static_cast<int>(i);
+
+    return -1;
+}
+
 void ParameterManager::updateParameters(bool force)
 {
     if (force)
     {
-        std::for_each(callbacks.begin(), callbacks.end(), [this] (auto& p)
+        for (size_t i = 0; i < callbacks.size(); ++i)
+            if (callbacks[i] && rawValues[i] != nullptr)
+                callbacks[i](rawValues[i]->load(), true);
+        fifo.clear();
+        table.clear();
+    }
+
+    // Forced updates come from prepareToPlay, the queue is drained on the audio thread
+    mrta::RealtimeScope realtimeScope("ParameterManager::updateParameters");
+
+    if (queueMode == Coalescing)
+    {
+        table.drain([this] (uint16_t index, float value, int64_t /*time*/)
         {
-            if (auto* raw { apvts.getRawParameterValue(p.first) })
-                p.second(raw->load(), true);
+            if (callbacks[index])
+                callbacks[index](value, false);
         });
-        fifo.clear();
     }
+    else
+    {
+        ParameterEvent event;
+        while (fifo.popParameter(event))
+        {
+            if (event.index < callbacks.size() && callbacks[event.index])
+                callbacks[event.index](event.value, false);
+        }
+    }
+
+    // Without sub-block splitting the offset events apply at the start of the block
+    ParameterEvent event;
+    while (offsetEvents.popParameter(event))
+    {
+        if (callbacks[event.index])
+            callbacks[event.index](event.value, false);
+    }
+}
+
+void ParameterManager::beginBlock(int numSamples)
+{
+    mrta::RealtimeScope realtimeScope("ParameterManager::beginBlock");
+
+    numBlockEvents = 0;
+    nextBlockEvent = 0;
+    numSamples = std::max(numSamples, 1);
+
+    // Hosts send APVTS changes right before processBlock and carry no sample time,
+    // they apply at the start of the block as updateParameters() does
+    if (queueMode == Coalescing)
+    {
+        table.drain([this] (uint16_t index, float value, int64_t /*time*/)
+        {
+            addBlockEvent(index, value, 0);
+        });
+    }
+    else
+    {
+        ParameterEvent event;
+        while (fifo.popParameter(event))
+            if (event.index < callbacks.size())
+                addBlockEvent(event.index, event.value, 0);
+    }
+
+    ParameterEvent event;
+    while (offsetEvents.popParameter(event))
+        addBlockEvent(event.index, event.value, static_cast<int>(std::clamp(event.time, static_cast<int64_t>(0), static_cast<int64_t>(numSamples - 1))));
+
+    // Stable insertion sort by offset, events mostly arrive in order
+    for (size_t i = 1; i < numBlockEvents; ++i)
+    {
+        const BlockEvent e { blockEvents[i] };
+        size_t j { i };
+        for (; j > 0 && blockEvents[j - 1].sampleOffset > e.sampleOffset; --j)
+            blockEvents[j] = blockEvents[j - 1];
+        blockEvents[j] = e;
+    }
+}
+
+void ParameterManager::dispatchEvents(int sampleOffset)
+{
+    mrta::RealtimeScope realtimeScope("ParameterManager::dispatchEvents");
 
-    auto newParam = fifo.popParameter();
-    while (newParam.first)
+    for (; nextBlockEvent < numBlockEvents && blockEvents[nextBlockEvent].sampleOffset <= sampleOffset; ++nextBlockEvent)
     {
-        auto it = callbacks.find(newParam.second.first);
-        if (it != callbacks.end())
-            it->second(newParam.second.second, false);
-        newParam = fifo.popParameter();
+        const BlockEvent& e { blockEvents[nextBlockEvent] };
+        if (callbacks[e.index])
+            callbacks[e.index](e.value, false);
     }
 }
 
+void ParameterManager::endBlock()
+{
+    dispatchEvents(std::numeric_limits<int>::max());
+}
+
+int ParameterManager::getNextEventOffset(int fromSample) const
+{
+    for (size_t i = nextBlockEvent; i < numBlockEvents; ++i)
+        if (blockEvents[i].sampleOffset >= fromSample)
+            return blockEvents[i].sampleOffset;
+
+    return std::numeric_limits<int>::max();
+}
+
+bool ParameterManager::pushParameterEvent(int index, float value, int sampleOffset)
+{
+    if (index < 0 || index >= static_cast<int>(callbacks.size()))
+        return false;
+
+    return offsetEvents.pushParameter(static_cast<uint16_t>(index), value, sampleOffset);
+}
+
+void ParameterManager::addBlockEvent(uint16_t index, float value, int sampleOffset)
+{
+    if (numBlockEvents < MaxBlockEvents)
+    {
+        blockEvents[numBlockEvents++] = { index, value, sampleOffset };
+        return;
+    }
+
+    // Block is full, apply at the start of the block rather than losing the change
+    if (callbacks[index])
+        callbacks[index](value, false);
+}
+
 void ParameterManager::clearParameterQueue()
 {
     fifo.clear();
+    table.clear();
+    offsetEvents.clear();
+    numBlockEvents = 0;
+    nextBlockEvent = 0;
 }
 
 const std::vector<mrta::ParameterInfo>& ParameterManager::getParameters() const
@@ -124,9 +260,20 @@ void ParameterManager::getStateInformation(juce::MemoryBlock& destData)
     apvts.state.writeToStream(mos);
 }
 
-void ParameterManager::parameterChanged(const juce::String& parameterID, float newValue)
+ParameterManager::ParameterListener::ParameterListener(ParameterManager& _owner, uint16_t _index) :
+    owner { _owner },
+    index { _index }
 {
-    fifo.pushParameter(parameterID, newValue);
+}
+
+void ParameterManager::ParameterListener::parameterChanged(const juce::String& /*parameterID*/, float newValue)
+{
+    const int64_t now { juce::Time::getHighResolutionTicks() };
+
+    if (owner.queueMode == Coalescing)
+        owner.table.setParameter(index, newValue, now);
+    else
+        owner.fifo.pushParameter(index, newValue, now);
 }
 
 }
@@ -3,16 +3,24 @@
 namespace mrta
 {
 
-class ParameterManager : public juce::AudioProcessorValueTreeState::Listener
+class ParameterManager
 {
 public:
     // Callback function type alias
     using Callback = std::function<void(float value, bool forced)>;
 
+    // How parameter changes are queued for the audio thread
+    enum QueueMode : uint32_t
+    {
+        FIFO = 0,       // Every change in order, changes are dropped when the queue is full
+        Coalescing      // Only the latest value of each parameter, nothing is ever dropped
+    };
+
     // Main ctor
     ParameterManager(juce::AudioProcessor& audioProcessor,
                      const juce::String& identifier,
-                     const std::vector<mrta::ParameterInfo>& parameters);
+                     const std::vector<mrta::ParameterInfo>& parameters,
+                     QueueMode queueMode = FIFO);
 
     // No default ctor
     ParameterManager() = delete;
@@ -25,6 +33,10 @@ public:
     // to avoid missing parameter events
     bool registerParameterCallback(const juce::String& ID, Callback cb);
 
+    // Get the index of a parameter in the parameters vector, -1 if there is no such ID
+    // Parameter events are queued and dispatched by this index
+    int getParameterIndex(const juce::String& ID) const;
+
     // Checks if there are parameter change events on the queue
     // and call the respective callbacks for them
     // This method is supposed to be calle on every process buffer
@@ -35,6 +47,27 @@ public:
     // good way to guarantee the DSP has updated parameters
     void updateParameters(bool force = false);
 
+    // Sample accurate alternative to updateParameters(), for processors
+    // that split their blocks at parameter changes:
+    // - beginBlock() collects the pending events and places them in the block,
+    //   changes made through the APVTS apply at its start, events pushed with
+    //   pushParameterEvent() land on their offset
+    // - dispatchEvents() calls the callbacks of the events up to a sample offset
+    // - getNextEventOffset() tells where the sub-block starting at an offset has to end
+    // - endBlock() calls the callbacks of the events left after the last sub-block,
+    //   events too close to its start or in an empty block, so none is ever dropped
+    // All four are meant to be called from the audio thread only
+    void beginBlock(int numSamples);
+    void dispatchEvents(int sampleOffset);
+    int getNextEventOffset(int fromSample) const;
+    void endBlock();
+
+    // Queue a parameter change at a sample offset of the next block, for hosts and
+    // offline tools with sample accurate automation. Must be called from the thread
+    // calling processBlock. Returns false if the queue is full.
+    // The value is not written to the APVTS, only the callback sees it
+    bool pushParameterEvent(int index, float value, int sampleOffset);
+
     // Empty the paramter event queue
     void clearParameterQueue();
 
@@ -55,15 +88,48 @@ public:
     // uses for parameter state load and save
     void getStateInformation(juce::MemoryBlock& destData);
 
-    // Parameter change listener, this function is not meant to
-    // be called by user, it is used by the APVTS listerners only
-    void parameterChanged(const juce::String& parameterID, float newValue) override;
-
 private:
+    // APVTS listener of a single parameter, queues its changes by index
+    class ParameterListener : public juce::AudioProcessorValueTreeState::Listener
+    {
+    public:
+        ParameterListener(ParameterManager& owner, uint16_t index);
+        void parameterChanged(const juce::String& parameterID, float newValue) override;
+
+    private:
+        ParameterManager& owner;
+        const uint16_t index;
+    };
+
     juce::AudioProcessorValueTreeState apvts;
     std::vector<mrta::ParameterInfo> parameters;
+    // Place an event in the current block, dispatches it right away if the block is full
+    void addBlockEvent(uint16_t index, float value, int sampleOffset);
+
+    const QueueMode queueMode;
     mrta::ParameterFIFO<64> fifo;
-    std::unordered_map<juce::String, Callback> callbacks;
+    mrta::ParameterTable table;
+
+    // Events with sample offsets pushed by the thread calling processBlock
+    mrta::ParameterFIFO<256> offsetEvents;
+
+    // Events of the current block sorted by sample offset
+    struct BlockEvent
+    {
+        uint16_t index { 0 };
+        float value { 0.f };
+        int sampleOffset { 0 };
+    };
+
+    static constexpr size_t MaxBlockEvents { 256 };
+    std::array<BlockEvent, MaxBlockEvents> blockEvents;
+    size_t numBlockEvents { 0 };
+    size_t nextBlockEvent { 0 };
+
+    // Flat tables indexed by parameter index
+    std::vector<Callback> callbacks;
+    std::vector<std::unique_ptr<ParameterListener>> listeners;
+    std::vector<std::atomic<float>*> rawValues;
 
     JUCE_DECLARE_NON_COPYABLE(ParameterManager)
     JUCE_DECLARE_NON_MOVEABLE(ParameterManager)
@@ -71,4 +137,3 @@ private:
 };
 
 }
-
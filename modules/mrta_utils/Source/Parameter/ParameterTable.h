@@ -0,0 +1,81 @@
+#pragma once
+
+namespace mrta
+{
+
+// Lock-free table holding the latest value of every parameter plus a dirty bit
+// Writers on any thread overwrite the value and mark it dirty, the audio thread drains
+// the dirty parameters once per block. Events are coalesced, so there is no capacity to
+// overflow, the final value is never dropped and draining costs O(dirty) regardless of
+// how dense the automation is.
+class ParameterTable
+{
+public:
+    explicit ParameterTable(size_t numParameters) :
+        values(numParameters),
+        times(numParameters),
+        dirtyWords((numParameters + BitsPerWord - 1) / BitsPerWord)
+    {
+        clear();
+    }
+
+    void clear()
+    {
+        for (auto& word : dirtyWords)
+            word.store(0, std::memory_order_relaxed);
+    }
+
+    // Store the latest value of a parameter and the time of the change,
+    // can be called from any thread
+    void setParameter(uint16_t index, float newValue, int64_t time = 0)
+    {
+        if (index >= values.size())
+            return;
+
+        values[index].store(newValue, std::memory_order_relaxed);
+        times[index].store(time, std::memory_order_relaxed);
+        dirtyWords[index / BitsPerWord].fetch_or(uint64_t { 1 } << (index % BitsPerWord), std::memory_order_release);
+    }
+
+    // Call callback(index, value, time) once for every parameter set since the last call,
+    // lowest index first, meant to be called from the audio thread only
+    template<typename Callback>
+    void drain(Callback&& callback)
+    {
+        for (size_t w = 0; w < dirtyWords.size(); ++w)
+        {
+            // A write racing with the drain marks the parameter dirty again for the next block
+            uint64_t bits { dirtyWords[w].exchange(0, std::memory_order_acquire) };
+            while (bits != 0)
+            {
+                const uint16_t index { static_cast<uint16_t>(w * BitsPerWord + countTrailingZeros(bits)) };
+                bits &= bits - 1;
+                callback(index, values[index].load(std::memory_order_relaxed), times[index].load(std::memory_order_relaxed));
+            }
+        }
+    }
+
+private:
+    static constexpr size_t BitsPerWord { 64 };
+
+    static unsigned int countTrailingZeros(uint64_t bits)
+    {
+       #if JUCE_MSVC
+        unsigned long index;
+        _BitScanForward64(&index, bits);
+        return static_cast<unsigned int>(index);
+       #else
+        return static_cast<unsigned int>(__builtin_ctzll(bits));
+       #endif
+    }
+
+    std::vector<std::atomic<float>> values;
+    std::vector<std::atomic<int64_t>> times;
+    std::vector<std::atomic<uint64_t>> dirtyWords;
+
+    JUCE_DECLARE_NON_COPYABLE(ParameterTable)
+    JUCE_DECLARE_NON_MOVEABLE(ParameterTable)
+    JUCE_LEAK_DETECTOR(ParameterTable)
+};
+
+}
@@ -0,0 +1,336 @@
+#include <atomic>
+#include <cstdlib>
+#include <cstdio>
+#include <new>
+#include <string>
+
+// Scopes are tracked by debug builds, for RealtimeScope::isActive(), and by builds with the checks
+#if JUCE_DEBUG || MRTA_REALTIME_CHECKS
+ #define MRTA_REALTIME_SCOPES 1
+#endif
+
+// Global operator new/delete are only replaced by builds with the checks, other builds
+// and the plugins loaded by a host keep the allocator of the runtime
+#if MRTA_REALTIME_CHECKS
+ #define MRTA_REALTIME_HOOKS 1
+#endif
+
+#if MRTA_REALTIME_CHECKS && (JUCE_LINUX || JUCE_MAC || JUCE_BSD)
+ #include <execinfo.h>
+ #define MRTA_REALTIME_STACKS 1
+#endif
+
+#if MRTA_REALTIME_CHECKS && JUCE_LINUX && defined(__GLIBC__)
+ #include <dlfcn.h>
+ #include <pthread.h>
+ #define MRTA_REALTIME_LIBC_HOOKS 1
+
+// glibc entry points behind malloc and friends, used to forward the intercepted calls
+extern "C"
+{
+    void* __libc_malloc(size_t);
+    void* __libc_calloc(size_t, size_t);
+    void* __libc_realloc(void*, size_t);
+    void __libc_free(void*);
+}
+#endif
+
+namespace mrta
+{
+
+namespace
+{
+#if MRTA_REALTIME_SCOPES
+    // Nesting depth and innermost section of the scopes alive on this thread
+    thread_local int scopeDepth { 0 };
+    thread_local const char* scopeSectionName { nullptr };
+#endif
+
+#if MRTA_REALTIME_CHECKS
+    // Set while a violation is handled, the handler itself may allocate or lock
+    thread_local bool handlingViolation { false };
+
+    struct Violation
+    {
+        RealtimeChecks::Kind kind { RealtimeChecks::Allocation };
+        size_t numBytes { 0 };
+        const char* sectionName { nullptr };
+        int numFrames { 0 };
+        void* frames[RealtimeChecks::MaxStackFrames] { };
+    };
+
+    // Fixed size log, recording a violation must not allocate
+    Violation violationLog[RealtimeChecks::MaxLoggedViolations];
+    std::atomic<unsigned int> numViolations { 0 };
+
+    // Stack frames of the checker itself, skipped in the report
+    constexpr int CheckerStackFrames { 2 };
+
+    // Print what is left in the log when the executable exits
+    struct ExitReport
+    {
+        ~ExitReport()
+        {
+            if (RealtimeChecks::getNumViolations() > 0)
+                std::fprintf(stderr, "%s", RealtimeChecks::getReport().c_str());
+        }
+    };
+
+    ExitReport exitReport;
+#endif
+
+#if MRTA_REALTIME_STACKS
+    // The first backtrace() call loads the unwinder, get it done before any real-time code runs
+    [[maybe_unused]] const int backtraceWarmUp { [] { void* frame; return backtrace(&frame, 1); }() };
+#endif
+
+#if MRTA_REALTIME_LIBC_HOOKS
+    using MutexLockFunction = int (*)(pthread_mutex_t*);
+
+    // Next definition of pthread_mutex_lock, resolved on first use
+    // A plain atomic, function local statics may lock themselves
+    std::atomic<MutexLockFunction> nextMutexLock { nullptr };
+#endif
+
+#if MRTA_REALTIME_HOOKS
+    void* allocate(size_t numBytes)
+    {
+    #if MRTA_REALTIME_LIBC_HOOKS
+        return __libc_malloc(numBytes);
+    #else
+        return std::malloc(numBytes);
+    #endif
+    }
+
+    void deallocate(void* ptr)
+    {
+    #if MRTA_REALTIME_LIBC_HOOKS
+        __libc_free(ptr);
+    #else
+        std::free(ptr);
+    #endif
+    }
+#endif
+}
+
+RealtimeScope::RealtimeScope(const char* sectionName)
+{
+#if MRTA_REALTIME_SCOPES
+    previousSectionName = scopeSectionName;
+    scopeSectionName = sectionName;
+    ++scopeDepth;
+#else
+    juce::ignoreUnused(sectionName);
+#endif
+}
+
+RealtimeScope::~RealtimeScope()
+{
+#if MRTA_REALTIME_SCOPES
+    --scopeDepth;
+    scopeSectionName = previousSectionName;
+#endif
+}
+
+bool RealtimeScope::isActive()
+{
+#if MRTA_REALTIME_SCOPES
+    return scopeDepth > 0;
+#else
+    return false;
+#endif
+}
+
+const char* RealtimeScope::getSectionName()
+{
+#if MRTA_REALTIME_SCOPES
+    return scopeSectionName;
+#else
+    return nullptr;
+#endif
+}
+
+bool RealtimeChecks::isEnabled()
+{
+#if MRTA_REALTIME_CHECKS
+    return true;
+#else
+    return false;
+#endif
+}
+
+unsigned int RealtimeChecks::getNumViolations()
+{
+#if MRTA_REALTIME_CHECKS
+    return numViolations.load();
+#else
+    return 0;
+#endif
+}
+
+void RealtimeChecks::reset()
+{
+#if MRTA_REALTIME_CHECKS
+    numViolations.store(0);
+#endif
+}
+
+const char* RealtimeChecks::getKindName(Kind kind)
+{
+    switch (kind)
+    {
+        case Allocation: return "allocation";
+        case Deallocation: return "deallocation";
+        case Lock: return "mutex lock";
+        default: return "unknown";
+    }
+}
+
+std::string RealtimeChecks::getReport(unsigned int maxViolations, unsigned int maxStackFrames)
+{
+#if MRTA_REALTIME_CHECKS
+    const unsigned int total { numViolations.load() };
+    const unsigned int numReported { std::min({ total, MaxLoggedViolations, maxViolations }) };
+
+    std::string report { std::to_string(total) + " real-time violation(s)\n" };
+
+    for (unsigned int i = 0; i < numReported; ++i)
+    {
+        const Violation& v { violationLog[i] };
+
+        report += "  " + std::string(getKindName(v.kind));
+        if (v.numBytes > 0)
+            report += " of " + std::to_string(v.numBytes) + " bytes";
+        report += " in " + std::string(v.sectionName != nullptr ? v.sectionName : "?") + "\n";
+
+    #if MRTA_REALTIME_STACKS
+        if (char** symbols { backtrace_symbols(v.frames, v.numFrames) })
+        {
+            const int lastFrame { std::min(v.numFrames, CheckerStackFrames + static_cast<int>(maxStackFrames)) };
+            for (int f = CheckerStackFrames; f < lastFrame; ++f)
+                report += "      " + std::string(symbols[f]) + "\n";
+            std::free(symbols);
+        }
+    #else
+        juce::ignoreUnused(maxStackFrames);
+    #endif
+    }
+
+    if (total > numReported)
+        report += "  ... and " + std::to_string(total - numReported) + " more\n";
+
+    return report;
+#else
+    juce::ignoreUnused(maxViolations, maxStackFrames);
+    return "Real-time checks are disabled, build with MRTA_REALTIME_CHECKS\n";
+#endif
+}
+
+void RealtimeChecks::recordViolation(Kind kind, size_t numBytes)
+{
+#if MRTA_REALTIME_CHECKS
+    if (scopeDepth == 0 || handlingViolation)
+        return;
+
+    handlingViolation = true;
+
+    const unsigned int index { numViolations.fetch_add(1) };
+    if (index < MaxLoggedViolations)
+    {
+        Violation& v { violationLog[index] };
+        v.kind = kind;
+        v.numBytes = numBytes;
+        v.sectionName = scopeSectionName;
+      #if MRTA_REALTIME_STACKS
+        v.numFrames = backtrace(v.frames, static_cast<int>(MaxStackFrames));
+      #else
+        v.numFrames = 0;
+      #endif
+    }
+
+    handlingViolation = false;
+#else
+    juce::ignoreUnused(kind, numBytes);
+#endif
+}
+
+}
+
+#if MRTA_REALTIME_HOOKS
+
+// Replacement of the global allocation functions
+// The array, nothrow and sized forms forward to these by default
+void* operator new(std::size_t size)
+{
+    mrta::RealtimeChecks::recordViolation(mrta::RealtimeChecks::Allocation, size);
+
+    if (void* ptr { mrta::allocate(size == 0 ? 1 : size) })
+        return ptr;
+
+    throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept
+{
+    if (ptr != nullptr)
+        mrta::RealtimeChecks::recordViolation(mrta::RealtimeChecks::Deallocation, 0);
+
+    mrta::deallocate(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept
+{
+    ::operator delete(ptr);
+}
+
+#endif
+
+#if MRTA_REALTIME_LIBC_HOOKS
+
+// Interposed C allocation and locking functions, forwarded to glibc
+extern "C"
+{
+
+void* malloc(size_t size) __THROW
+{
+    mrta::RealtimeChecks::recordViolation(mrta::RealtimeChecks::Allocation, size);
+    return __libc_malloc(size);
+}
+
+void* calloc(size_t num, size_t size) __THROW
+{
+    mrta::RealtimeChecks::recordViolation(mrta::RealtimeChecks::Allocation, num * size);
+    return __libc_calloc(num, size);
+}
+
+void* realloc(void* ptr, size_t size) __THROW
+{
+    mrta::RealtimeChecks::recordViolation(mrta::RealtimeChecks::Allocation, size);
+    return __libc_realloc(ptr, size);
+}
+
+void free(void* ptr) __THROW
+{
+    if (ptr != nullptr)
+        mrta::RealtimeChecks::recordViolation(mrta::RealtimeChecks::Deallocation, 0);
+
+    __libc_free(ptr);
+}
+
+int pthread_mutex_lock(pthread_mutex_t* mutex) __THROWNL
+{
+    mrta::RealtimeChecks::recordViolation(mrta::RealtimeChecks::Lock, 0);
+
+    mrta::MutexLockFunction next { mrta::nextMutexLock.load(std::memory_order_acquire) };
+    if (next == nullptr)
+    {
+        next = reinterpret_cast<mrta::MutexLockFunction>(dlsym(RTLD_NEXT, "pthread_mutex_lock"));
+        mrta::nextMutexLock.store(next, std::memory_order_release);
+    }
+
+    return next(mutex);
+}
+
+}
+
+#endif
@@ -0,0 +1,75 @@
+#pragma once
+
+namespace mrta
+{
+
+// Marks the calling thread as running real-time code for the lifetime of the object,
+// e.g. processBlock, renderNextBlock or ParameterManager::updateParameters
+// Builds with MRTA_REALTIME_CHECKS record allocations, frees and mutex locks made inside
+// a scope, see RealtimeChecks. Debug builds only track the scopes, for isActive() and
+// getSectionName(), and leave the allocator alone. In release builds this class does nothing.
+// Scopes can be nested, the innermost section name is the one reported
+class RealtimeScope
+{
+public:
+    // Section name must be a string literal, it is kept by pointer
+    explicit RealtimeScope(const char* sectionName);
+    ~RealtimeScope();
+
+    // Returns true if the calling thread is inside a scope
+    static bool isActive();
+
+    // Name of the innermost scope of the calling thread, nullptr if none
+    static const char* getSectionName();
+
+private:
+    const char* previousSectionName { nullptr };
+
+    JUCE_DECLARE_NON_COPYABLE(RealtimeScope)
+    JUCE_DECLARE_NON_MOVEABLE(RealtimeScope)
+};
+
+// Log of real-time safety violations, only recorded by builds with MRTA_REALTIME_CHECKS
+// The checks are enabled per target with the REALTIME_CHECKS flag of add_plugin / add_tool,
+// or for every target with -DMRTA_REALTIME_CHECKS=ON.
+// operator new/delete are intercepted on every platform, malloc/free and pthread mutex locks
+// on Linux. Only calls resolved inside the executable are intercepted, so run the checks with
+// the Standalone target or an offline tool rather than a plugin loaded by a host.
+// Executables print the report on exit if there are violations left.
+class RealtimeChecks
+{
+public:
+    enum Kind
+    {
+        Allocation,
+        Deallocation,
+        Lock
+    };
+
+    // True if this binary was built with MRTA_REALTIME_CHECKS
+    static bool isEnabled();
+
+    // Number of violations since the last reset, including the ones not kept in the log
+    static unsigned int getNumViolations();
+
+    // Forget all recorded violations, must not be called while processing
+    static void reset();
+
+    // Human readable report of the first violations, each with a snippet of its call stack
+    // Allocates, must not be called while processing
+    static std::string getReport(unsigned int maxViolations = 8, unsigned int maxStackFrames = 8);
+
+    // Record a violation if the calling thread is inside a RealtimeScope, used by the interceptors
+    static void recordViolation(Kind kind, size_t numBytes);
+
+    static const char* getKindName(Kind kind);
+
+    // Violations kept in the log with their call stack
+    static constexpr unsigned int MaxLoggedViolations { 64 };
+    static constexpr unsigned int MaxStackFrames { 24 };
+
+    // No instances
+    RealtimeChecks() = delete;
+};
+
+}
@@ -10,4 +10,5 @@
 #include "mrta_utils.h"
 
 #include "Source/Parameter/ParameterManager.cpp"
+#include "Source/Realtime/RealtimeChecks.cpp"
 #include "Source/GUI/GenericParameterEditor.cpp"
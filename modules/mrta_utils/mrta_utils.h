@@ -23,8 +23,10 @@
 #include <juce_audio_processors/juce_audio_processors.h>
 
 #include "Source/Parameter/ParameterFIFO.h"
+#include "Source/Parameter/ParameterTable.h"
 #include "Source/Parameter/ParameterInfo.h"
 #include "Source/Parameter/ParameterManager.h"
+#include "Source/Realtime/RealtimeChecks.h"
 #include "Source/GUI/ParameterComponents.h"
 #include "Source/GUI/GenericParameterEditor.h"
 
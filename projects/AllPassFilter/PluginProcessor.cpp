@@ -63,6 +63,7 @@ void AllPassFilterProcessor::releaseResources()
 void AllPassFilterProcessor::processBlock(juce::AudioBuffer<float>& buffer, juce::MidiBuffer& /*midiMessages*/)
 {
     juce::ScopedNoDenormals noDenormals;
+    mrta::RealtimeScope realtimeScope("AllPassFilterProcessor::processBlock");
     parameterManager.updateParameters();
 
     const unsigned int numChannels{ static_cast<unsigned int>(buffer.getNumChannels()) };
@@ -55,6 +55,7 @@ void AmpModelProcessor::prepareToPlay(double sampleRate, int samplesPerBlock)
 void AmpModelProcessor::processBlock(juce::AudioBuffer<float>& buffer, juce::MidiBuffer& /*midiMessages*/)
 {
     juce::ScopedNoDenormals noDenormals;
+    mrta::RealtimeScope realtimeScope("AmpModelProcessor::processBlock");
     parameterManager.updateParameters();
 
     const float * const * nn_input_read_ptr = nnInputBuffer.getArrayOfReadPointers();
@@ -1,5 +1,8 @@
 #include "AllPass.h"
 
+#include <algorithm>
+#include <cmath>
+
 namespace DSP
 {
 
@@ -20,7 +20,10 @@ public:
     const Biquad& operator=(Biquad&&) = delete;
 
     static const unsigned int CoeffsPerSection = 5;
-    static const unsigned int StatesPerSection = 4;
+    static const unsigned int StatesPerSection = 2;
+
+    // Maximum number of samples the block processing interleaves at once
+    static constexpr unsigned int ChunkSamples { 64 };
 
     // Clear all states
     void clear();
@@ -38,12 +41,16 @@ public:
 
     // Process audio
     // This method can be called with a lower number of channels than allocated
+    // Sections are transposed direct form II, channels run in pairs, one per SIMD lane
     void process(float* const* output, const float* const* input, unsigned int numChannels, unsigned int numSamples);
 
     // Process audio
     // Single sample flavour
     void process(float* output, const float* input, unsigned int numChannels);
 
+    // Get the coeffs of a section, zeros past the allocated sections
+    std::array<float, CoeffsPerSection> getSectionCoeffs(unsigned int section) const;
+
     // return the number of currently allocated channels
     unsigned int getAllocatedChannels() const noexcept { return allocatedChannels; }
 
@@ -51,6 +58,11 @@ public:
     unsigned int getAllocatedSections() const noexcept { return allocatedSections; }
 
 private:
+    // Process N channels starting at firstChannel, section by section over chunks of
+    // interleaved frames, with the section states held in locals across each chunk
+    template <unsigned int N>
+    void processChannels(float* const* output, const float* const* input, unsigned int firstChannel, unsigned int numSamples);
+
     unsigned int allocatedChannels { 0 };
     unsigned int allocatedSections { 0 };
 
@@ -59,8 +71,8 @@ private:
     std::vector<float> coeffs;
 
     // vector of states of all channels and sections
-    // [ch0_sos0_bz1, ... , ch0_sos0_az2, ch0_sos1_bz1, ... , ch0_sos1_az2, ... ,
-    //  ch1_sos0_bz1, ... , ch1_sos0_az2, ch1_sos1_bz1, ... , ch1_sos1_az2, ...]
+    // [ch0_sos0_z1, ch0_sos0_z2, ch0_sos1_z1, ch0_sos1_z2, ... ,
+    //  ch1_sos0_z1, ch1_sos0_z2, ch1_sos1_z1, ch1_sos1_z2, ...]
     std::vector<float> states;
 };
 
@@ -1,5 +1,7 @@
 #include "DattorroAllPass.h"
 
+#include <algorithm>
+
 namespace DSP
 {
 
@@ -6,10 +6,23 @@
 namespace DSP
 {
 
+namespace
+{
+
+// Smallest power of two greater or equal than x
+unsigned int nextPowerOfTwo(unsigned int x)
+{
+    unsigned int p { 1u };
+    while (p < x)
+        p <<= 1;
+    return p;
+}
+
+}
+
 DelayLine::DelayLine(unsigned int maxLengthSamples, unsigned int numChannels)
 {
-    for (unsigned int ch = 0; ch < numChannels; ++ch)
-        delayBuffer.emplace_back(maxLengthSamples, 0.f);
+    prepare(maxLengthSamples, numChannels);
 }
 
 DelayLine::~DelayLine()
@@ -24,20 +37,40 @@ void DelayLine::clear()
 
 void DelayLine::prepare(unsigned int maxLengthSamples, unsigned int numChannels)
 {
+    delayBufferSize = std::max(maxLengthSamples, 1u);
+    bufferMask = nextPowerOfTwo(delayBufferSize) - 1u;
+    writeIndex &= bufferMask;
+
     delayBuffer.clear();
     for (unsigned int ch = 0; ch < numChannels; ++ch)
-        delayBuffer.emplace_back(maxLengthSamples, 0.f);
+        delayBuffer.emplace_back(bufferMask + 1u, 0.f);
 }
 
 void DelayLine::process(float* const* output, const float* const* input, unsigned int numChannels, unsigned int numSamples)
 {
-    const unsigned int delayBufferSize { static_cast<unsigned int>(delayBuffer[0].size()) };
+    const unsigned int capacity { bufferMask + 1u };
 
     numChannels = std::min(numChannels, static_cast<unsigned int>(delayBuffer.size()));
+
+    // When the samples read by this block are never overwritten by it,
+    // the whole block is two contiguous copies in and two out.
+    // Input is written first so in-place processing is safe.
+    if (delaySamples < capacity && numSamples <= std::min(delaySamples, capacity - delaySamples))
+    {
+        for (unsigned int ch = 0; ch < numChannels; ++ch)
+        {
+            writeBlock(ch, input[ch], numSamples);
+            readBlock(ch, delaySamples, output[ch], numSamples);
+        }
+
+        advanceWrite(numSamples);
+        return;
+    }
+
     for (unsigned int ch = 0; ch < numChannels; ++ch)
     {
         unsigned int workingWriteIndex { writeIndex };
-        unsigned int workingReadIndex { (workingWriteIndex + delayBufferSize - delaySamples) % delayBufferSize };
+        unsigned int workingReadIndex { (workingWriteIndex - delaySamples) & bufferMask };
 
         for (unsigned int n = 0; n < numSamples; ++n)
         {
@@ -45,22 +78,20 @@ void DelayLine::process(float* const* output, const float* const* input, unsigne
             output[ch][n] = delayBuffer[ch][workingReadIndex];
             delayBuffer[ch][workingWriteIndex] = x;
 
-            ++workingWriteIndex; workingWriteIndex %= delayBufferSize;
-            ++workingReadIndex; workingReadIndex %= delayBufferSize;
+            ++workingWriteIndex; workingWriteIndex &= bufferMask;
+            ++workingReadIndex; workingReadIndex &= bufferMask;
         }
     }
 
-    writeIndex += numSamples; writeIndex %= delayBufferSize;
+    writeIndex += numSamples; writeIndex &= bufferMask;
 }
 
 void DelayLine::process(float* output, const float* input, unsigned int numChannels)
 {
-    const unsigned int delayBufferSize{ static_cast<unsigned int>(delayBuffer[0].size()) };
-
     numChannels = std::min(numChannels, static_cast<unsigned int>(delayBuffer.size()));
 
     unsigned int workingWriteIndex { writeIndex };
-    unsigned int workingReadIndex { (workingWriteIndex + delayBufferSize - delaySamples) % delayBufferSize };
+    unsigned int workingReadIndex { (workingWriteIndex - delaySamples) & bufferMask };
 
     for (unsigned int ch = 0; ch < numChannels; ++ch)
     {
@@ -69,19 +100,17 @@ void DelayLine::process(float* output, const float* input, unsigned int numChann
         delayBuffer[ch][workingWriteIndex] = x;
     }
 
-    ++writeIndex; writeIndex %= delayBufferSize;
+    ++writeIndex; writeIndex &= bufferMask;
 }
 
 void DelayLine::process(float* const* audioOutput, const float* const* audioInput, const float* const* modInput, unsigned int numChannels, unsigned int numSamples)
 {
-    const unsigned int delayBufferSize{ static_cast<unsigned int>(delayBuffer[0].size()) };
-
     numChannels = std::min(numChannels, static_cast<unsigned int>(delayBuffer.size()));
     for (unsigned int ch = 0; ch < numChannels; ++ch)
     {
         // Calculate base indices based on fixed delay time
         unsigned int workingWriteIndex { writeIndex };
-        unsigned int workingReadIndex { (workingWriteIndex + delayBufferSize - delaySamples) % delayBufferSize };
+        unsigned int workingReadIndex { (workingWriteIndex - delaySamples) & bufferMask };
 
         for (unsigned int n = 0; n < numSamples; ++n)
         {
@@ -92,8 +121,8 @@ void DelayLine::process(float* const* audioOutput, const float* const* audioInpu
             const float mFrac1 { 1.f - mFrac0 };
 
             // Calculate read indices
-            const unsigned int readIndex0 { (workingReadIndex + delayBufferSize - static_cast<unsigned int>(mFloor)) % delayBufferSize };
-            const unsigned int readIndex1 { (readIndex0 + delayBufferSize - 1u) % delayBufferSize };
+            const unsigned int readIndex0 { (workingReadIndex - static_cast<unsigned int>(mFloor)) & bufferMask };
+            const unsigned int readIndex1 { (readIndex0 - 1u) & bufferMask };
 
             // Read from delay line
             const float read0 = delayBuffer[ch][readIndex0];
@@ -109,22 +138,20 @@ void DelayLine::process(float* const* audioOutput, const float* const* audioInpu
             delayBuffer[ch][workingWriteIndex] = x;
 
             // Increament indices
-            ++workingWriteIndex; workingWriteIndex %= delayBufferSize;
-            ++workingReadIndex; workingReadIndex %= delayBufferSize;
+            ++workingWriteIndex; workingWriteIndex &= bufferMask;
+            ++workingReadIndex; workingReadIndex &= bufferMask;
         }
     }
 
     // Update persistent write index
-    writeIndex += numSamples; writeIndex %= delayBufferSize;
+    writeIndex += numSamples; writeIndex &= bufferMask;
 }
 
 void DelayLine::process(float* audioOutput, const float* audioInput, const float* modInput, unsigned int numChannels)
 {
-    const unsigned int delayBufferSize{ static_cast<unsigned int>(delayBuffer[0].size()) };
-
     // Calculate base indices based on fixed delay time
     unsigned int workingWriteIndex { writeIndex };
-    unsigned int workingReadIndex { (workingWriteIndex + delayBufferSize - delaySamples) % delayBufferSize };
+    unsigned int workingReadIndex { (workingWriteIndex - delaySamples) & bufferMask };
 
     numChannels = std::min(numChannels, static_cast<unsigned int>(delayBuffer.size()));
     for (unsigned int ch = 0; ch < numChannels; ++ch)
@@ -136,8 +163,8 @@ void DelayLine::process(float* audioOutput, const float* audioInput, const float
         const float mFrac1 { 1.f - mFrac0 };
 
         // Calculate read indeces
-        const unsigned int readIndex0 { (workingReadIndex + delayBufferSize - static_cast<unsigned int>(mFloor)) % delayBufferSize };
-        const unsigned int readIndex1 { (readIndex0 + delayBufferSize - 1u) % delayBufferSize };
+        const unsigned int readIndex0 { (workingReadIndex - static_cast<unsigned int>(mFloor)) & bufferMask };
+        const unsigned int readIndex1 { (readIndex0 - 1u) & bufferMask };
 
         // Read from delay line
         const float read0 = delayBuffer[ch][readIndex0];
@@ -154,17 +181,16 @@ void DelayLine::process(float* audioOutput, const float* audioInput, const float
     }
 
     // Update persistent write index
-    ++writeIndex; writeIndex %= delayBufferSize;
+    ++writeIndex; writeIndex &= bufferMask;
 }
 
 void DelayLine::process(float* audioOutput, const float* audioInput, const float* modInput, int channel)
 {
-    const unsigned int delayBufferSize{ static_cast<unsigned int>(delayBuffer[0].size()) };
     const unsigned int numChannels{ static_cast<unsigned int>(delayBuffer.size()) };
 
     // Calculate base indices based on fixed delay time
     unsigned int workingWriteIndex { writeIndex };
-    unsigned int workingReadIndex { (workingWriteIndex + delayBufferSize - delaySamples) % delayBufferSize };
+    unsigned int workingReadIndex { (workingWriteIndex - delaySamples) & bufferMask };
 
     // Linear interpolation coefficients
     const float m { std::fmax(modInput[channel], 0.f) };
@@ -173,8 +199,8 @@ void DelayLine::process(float* audioOutput, const float* audioInput, const float
     const float mFrac1 { 1.f - mFrac0 };
 
     // Calculate read indeces
-    const unsigned int readIndex0 { (workingReadIndex + delayBufferSize - static_cast<unsigned int>(mFloor)) % delayBufferSize };
-    const unsigned int readIndex1 { (readIndex0 + delayBufferSize - 1u) % delayBufferSize };
+    const unsigned int readIndex0 { (workingReadIndex - static_cast<unsigned int>(mFloor)) & bufferMask };
+    const unsigned int readIndex1 { (readIndex0 - 1u) & bufferMask };
 
     // Read from delay line
     const float read0 = delayBuffer[channel][readIndex0];
@@ -190,18 +216,16 @@ void DelayLine::process(float* audioOutput, const float* audioInput, const float
     delayBuffer[channel][workingWriteIndex] = x;
 
     // Update persistent write index
-    ++writeIndex; writeIndex %= delayBufferSize;
+    ++writeIndex; writeIndex &= bufferMask;
 }
 
 void DelayLine::setDelaySamples(unsigned int newDelaySamples)
 {
-    delaySamples = std::max(std::min(newDelaySamples, static_cast<unsigned int>(delayBuffer[0].size() - 1u)), 1u);
+    delaySamples = std::max(std::min(newDelaySamples, delayBufferSize - 1u), 1u);
 }
 
 float DelayLine::getSample(unsigned int channel, float index) const
 {   
-    const unsigned int delayBufferSize{ static_cast<unsigned int>(delayBuffer[0].size()) };
-
     index = std::clamp(index, 1.f, static_cast<float>(delayBufferSize - 1u));
 
     // Linear interpolation coefficients
@@ -210,11 +234,11 @@ float DelayLine::getSample(unsigned int channel, float index) const
     const float mFrac1 { 1.f - mFrac0 };
 
     // Base read index
-    unsigned int workingReadIndex { (writeIndex + delayBufferSize - static_cast<unsigned int>(mFloor)) % delayBufferSize };
+    unsigned int workingReadIndex { (writeIndex - static_cast<unsigned int>(mFloor)) & bufferMask };
 
     // Read indices for interpolation
-    const unsigned int readIndex0 { (workingReadIndex + delayBufferSize - static_cast<unsigned int>(mFloor)) % delayBufferSize };
-    const unsigned int readIndex1 { (readIndex0 + delayBufferSize - 1u) % delayBufferSize };
+    const unsigned int readIndex0 { (workingReadIndex - static_cast<unsigned int>(mFloor)) & bufferMask };
+    const unsigned int readIndex1 { (readIndex0 - 1u) & bufferMask };
 
     // Read from delay line
     const float read0 = delayBuffer[channel][readIndex0];
@@ -227,8 +251,6 @@ float DelayLine::getSample(unsigned int channel, float index) const
 
 float DelayLine::getSample(unsigned int channel, float index, const float* modInput) const
 {   
-    const unsigned int delayBufferSize{ static_cast<unsigned int>(delayBuffer[0].size()) };
-
     index = std::clamp(index, 1.f, static_cast<float>(delayBufferSize - 1u));
 
     // Linear interpolation coefficients
@@ -238,11 +260,11 @@ float DelayLine::getSample(unsigned int channel, float index, const float* modIn
     const float mFrac1 { 1.f - mFrac0 };
 
     // Base read index
-    unsigned int workingReadIndex { (writeIndex + delayBufferSize - static_cast<unsigned int>(mFloor)) % delayBufferSize };
+    unsigned int workingReadIndex { (writeIndex - static_cast<unsigned int>(mFloor)) & bufferMask };
 
     // Read indices for interpolation
-    const unsigned int readIndex0 { (workingReadIndex + delayBufferSize - static_cast<unsigned int>(mFloor)) % delayBufferSize };
-    const unsigned int readIndex1 { (readIndex0 + delayBufferSize - 1u) % delayBufferSize };
+    const unsigned int readIndex0 { (workingReadIndex - static_cast<unsigned int>(mFloor)) & bufferMask };
+    const unsigned int readIndex1 { (readIndex0 - 1u) & bufferMask };
 
     // Read from delay line
     const float read0 = delayBuffer[channel][readIndex0];
@@ -253,4 +275,43 @@ float DelayLine::getSample(unsigned int channel, float index, const float* modIn
     return x;
 }
 
+DelayLine::SplitSpan DelayLine::getReadSpan(unsigned int channel, unsigned int delay, unsigned int numSamples)
+{
+    const unsigned int capacity { bufferMask + 1u };
+    const unsigned int startIndex { (writeIndex - delay) & bufferMask };
+
+    numSamples = std::min(numSamples, capacity);
+
+    SplitSpan span;
+    span.first = delayBuffer[channel].data() + startIndex;
+    span.firstSize = std::min(numSamples, capacity - startIndex);
+    span.second = delayBuffer[channel].data();
+    span.secondSize = numSamples - span.firstSize;
+    return span;
+}
+
+DelayLine::SplitSpan DelayLine::getWriteSpan(unsigned int channel, unsigned int numSamples)
+{
+    return getReadSpan(channel, 0u, numSamples);
+}
+
+void DelayLine::readBlock(unsigned int channel, unsigned int delay, float* output, unsigned int numSamples)
+{
+    const SplitSpan span { getReadSpan(channel, delay, numSamples) };
+    std::copy(span.first, span.first + span.firstSize, output);
+    std::copy(span.second, span.second + span.secondSize, output + span.firstSize);
+}
+
+void DelayLine::writeBlock(unsigned int channel, const float* input, unsigned int numSamples)
+{
+    const SplitSpan span { getWriteSpan(channel, numSamples) };
+    std::copy(input, input + span.firstSize, span.first);
+    std::copy(input + span.firstSize, input + span.firstSize + span.secondSize, span.second);
+}
+
+void DelayLine::advanceWrite(unsigned int numSamples)
+{
+    writeIndex += numSamples; writeIndex &= bufferMask;
+}
+
 }
\ No newline at end of file
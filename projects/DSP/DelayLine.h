@@ -56,8 +56,42 @@ public:
      // Get sample at requested index with modulation
     float getSample(unsigned int channel, float index, const float* modInput) const;
 
+    // Region of the delay buffer split in (at most) two contiguous segments
+    // The segments are in chronological order, oldest sample first
+    struct SplitSpan
+    {
+        float* first { nullptr };
+        unsigned int firstSize { 0 };
+        float* second { nullptr };
+        unsigned int secondSize { 0 };
+    };
+
+    // Get the region holding numSamples samples, starting at the sample
+    // written 'delay' samples before the current write position
+    SplitSpan getReadSpan(unsigned int channel, unsigned int delay, unsigned int numSamples);
+
+    // Get the region where the next numSamples input samples will be written
+    SplitSpan getWriteSpan(unsigned int channel, unsigned int numSamples);
+
+    // Copy numSamples samples starting at 'delay' samples in the past into output
+    void readBlock(unsigned int channel, unsigned int delay, float* output, unsigned int numSamples);
+
+    // Copy numSamples input samples to the current write position
+    // The write position is only moved by advanceWrite, so all channels can be written first
+    void writeBlock(unsigned int channel, const float* input, unsigned int numSamples);
+
+    // Move the write position forward after writing thru spans or writeBlock
+    void advanceWrite(unsigned int numSamples);
+
+    // Get the buffer capacity in samples, always a power of two
+    unsigned int getCapacity() const { return bufferMask + 1u; }
+
 private:
     std::vector<std::vector<float>> delayBuffer;
+    // Requested buffer size, delay times are clamped to it
+    unsigned int delayBufferSize { 0 };
+    // Allocated buffer size is rounded up to a power of two, indices wrap with this mask
+    unsigned int bufferMask { 0 };
     unsigned int delaySamples { 0 };
     unsigned int writeIndex { 0 };
 };
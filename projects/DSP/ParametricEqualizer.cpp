@@ -1,17 +1,81 @@
 #include "ParametricEqualizer.h"
 
+#include <algorithm>
 #include <cmath>
 
 namespace DSP
 {
 
+namespace
+{
+
+// One sample of a TPT state variable filter, ic1 and ic2 are the integrator states
+// a1, a2 and a3 derive from g and k, m0, m1 and m2 mix the outputs
+inline float processSvfSample(float x, float& ic1, float& ic2,
+                              float a1, float a2, float a3, float m0, float m1, float m2)
+{
+    const float v3 { x - ic2 };
+    const float v1 { a1 * ic1 + a2 * v3 };
+    const float v2 { ic2 + a2 * ic1 + a3 * v3 };
+    ic1 = 2.f * v1 - ic1;
+    ic2 = 2.f * v2 - ic2;
+    return m0 * x + m1 * v1 + m2 * v2;
+}
+
+// Coefficients of each sample of a chunk of the smoothed mode
+struct SvfGlide
+{
+    float a1[ParametricEqualizer::ChunkSamples];
+    float a2[ParametricEqualizer::ChunkSamples];
+    float a3[ParametricEqualizer::ChunkSamples];
+    float m0[ParametricEqualizer::ChunkSamples];
+    float m1[ParametricEqualizer::ChunkSamples];
+    float m2[ParametricEqualizer::ChunkSamples];
+};
+
+// Run a band on N channels in place, the states of channel c are at states + c * stateStride
+template <unsigned int N>
+void processSvfChunk(float* const* io, float* states, size_t stateStride, const SvfGlide& glide, unsigned int numSamples)
+{
+    float ic1[N];
+    float ic2[N];
+    for (unsigned int c = 0; c < N; ++c)
+    {
+        ic1[c] = states[c * stateStride + 0];
+        ic2[c] = states[c * stateStride + 1];
+    }
+
+    for (unsigned int n = 0; n < numSamples; ++n)
+        for (unsigned int c = 0; c < N; ++c)
+            io[c][n] = processSvfSample(io[c][n], ic1[c], ic2[c], glide.a1[n], glide.a2[n], glide.a3[n],
+                                        glide.m0[n], glide.m1[n], glide.m2[n]);
+
+    for (unsigned int c = 0; c < N; ++c)
+    {
+        states[c * stateStride + 0] = ic1[c];
+        states[c * stateStride + 1] = ic2[c];
+    }
+}
+
+}
+
 ParametricEqualizer::ParametricEqualizer(unsigned int numOfBands, unsigned int maxNumChannels) :
     biquad(numOfBands, maxNumChannels),
-    bands(numOfBands)
+    bands(numOfBands),
+    svfCoeffs(numOfBands),
+    svfTargets(numOfBands),
+    svfStates(static_cast<size_t>(numOfBands) * maxNumChannels * 2u, 0.f)
 {
     unsigned int b { 0 };
     for (const auto& band : bands)
         biquad.setSectionCoeffs(calculateCoeffs(band), b++);
+
+    tanTable.resize(TanTableSize + 1);
+    for (unsigned int i = 0; i <= TanTableSize; ++i)
+    {
+        const double x { static_cast<double>(MaxNormalizedFrequency) * static_cast<double>(i) / static_cast<double>(TanTableSize) };
+        tanTable[i] = static_cast<float>(std::tan(M_PI * x));
+    }
 }
 
 ParametricEqualizer::~ParametricEqualizer()
@@ -21,27 +85,156 @@ ParametricEqualizer::~ParametricEqualizer()
 void ParametricEqualizer::clear()
 {
     biquad.clear();
+    std::fill(svfStates.begin(), svfStates.end(), 0.f);
 }
 
 void ParametricEqualizer::prepare(double newSampleRate, unsigned int maxNumChannels)
 {
     biquad.reallocateChannels(maxNumChannels);
+    svfStates.assign(bands.size() * maxNumChannels * 2u, 0.f);
 
     sampleRate = std::fmax(newSampleRate, 1.f);
 
     unsigned int b { 0 };
     for (const auto& band : bands)
         biquad.setSectionCoeffs(calculateCoeffs(band), b++);
+
+    // Skip the glide to the new sample rate coefficients
+    for (b = 0; b < bands.size(); ++b)
+        svfCoeffs[b] = svfTargets[b] = calculateSvfCoeffs(bands[b]);
 }
 
 void ParametricEqualizer::process(float* const* output, const float* const* input, unsigned int numChannels, unsigned int numSamples)
 {
-    biquad.process(output, input, numChannels, numSamples);
+    if (smoothing)
+        processSmoothed(output, input, numChannels, numSamples);
+    else
+        biquad.process(output, input, numChannels, numSamples);
 }
 
 void ParametricEqualizer::process(float* output, const float* input, unsigned int numChannels)
 {
-    biquad.process(output, input, numChannels);
+    if (!smoothing)
+    {
+        biquad.process(output, input, numChannels);
+        return;
+    }
+
+    // A single sample reaches the coefficient targets at once
+    numChannels = std::min(numChannels, biquad.getAllocatedChannels());
+    const size_t numBands { bands.size() };
+
+    for (size_t b = 0; b < numBands; ++b)
+        svfCoeffs[b] = svfTargets[b];
+
+    for (unsigned int ch = 0; ch < numChannels; ++ch)
+    {
+        float x { input[ch] };
+        for (size_t b = 0; b < numBands; ++b)
+        {
+            const SvfCoeffs& c { svfCoeffs[b] };
+            const float a1 { 1.f / (1.f + c.g * (c.g + c.k)) };
+            const float a2 { c.g * a1 };
+            const float a3 { c.g * a2 };
+            float* const state { svfStates.data() + (ch * numBands + b) * 2u };
+            x = processSvfSample(x, state[0], state[1], a1, a2, a3, c.m0, c.m1, c.m2);
+        }
+        output[ch] = x;
+    }
+}
+
+void ParametricEqualizer::processSmoothed(float* const* output, const float* const* input, unsigned int numChannels, unsigned int numSamples)
+{
+    numChannels = std::min(numChannels, biquad.getAllocatedChannels());
+    const size_t numBands { bands.size() };
+
+    for (unsigned int ch = 0; ch < numChannels; ++ch)
+        if (output[ch] != input[ch])
+            std::copy(input[ch], input[ch] + numSamples, output[ch]);
+
+    if (numSamples == 0)
+        return;
+
+    const float stepScale { 1.f / static_cast<float>(numSamples) };
+
+    for (size_t b = 0; b < numBands; ++b)
+    {
+        const SvfCoeffs start { svfCoeffs[b] };
+        const SvfCoeffs& target { svfTargets[b] };
+        const SvfCoeffs step { (target.g - start.g) * stepScale,
+                               (target.k - start.k) * stepScale,
+                               (target.m0 - start.m0) * stepScale,
+                               (target.m1 - start.m1) * stepScale,
+                               (target.m2 - start.m2) * stepScale };
+
+        for (unsigned int chunkStart = 0; chunkStart < numSamples; chunkStart += ChunkSamples)
+        {
+            const unsigned int chunk { std::min(numSamples - chunkStart, ChunkSamples) };
+
+            // Coefficients of each sample of the chunk, shared by all channels
+            // Linear glide, the last sample of the block runs on the targets
+            SvfGlide glide;
+            for (unsigned int n = 0; n < chunk; ++n)
+            {
+                const float t { static_cast<float>(chunkStart + n + 1) };
+                const float g { start.g + step.g * t };
+                const float k { start.k + step.k * t };
+                glide.a1[n] = 1.f / (1.f + g * (g + k));
+                glide.a2[n] = g * glide.a1[n];
+                glide.a3[n] = g * glide.a2[n];
+                glide.m0[n] = start.m0 + step.m0 * t;
+                glide.m1[n] = start.m1 + step.m1 * t;
+                glide.m2[n] = start.m2 + step.m2 * t;
+            }
+
+            // Channels run in pairs, so their recursions overlap
+            const size_t stateStride { numBands * 2u };
+            float* const states { svfStates.data() + b * 2u };
+            float* io[2];
+
+            unsigned int ch { 0 };
+            for (; ch + 2 <= numChannels; ch += 2)
+            {
+                io[0] = output[ch] + chunkStart;
+                io[1] = output[ch + 1] + chunkStart;
+                processSvfChunk<2>(io, states + ch * stateStride, stateStride, glide, chunk);
+            }
+            if (ch < numChannels)
+            {
+                io[0] = output[ch] + chunkStart;
+                processSvfChunk<1>(io, states + ch * stateStride, stateStride, glide, chunk);
+            }
+        }
+
+        svfCoeffs[b] = target;
+    }
+}
+
+std::array<float, DSP::Biquad::CoeffsPerSection> ParametricEqualizer::getBandCoeffs(unsigned int band) const
+{
+    return biquad.getSectionCoeffs(band);
+}
+
+void ParametricEqualizer::setSmoothing(bool enabled)
+{
+    smoothing = enabled;
+
+    // The setters only update the coefficients of the active mode
+    for (unsigned int b = 0; b < bands.size() && b < biquad.getAllocatedSections(); ++b)
+    {
+        biquad.setSectionCoeffs(calculateCoeffs(bands[b]), b);
+        svfCoeffs[b] = svfTargets[b] = calculateSvfCoeffs(bands[b]);
+    }
+
+    clear();
+}
+
+void ParametricEqualizer::updateBand(unsigned int band)
+{
+    if (smoothing)
+        svfTargets[band] = calculateSvfCoeffs(bands[band]);
+    else
+        biquad.setSectionCoeffs(calculateCoeffs(bands[band]), band);
 }
 
 void ParametricEqualizer::setBandType(unsigned int band, FilterType type)
@@ -49,7 +242,7 @@ void ParametricEqualizer::setBandType(unsigned int band, FilterType type)
     if (band < bands.size() && band < biquad.getAllocatedSections())
     {
         bands[band].type = type;
-        biquad.setSectionCoeffs(calculateCoeffs(bands[band]), band);
+        updateBand(band);
     }
 }
 
@@ -58,7 +251,7 @@ void ParametricEqualizer::setBandFrequency(unsigned int band, float frequency)
     if (band < bands.size() && band < biquad.getAllocatedSections())
     {
         bands[band].freq = std::fmax(frequency, 2.f);
-        biquad.setSectionCoeffs(calculateCoeffs(bands[band]), band);
+        updateBand(band);
     }
 }
 
@@ -67,7 +260,7 @@ void ParametricEqualizer::setBandResonance(unsigned int band, float resonance)
     if (band < bands.size() && band < biquad.getAllocatedSections())
     {
         bands[band].reso = std::fmax(resonance, 0.1f);
-        biquad.setSectionCoeffs(calculateCoeffs(bands[band]), band);
+        updateBand(band);
     }
 }
 
@@ -76,7 +269,8 @@ void ParametricEqualizer::setBandGain(unsigned int band, float gain)
     if (band < bands.size() && band < biquad.getAllocatedSections())
     {
         bands[band].gain = gain;
-        biquad.setSectionCoeffs(calculateCoeffs(bands[band]), band);
+        bands[band].amplitude = std::pow(10.f, gain * 0.025f);
+        updateBand(band);
     }
 }
 
@@ -171,4 +365,51 @@ std::array<float, DSP::Biquad::CoeffsPerSection> ParametricEqualizer::calculateC
     return coeffs;
 }
 
+ParametricEqualizer::SvfCoeffs ParametricEqualizer::calculateSvfCoeffs(const Band& band) const
+{
+    // Flat coeffs
+    SvfCoeffs coeffs;
+
+    const float x { std::fmin(band.freq / static_cast<float>(sampleRate), MaxNormalizedFrequency) };
+    const float g { getTan(x) };
+    const float k { 1.f / band.reso };
+    const float A { band.amplitude };
+
+    switch (band.type)
+    {
+        case HighPass:
+            coeffs = { g, k, 1.f, -k, -1.f };
+            break;
+
+        case LowShelf:
+            coeffs = { g / std::sqrt(A), k, 1.f, k * (A - 1.f), A * A - 1.f };
+            break;
+
+        case Peak:
+            coeffs = { g, k / A, 1.f, k / A * (A * A - 1.f), 0.f };
+            break;
+
+        case LowPass:
+            coeffs = { g, k, 0.f, 0.f, 1.f };
+            break;
+
+        case HighShelf:
+            coeffs = { g * std::sqrt(A), k, A * A, k * (1.f - A) * A, 1.f - A * A };
+            break;
+
+        default: break;
+    }
+
+    return coeffs;
+}
+
+float ParametricEqualizer::getTan(float x) const
+{
+    const float position { std::fmax(x, 0.f) * (static_cast<float>(TanTableSize) / MaxNormalizedFrequency) };
+    const unsigned int index { std::min(static_cast<unsigned int>(position), TanTableSize - 1u) };
+    const float frac { std::fmin(position - static_cast<float>(index), 1.f) };
+
+    return tanTable[index] + frac * (tanTable[index + 1] - tanTable[index]);
+}
+
 }
\ No newline at end of file
@@ -52,6 +52,9 @@ public:
     // Single sample flavour
     void process(float* output, const float* input, unsigned int numChannels);
 
+    // Get the biquad coeffs of a band, as process() runs them outside the smoothed mode
+    std::array<float, DSP::Biquad::CoeffsPerSection> getBandCoeffs(unsigned int band) const;
+
     // Set filter type of a band
     void setBandType(unsigned int band, FilterType type);
 
@@ -64,6 +67,20 @@ public:
     // Set filter gain of a band in dB
     void setBandGain(unsigned int band, float gain);
 
+    // Smoothed coefficient mode for modulated bands, off by default
+    // Bands run as TPT state variable filters with the same responses as the biquads.
+    // The setters only set coefficient targets, using a table instead of tan(), and each
+    // process() call glides the coefficients linearly per sample to their targets.
+    // Clears the states, must not be called while processing
+    void setSmoothing(bool enabled);
+
+    // Number of segments of the tan(pi * f / fs) table of the smoothed mode
+    static constexpr unsigned int TanTableSize { 1024 };
+    // Highest band frequency of the smoothed mode relative to the sample rate
+    static constexpr float MaxNormalizedFrequency { 0.49f };
+    // Number of samples whose smoothed coefficients are computed in one go
+    static constexpr unsigned int ChunkSamples { 64 };
+
 private:
     // Biquad structure for filter realization
     DSP::Biquad biquad;
@@ -78,6 +95,20 @@ private:
         float freq { 1000.f };
         float reso { 0.7071f };
         float gain { 0.f };
+        // Shelf and peak amplitude, 10^(gain / 40), kept for the smoothed mode
+        float amplitude { 1.f };
+    };
+
+    // TPT state variable filter coefficients of a band
+    // g is the prewarped cutoff and k the damping, m0, m1 and m2 mix the
+    // input, band pass and low pass outputs
+    struct SvfCoeffs
+    {
+        float g { 0.f };
+        float k { 2.f };
+        float m0 { 1.f };
+        float m1 { 0.f };
+        float m2 { 0.f };
     };
 
     // All bands information
@@ -85,6 +116,31 @@ private:
 
     // Helper function to calculate coefficients
     std::array<float, DSP::Biquad::CoeffsPerSection> calculateCoeffs(const Band & band);
+
+    // Helper function to calculate the smoothed mode coefficients
+    SvfCoeffs calculateSvfCoeffs(const Band& band) const;
+
+    // Interpolated lookup of the tan table, x = f / fs in [0, MaxNormalizedFrequency]
+    float getTan(float x) const;
+
+    // Update the coefficients of a band for the current mode
+    void updateBand(unsigned int band);
+
+    // Process the state variable filters of the smoothed mode
+    void processSmoothed(float* const* output, const float* const* input, unsigned int numChannels, unsigned int numSamples);
+
+    bool smoothing { false };
+
+    // Smoothed mode coefficients of all bands, current values and targets
+    std::vector<SvfCoeffs> svfCoeffs;
+    std::vector<SvfCoeffs> svfTargets;
+
+    // Smoothed mode states of all channels and bands
+    // [ch0_band0_ic1, ch0_band0_ic2, ch0_band1_ic1, ... , ch1_band0_ic1, ...]
+    std::vector<float> svfStates;
+
+    // tan(pi * x) table, TanTableSize + 1 points over [0, MaxNormalizedFrequency]
+    std::vector<float> tanTable;
 };
 
 }
\ No newline at end of file
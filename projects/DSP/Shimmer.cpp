@@ -1,5 +1,6 @@
 #include "Shimmer.h"
 
+#include <algorithm>
 #include <cmath>
 
 namespace DSP
@@ -162,6 +162,8 @@ void SynthVoice::controllerMoved(int controllerNumber, int newControllerValue)
 
 void SynthVoice::renderNextBlock(juce::AudioBuffer<float>& outputBuffer, int startSample, int numSamples)
 {
+    mrta::RealtimeScope realtimeScope("SynthVoice::renderNextBlock");
+
     const auto newSampleRate { getSampleRate() };
     if (sampleRate != newSampleRate)
     {
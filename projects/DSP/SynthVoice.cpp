@@ -55,6 +55,8 @@ void SynthVoice::controllerMoved(int, int)
 
 void SynthVoice::renderNextBlock(juce::AudioBuffer<float>& outputBuffer, int startSample, int numSamples)
 {
+    mrta::RealtimeScope realtimeScope("SynthVoice::renderNextBlock");
+
     // there's no "prepare" call to synth voice, so we need to manually check
     // every buffer call if the sample rate has changed
     double newSampleRate { getSampleRate() };
@@ -0,0 +1,351 @@
+#include "GoldenCases.h"
+
+#include "DelayLine.h"
+#include "AllPass.h"
+#include "Biquad.h"
+#include "ParametricEqualizer.h"
+#include "Ramp.h"
+#include "LeakyIntegrator.h"
+#include "LFO.h"
+#include "Oscillator.h"
+#include "EnvelopeGenerator.h"
+#include "StateVariableFilter.h"
+#include "RingMod.h"
+#include "Flanger.h"
+#include "Delay.h"
+#include "GranularPitchShifter.h"
+#include "Shimmer.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+// Golden cases of the projects/DSP classes, except the Dattorro reverb and its own
+// DelayLine and AllPass, see DattorroCases.cpp
+
+namespace
+{
+
+void renderDelayLine(float* const* output, const float* const* input, unsigned int numChannels, unsigned int numSamples)
+{
+    DSP::DelayLine delayLine(1024, numChannels);
+    delayLine.setDelaySamples(37);
+
+    Golden::forEachBlock(output, input, numChannels, numSamples, [&](float* const* out, const float* const* in, unsigned int n)
+    {
+        delayLine.process(out, in, numChannels, n);
+    });
+}
+
+// Audio rate modulation of 0 to 16 samples on top of a 20 sample delay, fractional most of the time
+void renderDelayLineModulated(float* const* output, const float* const* input, unsigned int numChannels, unsigned int numSamples)
+{
+    DSP::DelayLine delayLine(1024, numChannels);
+    delayLine.setDelaySamples(20);
+
+    std::vector<std::vector<float>> mod(numChannels, std::vector<float>(numSamples));
+    for (unsigned int ch = 0; ch < numChannels; ++ch)
+        for (unsigned int n = 0; n < numSamples; ++n)
+            mod[ch][n] = 8.f + 8.f * std::sin(static_cast<float>(2.0 * M_PI * 3.0 / Golden::SampleRate) * static_cast<float>(n) + static_cast<float>(ch));
+
+    unsigned int pos { 0 };
+    std::vector<const float*> blockMod(numChannels);
+    Golden::forEachBlock(output, input, numChannels, numSamples, [&](float* const* out, const float* const* in, unsigned int n)
+    {
+        for (unsigned int ch = 0; ch < numChannels; ++ch)
+            blockMod[ch] = mod[ch].data() + pos;
+        delayLine.process(out, in, blockMod.data(), numChannels, n);
+        pos += n;
+    });
+}
+
+void renderAllPass(float* const* output, const float* const* input, unsigned int numChannels, unsigned int numSamples)
+{
+    DSP::AllPass allPass(5.f, 0.7f, numChannels);
+    allPass.prepare(Golden::SampleRate, numChannels);
+
+    Golden::forEachBlock(output, input, numChannels, numSamples, [&](float* const* out, const float* const* in, unsigned int n)
+    {
+        allPass.process(out, in, numChannels, n);
+    });
+}
+
+// Resonant lowpass around 1kHz followed by a peak around 5kHz, b0 b1 b2 a1 a2 of each section
+void renderBiquad(float* const* output, const float* const* input, unsigned int numChannels, unsigned int numSamples)
+{
+    DSP::Biquad biquad(2, numChannels);
+    biquad.setSectionCoeffs({ 0.00391613f, 0.00783226f, 0.00391613f, -1.90057093f, 0.91623545f }, 0);
+    biquad.setSectionCoeffs({ 1.12240330f, -1.27314410f, 0.48054785f, -1.27314410f, 0.60295115f }, 1);
+
+    Golden::forEachBlock(output, input, numChannels, numSamples, [&](float* const* out, const float* const* in, unsigned int n)
+    {
+        biquad.process(out, in, numChannels, n);
+    });
+}
+
+void setupEqualizer(DSP::ParametricEqualizer& equalizer)
+{
+    equalizer.setBandType(0, DSP::ParametricEqualizer::HighPass);
+    equalizer.setBandFrequency(0, 80.f);
+    equalizer.setBandResonance(0, 0.7071f);
+
+    equalizer.setBandType(1, DSP::ParametricEqualizer::Peak);
+    equalizer.setBandFrequency(1, 1000.f);
+    equalizer.setBandResonance(1, 2.f);
+    equalizer.setBandGain(1, 6.f);
+
+    equalizer.setBandType(2, DSP::ParametricEqualizer::HighShelf);
+    equalizer.setBandFrequency(2, 8000.f);
+    equalizer.setBandResonance(2, 0.7071f);
+    equalizer.setBandGain(2, -4.f);
+}
+
+void renderParametricEqualizer(float* const* output, const float* const* input, unsigned int numChannels, unsigned int numSamples)
+{
+    DSP::ParametricEqualizer equalizer(3, numChannels);
+    setupEqualizer(equalizer);
+    equalizer.prepare(Golden::SampleRate, numChannels);
+
+    Golden::forEachBlock(output, input, numChannels, numSamples, [&](float* const* out, const float* const* in, unsigned int n)
+    {
+        equalizer.process(out, in, numChannels, n);
+    });
+}
+
+// Smoothed coefficient mode with the peak band swept from 200Hz to 5kHz, one step per block
+void renderParametricEqualizerSmoothed(float* const* output, const float* const* input, unsigned int numChannels, unsigned int numSamples)
+{
+    DSP::ParametricEqualizer equalizer(3, numChannels);
+    setupEqualizer(equalizer);
+    equalizer.prepare(Golden::SampleRate, numChannels);
+    equalizer.setSmoothing(true);
+
+    unsigned int pos { 0 };
+    Golden::forEachBlock(output, input, numChannels, numSamples, [&](float* const* out, const float* const* in, unsigned int n)
+    {
+        equalizer.setBandFrequency(1, 200.f * std::pow(25.f, static_cast<float>(pos) / static_cast<float>(numSamples)));
+        equalizer.process(out, in, numChannels, n);
+        pos += n;
+    });
+}
+
+// Gain ramp to 1, then back down to 0.25 halfway
+void renderRamp(float* const* output, const float* const* input, unsigned int numChannels, unsigned int numSamples)
+{
+    DSP::Ramp<float> ramp(0.02f);
+    ramp.prepare(Golden::SampleRate, true, 0.f);
+    ramp.setTarget(1.f);
+
+    unsigned int pos { 0 };
+    Golden::forEachBlock(output, input, numChannels, numSamples, [&](float* const* out, const float* const* in, unsigned int n)
+    {
+        if (pos < numSamples / 2 && pos + n >= numSamples / 2)
+            ramp.setTarget(0.25f);
+        ramp.applyGain(out, in, numChannels, n);
+        pos += n;
+    });
+}
+
+void renderLeakyIntegrator(float* const* output, const float* const* input, unsigned int numChannels, unsigned int numSamples)
+{
+    DSP::LeakyIntegrator integrator(0.05f);
+    integrator.prepare(Golden::SampleRate);
+
+    Golden::forEachBlock(output, input, numChannels, numSamples, [&](float* const* out, const float* const* in, unsigned int n)
+    {
+        integrator.process(out, in, numChannels, n);
+    });
+}
+
+// Both waveforms of both channels, one output channel each
+void renderLFO(float* const* output, const float* const*, unsigned int, unsigned int numSamples)
+{
+    DSP::LFO sinLfo(DSP::LFO::Sin, 5.f, 2.f, 1.f);
+    DSP::LFO triLfo(DSP::LFO::Tri, 5.f, 2.f, 1.f);
+    sinLfo.prepare(Golden::SampleRate);
+    triLfo.prepare(Golden::SampleRate);
+
+    for (unsigned int n = 0; n < numSamples; ++n)
+    {
+        const float* sinOut { sinLfo.process() };
+        const float* triOut { triLfo.process() };
+        output[0][n] = sinOut[0];
+        output[1][n] = sinOut[1];
+        output[2][n] = triOut[0];
+        output[3][n] = triOut[1];
+    }
+}
+
+// Every waveform, one output channel each
+void renderOscillator(float* const* output, const float* const*, unsigned int numChannels, unsigned int numSamples)
+{
+    for (unsigned int ch = 0; ch < numChannels; ++ch)
+    {
+        DSP::Oscillator oscillator;
+        oscillator.setType(static_cast<DSP::Oscillator::OscType>(ch));
+        oscillator.prepare(Golden::SampleRate);
+        oscillator.setFrequency(440.f);
+
+        for (unsigned int pos = 0; pos < numSamples; pos += Golden::BlockSize)
+            oscillator.process(output[ch] + pos, std::min(Golden::BlockSize, numSamples - pos));
+    }
+}
+
+// Digital and analog style, note on at the start and note off halfway
+void renderEnvelopeGenerator(float* const* output, const float* const*, unsigned int numChannels, unsigned int numSamples)
+{
+    for (unsigned int ch = 0; ch < numChannels; ++ch)
+    {
+        DSP::EnvelopeGenerator envelope;
+        envelope.prepare(Golden::SampleRate);
+        envelope.setAnalogStyle(ch == 1);
+        envelope.setAttackTime(10.f);
+        envelope.setDecayTime(20.f);
+        envelope.setSustainLevel(0.5f);
+        envelope.setReleaseTime(30.f);
+        envelope.start();
+
+        for (unsigned int pos = 0; pos < numSamples; pos += Golden::BlockSize)
+        {
+            const unsigned int n { std::min(Golden::BlockSize, numSamples - pos) };
+            if (pos < numSamples / 2 && pos + n >= numSamples / 2)
+            {
+                const unsigned int split { numSamples / 2 - pos };
+                envelope.process(output[ch] + pos, split);
+                envelope.end();
+                envelope.process(output[ch] + pos + split, n - split);
+            }
+            else
+            {
+                envelope.process(output[ch] + pos, n);
+            }
+        }
+    }
+}
+
+// First input channel with the cutoff swept from 100Hz to 10kHz at a Q of 2,
+// lowpass, bandpass and highpass outputs on one channel each
+void renderStateVariableFilter(float* const* output, const float* const* input, unsigned int, unsigned int numSamples)
+{
+    DSP::StateVariableFilter filter;
+    filter.prepare(Golden::SampleRate);
+
+    std::vector<float> freq(numSamples);
+    std::vector<float> reso(numSamples, 2.f);
+    for (unsigned int n = 0; n < numSamples; ++n)
+        freq[n] = 100.f * std::pow(100.f, static_cast<float>(n) / static_cast<float>(numSamples));
+
+    for (unsigned int pos = 0; pos < numSamples; pos += Golden::BlockSize)
+        filter.process(output[0] + pos, output[1] + pos, output[2] + pos, input[0] + pos,
+                       freq.data() + pos, reso.data() + pos, std::min(Golden::BlockSize, numSamples - pos));
+}
+
+void renderRingMod(float* const* output, const float* const* input, unsigned int numChannels, unsigned int numSamples)
+{
+    DSP::RingMod ringMod;
+    ringMod.setModType(DSP::RingMod::Tri);
+    ringMod.setModRate(300.f);
+    ringMod.prepare(Golden::SampleRate);
+
+    Golden::forEachBlock(output, input, numChannels, numSamples, [&](float* const* out, const float* const* in, unsigned int n)
+    {
+        ringMod.process(out, in, numChannels, n);
+    });
+}
+
+void renderFlanger(float* const* output, const float* const* input, unsigned int numChannels, unsigned int numSamples)
+{
+    DSP::Flanger flanger(10.f, numChannels);
+    flanger.setOffset(2.f);
+    flanger.setDepth(1.f);
+    flanger.setModulationRate(0.5f);
+    flanger.setModulationType(DSP::Flanger::Sin);
+    flanger.prepare(Golden::SampleRate, 10.f, numChannels);
+
+    Golden::forEachBlock(output, input, numChannels, numSamples, [&](float* const* out, const float* const* in, unsigned int n)
+    {
+        flanger.process(out, in, numChannels, n);
+    });
+}
+
+void renderDelay(float* const* output, const float* const* input, unsigned int numChannels, unsigned int numSamples)
+{
+    DSP::Delay delay(100.f, numChannels);
+    delay.setDelayTime(15.f);
+    delay.setFeedback(0.5f);
+    delay.setWow(0.3f);
+    delay.setToneFrequency(3000.f);
+    delay.setDistortion(6.f);
+    delay.prepare(Golden::SampleRate, 100.f, numChannels);
+
+    Golden::forEachBlock(output, input, numChannels, numSamples, [&](float* const* out, const float* const* in, unsigned int n)
+    {
+        delay.process(out, in, numChannels, n);
+    });
+}
+
+void renderGranularPitchShifter(float* const* output, const float* const* input, unsigned int numChannels, unsigned int numSamples)
+{
+    DSP::GranularPitchShifter shifter(20.f, numChannels);
+    shifter.prepare(Golden::SampleRate);
+    shifter.setPitchRatio(1.5f);
+
+    Golden::forEachBlock(output, input, numChannels, numSamples, [&](float* const* out, const float* const* in, unsigned int n)
+    {
+        shifter.process(out, in, numChannels, n);
+    });
+}
+
+void renderShimmer(float* const* output, const float* const* input, unsigned int numChannels, unsigned int numSamples)
+{
+    DSP::Shimmer shimmer(100.f, 20.f, numChannels);
+    shimmer.setBuildup(10.f);
+    shimmer.prepare(Golden::SampleRate, 100.f, numChannels, Golden::BlockSize);
+    shimmer.setRatio1(2.f);
+    shimmer.setRatio2(0.5f);
+
+    Golden::forEachBlock(output, input, numChannels, numSamples, [&](float* const* out, const float* const* in, unsigned int n)
+    {
+        shimmer.process(out, in, numChannels, n);
+    });
+}
+
+}
+
+namespace Golden
+{
+
+const std::vector<Case>& getCases()
+{
+    static const std::vector<Case> cases {
+        { "DelayLine", Impulse, 2, NumSamples, renderDelayLine },
+        { "DelayLine", Noise, 2, NumSamples, renderDelayLine },
+        { "DelayLineModulated", Sweep, 2, NumSamples, renderDelayLineModulated },
+        { "AllPass", Impulse, 2, NumSamples, renderAllPass },
+        { "AllPass", Noise, 2, NumSamples, renderAllPass },
+        { "Biquad", Impulse, 2, NumSamples, renderBiquad },
+        { "Biquad", Sweep, 2, NumSamples, renderBiquad },
+        { "Biquad", Noise, 2, NumSamples, renderBiquad },
+        { "ParametricEqualizer", Impulse, 2, NumSamples, renderParametricEqualizer },
+        { "ParametricEqualizer", Sweep, 2, NumSamples, renderParametricEqualizer },
+        { "ParametricEqualizerSmoothed", Noise, 2, NumSamples, renderParametricEqualizerSmoothed },
+        { "Ramp", Noise, 2, NumSamples, renderRamp },
+        { "LeakyIntegrator", Impulse, 2, NumSamples, renderLeakyIntegrator },
+        { "LeakyIntegrator", Noise, 2, NumSamples, renderLeakyIntegrator },
+        { "LFO", None, 4, NumSamples, renderLFO },
+        { "Oscillator", None, 5, NumSamples, renderOscillator },
+        { "EnvelopeGenerator", None, 2, NumSamples, renderEnvelopeGenerator },
+        { "StateVariableFilter", Noise, 3, NumSamples, renderStateVariableFilter },
+        { "RingMod", Sweep, 2, NumSamples, renderRingMod },
+        { "Flanger", Noise, 2, NumSamples, renderFlanger },
+        { "Delay", Impulse, 2, NumSamples, renderDelay },
+        { "Delay", Noise, 2, NumSamples, renderDelay },
+        { "GranularPitchShifter", Sweep, 2, NumSamples, renderGranularPitchShifter },
+        { "Shimmer", Impulse, 2, NumSamples, renderShimmer },
+        { "Shimmer", Sweep, 2, NumSamples, renderShimmer }
+    };
+
+    return cases;
+}
+
+}
\ No newline at end of file
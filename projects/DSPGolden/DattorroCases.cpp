@@ -0,0 +1,91 @@
+#include "GoldenCases.h"
+
+#include "DattorroReverb.h"
+#include "DattorroDelayLine.h"
+#include "DattorroAllPass.h"
+
+// Golden cases of the Dattorro reverb and of its DelayLine and AllPass, which share their
+// names with the ones of DSPCases.cpp and are built into a tool of their own
+
+namespace
+{
+
+// The reverb tank takes about 0.35s for a round trip, long enough to recirculate a few times
+constexpr unsigned int ReverbSamples { 32768 };
+
+// Single sample processing, one frame of every channel at a time
+template <typename Processor>
+void processFrames(Processor& processor, float* const* output, const float* const* input, unsigned int numChannels, unsigned int numSamples)
+{
+    std::vector<float> in(numChannels);
+    std::vector<float> out(numChannels);
+
+    for (unsigned int n = 0; n < numSamples; ++n)
+    {
+        for (unsigned int ch = 0; ch < numChannels; ++ch)
+            in[ch] = input[ch][n];
+        processor.process(out.data(), in.data(), numChannels);
+        for (unsigned int ch = 0; ch < numChannels; ++ch)
+            output[ch][n] = out[ch];
+    }
+}
+
+void renderDattorroDelayLine(float* const* output, const float* const* input, unsigned int numChannels, unsigned int numSamples)
+{
+    DSP::DelayLine delayLine(64, numChannels);
+    delayLine.setDelaySamples(37);
+
+    processFrames(delayLine, output, input, numChannels, numSamples);
+}
+
+void renderDattorroAllPass(float* const* output, const float* const* input, unsigned int numChannels, unsigned int numSamples)
+{
+    DSP::AllPass allPass(142.f, 0.75f, numChannels);
+    allPass.prepare(numChannels);
+
+    processFrames(allPass, output, input, numChannels, numSamples);
+}
+
+void renderDattorroReverb(float* const* output, const float* const* input, unsigned int numChannels, unsigned int numSamples, float brightness, float decay)
+{
+    DSP::DattorroReverb reverb(Golden::SampleRate, numChannels, brightness, decay);
+    reverb.prepare(Golden::SampleRate, numChannels);
+    reverb.setBrightness(brightness);
+    reverb.setDecay(decay);
+
+    Golden::forEachBlock(output, input, numChannels, numSamples, [&](float* const* out, const float* const* in, unsigned int n)
+    {
+        reverb.process(out, in, numChannels, n);
+    });
+}
+
+void renderDattorroReverbDefault(float* const* output, const float* const* input, unsigned int numChannels, unsigned int numSamples)
+{
+    renderDattorroReverb(output, input, numChannels, numSamples, 0.5f, 0.5f);
+}
+
+void renderDattorroReverbLong(float* const* output, const float* const* input, unsigned int numChannels, unsigned int numSamples)
+{
+    renderDattorroReverb(output, input, numChannels, numSamples, 0.2f, 0.9f);
+}
+
+}
+
+namespace Golden
+{
+
+const std::vector<Case>& getCases()
+{
+    static const std::vector<Case> cases {
+        { "DattorroDelayLine", Impulse, 2, NumSamples, renderDattorroDelayLine },
+        { "DattorroDelayLine", Noise, 2, NumSamples, renderDattorroDelayLine },
+        { "DattorroAllPass", Impulse, 2, NumSamples, renderDattorroAllPass },
+        { "DattorroAllPass", Noise, 2, NumSamples, renderDattorroAllPass },
+        { "DattorroReverb", Impulse, 2, ReverbSamples, renderDattorroReverbDefault },
+        { "DattorroReverbLong", Noise, 2, NumSamples, renderDattorroReverbLong }
+    };
+
+    return cases;
+}
+
+}
\ No newline at end of file
@@ -0,0 +1,132 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+// Golden output cases of the DSP classes of projects/DSP, rendered by the dsp_golden tools,
+// and of their optimized copies in projects/Shimmer, rendered by shimmer_golden
+// Every case feeds a deterministic signal through a freshly constructed processor and
+// the tool compares the output with a golden file rendered before.
+namespace Golden
+{
+
+// Sample rate and block size every case is rendered at
+// The block size is not a power of two, so block boundaries fall anywhere inside the
+// internal chunks and buffers of the processors
+static constexpr double SampleRate { 48000.0 };
+static constexpr unsigned int BlockSize { 100 };
+
+// Length of a case, unless it needs a longer tail
+static constexpr unsigned int NumSamples { 4096 };
+
+// Input signal of a case, a channel gain of 1 on even channels and -0.5 on odd ones
+// tells channels apart, the noise of every channel is independent
+enum Signal : unsigned int
+{
+    // No input, for generators
+    None = 0,
+    // Unit impulse at the first sample
+    Impulse,
+    // Exponential sine sweep from 20Hz to 20kHz over the case, -6dB
+    Sweep,
+    // Uniform white noise of a fixed seed, -6dB peak
+    Noise
+};
+
+struct Case
+{
+    const char* name;
+    Signal signal;
+    unsigned int numChannels;
+    unsigned int numSamples;
+
+    // Render the output of a new processor for the input, numChannels buffers of numSamples each
+    void (*render)(float* const* output, const float* const* input, unsigned int numChannels, unsigned int numSamples);
+
+    // For output that is not bit exact between builds, error relative to the golden peak
+    // every sample must stay below, whatever its ULP distance. 0 uses the tool tolerances
+    double toleranceDb { 0.0 };
+};
+
+// Cases of the tool, defined by the case file it is built with
+const std::vector<Case>& getCases();
+
+inline const char* getSignalName(Signal signal)
+{
+    switch (signal)
+    {
+    case Impulse: return "Impulse";
+    case Sweep: return "Sweep";
+    case Noise: return "Noise";
+    default: return "";
+    }
+}
+
+// Fill numChannels buffers of numSamples each with a signal
+// Computed in double precision, with a noise generator of its own rather than the
+// standard library engines and distributions, which differ between implementations
+inline void makeSignal(Signal signal, float* const* output, unsigned int numChannels, unsigned int numSamples)
+{
+    constexpr double Pi { 3.14159265358979323846 };
+    constexpr double StartHz { 20.0 };
+    constexpr double EndHz { 20000.0 };
+
+    const double sweepRate { std::log(EndHz / StartHz) / static_cast<double>(numSamples) };
+
+    for (unsigned int ch = 0; ch < numChannels; ++ch)
+    {
+        const double gain { ch % 2 == 0 ? 1.0 : -0.5 };
+        uint32_t noiseState { 0x9E3779B9u * (ch + 1u) };
+
+        for (unsigned int n = 0; n < numSamples; ++n)
+        {
+            double x { 0.0 };
+            switch (signal)
+            {
+            case Impulse:
+                x = n == 0 ? 1.0 : 0.0;
+                break;
+
+            case Sweep:
+                // Phase of an exponential sweep, the integral of StartHz * exp(sweepRate * n)
+                x = 0.5 * std::sin(2.0 * Pi * StartHz / SampleRate * (std::exp(sweepRate * n) - 1.0) / sweepRate);
+                break;
+
+            case Noise:
+                // xorshift32, top 24 bits scaled to [-0.5, 0.5)
+                noiseState ^= noiseState << 13;
+                noiseState ^= noiseState >> 17;
+                noiseState ^= noiseState << 5;
+                x = static_cast<double>(noiseState >> 8) / 16777216.0 - 0.5;
+                break;
+
+            default: break;
+            }
+
+            output[ch][n] = static_cast<float>(gain * x);
+        }
+    }
+}
+
+// Call process(output, input, numBlockSamples) for consecutive blocks of BlockSize samples
+template <typename Process>
+void forEachBlock(float* const* output, const float* const* input, unsigned int numChannels, unsigned int numSamples, Process&& process)
+{
+    std::vector<float*> blockOutput(numChannels);
+    std::vector<const float*> blockInput(numChannels);
+
+    for (unsigned int pos = 0; pos < numSamples; pos += BlockSize)
+    {
+        for (unsigned int ch = 0; ch < numChannels; ++ch)
+        {
+            blockOutput[ch] = output[ch] + pos;
+            blockInput[ch] = input[ch] + pos;
+        }
+
+        const unsigned int numBlockSamples { numSamples - pos < BlockSize ? numSamples - pos : BlockSize };
+        process(blockOutput.data(), blockInput.data(), numBlockSamples);
+    }
+}
+
+}
\ No newline at end of file
@@ -0,0 +1,255 @@
+#include <JuceHeader.h>
+#include "GoldenCases.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <vector>
+
+// Golden output regression tool for the DSP classes of projects/DSP
+// Renders every case of GoldenCases.h, a deterministic signal through a new processor,
+// and compares the output sample by sample with the golden file of the case.
+//
+// Usage:
+//   dsp_golden --golden-dir=<dir> [--tolerance-ulp=<n>] [--tolerance-db=<dB>] [--case=<name>]
+//   dsp_golden --golden-dir=<dir> --write-golden [--case=<name>]
+//
+// Goldens are 32 bit float WAV files named after the case and its signal, rendered into
+// projects/DSPGolden/Golden. A sample passes if it is within the ULP tolerance of the golden
+// one, or if the error is below the dB tolerance relative to the peak of the golden.
+// The default of -80dB passes the goldens with and without fused multiply-adds, which move
+// the resonant filters the most. On the toolchain that rendered them -120dB holds as well.
+// Exits with 1 if any case fails or has no golden. --write-golden renders the goldens
+// instead, for a change that is meant to alter the output. --case only runs the cases
+// whose name contains the given text.
+// dsp_golden_dattorro is the same tool for the Dattorro reverb, whose DelayLine and
+// AllPass cannot be linked next to the other ones, and shimmer_golden for the optimized
+// copies of projects/Shimmer, with goldens in Golden/Shimmer. Cases that are not bit exact
+// between builds, like the FFT convolution, only check their own dB tolerance.
+
+namespace
+{
+
+struct Options
+{
+    juce::File goldenDir;
+    juce::String caseFilter;
+    bool writeGolden { false };
+    int64_t toleranceUlp { 16 };
+    double toleranceDb { -80.0 };
+};
+
+void printUsage()
+{
+    std::printf("Usage: dsp_golden --golden-dir=<dir> [--tolerance-ulp=<n>] [--tolerance-db=<dB>] [--case=<name>]\n"
+                "       dsp_golden --golden-dir=<dir> --write-golden [--case=<name>]\n");
+}
+
+Options parseOptions(const juce::ArgumentList& args)
+{
+    Options options;
+
+    if (args.containsOption("--golden-dir"))
+        options.goldenDir = args.getFileForOption("--golden-dir");
+
+    if (args.containsOption("--case"))
+        options.caseFilter = args.getValueForOption("--case");
+
+    if (args.containsOption("--tolerance-ulp"))
+        options.toleranceUlp = std::max(args.getValueForOption("--tolerance-ulp").getLargeIntValue(), static_cast<juce::int64>(0));
+
+    if (args.containsOption("--tolerance-db"))
+        options.toleranceDb = args.getValueForOption("--tolerance-db").getDoubleValue();
+
+    options.writeGolden = args.containsOption("--write-golden");
+
+    return options;
+}
+
+juce::String getCaseName(const Golden::Case& goldenCase)
+{
+    juce::String name { goldenCase.name };
+    if (goldenCase.signal != Golden::None)
+        name << "_" << Golden::getSignalName(goldenCase.signal);
+    return name;
+}
+
+juce::AudioBuffer<float> renderCase(const Golden::Case& goldenCase)
+{
+    const int numChannels { static_cast<int>(goldenCase.numChannels) };
+    const int numSamples { static_cast<int>(goldenCase.numSamples) };
+
+    juce::AudioBuffer<float> input(numChannels, numSamples);
+    Golden::makeSignal(goldenCase.signal, input.getArrayOfWritePointers(), goldenCase.numChannels, goldenCase.numSamples);
+
+    juce::AudioBuffer<float> output(numChannels, numSamples);
+    output.clear();
+    goldenCase.render(output.getArrayOfWritePointers(), input.getArrayOfReadPointers(), goldenCase.numChannels, goldenCase.numSamples);
+
+    return output;
+}
+
+// Distance of two floats in units in the last place, the number of floats between them
+int64_t getUlpDistance(float a, float b)
+{
+    if (std::isnan(a) || std::isnan(b))
+        return std::numeric_limits<int64_t>::max();
+
+    // Map the sign magnitude bit patterns to a monotonic integer scale, -0 and +0 both to 0
+    const auto toOrdered = [](float x)
+    {
+        int32_t bits;
+        std::memcpy(&bits, &x, sizeof(bits));
+        return bits < 0 ? -static_cast<int64_t>(bits & 0x7fffffff) : static_cast<int64_t>(bits);
+    };
+
+    return std::abs(toOrdered(a) - toOrdered(b));
+}
+
+bool writeGolden(const juce::File& file, const juce::AudioBuffer<float>& output)
+{
+    file.deleteFile();
+
+    juce::WavAudioFormat wav;
+    std::unique_ptr<juce::OutputStream> stream { std::make_unique<juce::FileOutputStream>(file) };
+    // 32 bit WAV files are written as floats, so goldens hold the output bit for bit
+    std::unique_ptr<juce::AudioFormatWriter> writer { wav.createWriterFor(stream.get(), Golden::SampleRate,
+                                                                         static_cast<unsigned int>(output.getNumChannels()),
+                                                                         32, {}, 0) };
+    if (writer == nullptr)
+        return false;
+
+    stream.release(); // now owned by the writer
+    return writer->writeFromAudioSampleBuffer(output, 0, output.getNumSamples());
+}
+
+bool readGolden(const juce::File& file, juce::AudioBuffer<float>& golden)
+{
+    juce::WavAudioFormat wav;
+    std::unique_ptr<juce::AudioFormatReader> reader { wav.createReaderFor(file.createInputStream().release(), true) };
+    if (reader == nullptr)
+        return false;
+
+    golden.setSize(static_cast<int>(reader->numChannels), static_cast<int>(reader->lengthInSamples));
+    return reader->read(&golden, 0, golden.getNumSamples(), 0, true, true);
+}
+
+// Compare the output of a case with its golden and print the result
+// Returns true if the case passed
+bool compareCase(const juce::String& name, const Golden::Case& goldenCase, const juce::AudioBuffer<float>& output,
+                 const juce::File& file, const Options& options)
+{
+    juce::AudioBuffer<float> golden;
+    if (!file.existsAsFile() || !readGolden(file, golden))
+    {
+        std::printf("%-40s no golden %s FAIL\n", name.toRawUTF8(), file.getFullPathName().toRawUTF8());
+        return false;
+    }
+
+    if (golden.getNumChannels() != output.getNumChannels() || golden.getNumSamples() != output.getNumSamples())
+    {
+        std::printf("%-40s golden is %d x %d, output is %d x %d FAIL\n", name.toRawUTF8(),
+                    golden.getNumChannels(), golden.getNumSamples(), output.getNumChannels(), output.getNumSamples());
+        return false;
+    }
+
+    const bool bitExact { goldenCase.toleranceDb == 0.0 };
+    const double toleranceDb { bitExact ? options.toleranceDb : goldenCase.toleranceDb };
+    const double peak { static_cast<double>(golden.getMagnitude(0, golden.getNumSamples())) };
+    const double errorFloor { std::pow(10.0, toleranceDb / 20.0) * peak };
+
+    int64_t maxUlp { 0 };
+    double maxError { 0.0 };
+    int numFailed { 0 };
+    for (int ch = 0; ch < output.getNumChannels(); ++ch)
+    {
+        const float* rendered { output.getReadPointer(ch) };
+        const float* expected { golden.getReadPointer(ch) };
+        for (int n = 0; n < output.getNumSamples(); ++n)
+        {
+            const int64_t ulp { getUlpDistance(rendered[n], expected[n]) };
+            const double error { std::abs(static_cast<double>(rendered[n]) - static_cast<double>(expected[n])) };
+            maxUlp = std::max(maxUlp, ulp);
+            maxError = std::isnan(error) ? std::numeric_limits<double>::infinity() : std::max(maxError, error);
+
+            if ((!bitExact || ulp > options.toleranceUlp) && !(error <= errorFloor))
+                ++numFailed;
+        }
+    }
+
+    const double errorDb { maxError > 0.0 ? 20.0 * std::log10(maxError / std::max(peak, 1e-30)) : -std::numeric_limits<double>::infinity() };
+    std::printf("%-40s max %lld ulp, %8.1f dB, %d samples out of tolerance %s\n", name.toRawUTF8(),
+                static_cast<long long>(maxUlp), errorDb, numFailed, numFailed == 0 ? "PASS" : "FAIL");
+
+    return numFailed == 0;
+}
+
+// Returns the process exit code
+int run(const Options& options)
+{
+    if (options.writeGolden && !options.goldenDir.createDirectory())
+        juce::ConsoleApplication::fail("Could not create " + options.goldenDir.getFullPathName());
+
+    if (!options.writeGolden)
+        std::printf("Tolerance %lld ulp, %.1f dB\n", static_cast<long long>(options.toleranceUlp), options.toleranceDb);
+
+    int numCases { 0 };
+    int numFailed { 0 };
+    for (const auto& goldenCase : Golden::getCases())
+    {
+        const juce::String name { getCaseName(goldenCase) };
+        if (options.caseFilter.isNotEmpty() && !name.contains(options.caseFilter))
+            continue;
+
+        const juce::AudioBuffer<float> output { renderCase(goldenCase) };
+        const juce::File file { options.goldenDir.getChildFile(name + ".wav") };
+        ++numCases;
+
+        if (options.writeGolden)
+        {
+            if (!writeGolden(file, output))
+                juce::ConsoleApplication::fail("Could not write " + file.getFullPathName());
+            std::printf("Wrote %s\n", file.getFullPathName().toRawUTF8());
+        }
+        else if (!compareCase(name, goldenCase, output, file, options))
+        {
+            ++numFailed;
+        }
+    }
+
+    if (!options.writeGolden)
+        std::printf("%d of %d cases passed\n", numCases - numFailed, numCases);
+
+    return numFailed == 0 ? 0 : 1;
+}
+
+}
+
+int main(int argc, char* argv[])
+{
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+    return juce::ConsoleApplication::invokeCatchingFailures([&]
+    {
+        juce::ArgumentList args(argc, argv);
+
+        if (args.containsOption("--help|-h"))
+        {
+            printUsage();
+            return 0;
+        }
+
+        const Options options { parseOptions(args) };
+
+        if (options.goldenDir != juce::File())
+            return run(options);
+
+        printUsage();
+        return 1;
+    });
+}
\ No newline at end of file
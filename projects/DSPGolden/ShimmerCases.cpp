@@ -0,0 +1,272 @@
+#include "GoldenCases.h"
+
+#include "DelayLine.h"
+#include "AllPass.h"
+#include "Ramp.h"
+#include "KeithBarrReverb.h"
+#include "DattorroReverb.h"
+#include "DattorroReverbBank.h"
+#include "GranularPitchShifter.h"
+#include "ConvolutionReverb.h"
+#include "Shimmer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+// Golden cases of the optimized copies in projects/Shimmer, which share their class names
+// with the projects/DSP ones and are built into the shimmer_golden tool. Their goldens live
+// in Golden/Shimmer, so the case names stay the class names.
+
+namespace
+{
+
+// The reverb tanks take about 0.35s for a round trip, long enough to recirculate a few times
+constexpr unsigned int ReverbSamples { 32768 };
+
+// The convolution reverb runs its late segment on a worker thread from twice
+// LateBlockSamples into the response on, the case renders past that point
+constexpr unsigned int ConvolutionIrSamples { 24000 };
+constexpr unsigned int ConvolutionSamples { 32768 };
+// The FFT partitions sum in an order the compiler may reassociate or fuse, so the
+// convolution reverb is compared within a tolerance instead of bit for bit
+constexpr double ConvolutionToleranceDb { -100.0 };
+
+void renderDelayLine(float* const* output, const float* const* input, unsigned int numChannels, unsigned int numSamples)
+{
+    DSP::DelayLine delayLine(1024, numChannels);
+    delayLine.setDelaySamples(37);
+
+    Golden::forEachBlock(output, input, numChannels, numSamples, [&](float* const* out, const float* const* in, unsigned int n)
+    {
+        delayLine.process(out, in, numChannels, n);
+    });
+}
+
+// Interleaved arena layout, with audio rate modulation of 0 to 16 samples on top of a 20 sample delay
+void renderDelayLineInterleaved(float* const* output, const float* const* input, unsigned int numChannels, unsigned int numSamples)
+{
+    DSP::DelayLine delayLine(1024, numChannels, DSP::DelayLine::Interleaved);
+    delayLine.setDelaySamples(20);
+
+    std::vector<std::vector<float>> mod(numChannels, std::vector<float>(numSamples));
+    for (unsigned int ch = 0; ch < numChannels; ++ch)
+        for (unsigned int n = 0; n < numSamples; ++n)
+            mod[ch][n] = 8.f + 8.f * std::sin(static_cast<float>(2.0 * M_PI * 3.0 / Golden::SampleRate) * static_cast<float>(n) + static_cast<float>(ch));
+
+    unsigned int pos { 0 };
+    std::vector<const float*> blockMod(numChannels);
+    Golden::forEachBlock(output, input, numChannels, numSamples, [&](float* const* out, const float* const* in, unsigned int n)
+    {
+        for (unsigned int ch = 0; ch < numChannels; ++ch)
+            blockMod[ch] = mod[ch].data() + pos;
+        delayLine.process(out, in, blockMod.data(), numChannels, n);
+        pos += n;
+    });
+}
+
+void renderAllPass(float* const* output, const float* const* input, unsigned int numChannels, unsigned int numSamples, float delayMs)
+{
+    DSP::AllPass allPass(delayMs, 0.7f, numChannels);
+    allPass.prepare(Golden::SampleRate, numChannels);
+
+    Golden::forEachBlock(output, input, numChannels, numSamples, [&](float* const* out, const float* const* in, unsigned int n)
+    {
+        allPass.process(out, in, numChannels, n);
+    });
+}
+
+// 240 samples of delay, processed in chunks of BlockChunkSamples
+void renderAllPassChunked(float* const* output, const float* const* input, unsigned int numChannels, unsigned int numSamples)
+{
+    renderAllPass(output, input, numChannels, numSamples, 5.f);
+}
+
+// 24 samples of delay, the chunks are limited to the delay
+void renderAllPassShort(float* const* output, const float* const* input, unsigned int numChannels, unsigned int numSamples)
+{
+    renderAllPass(output, input, numChannels, numSamples, 0.5f);
+}
+
+// Gain ramp to 1, then back down to 0.25 halfway, once through the moving segment
+// and once through the constant one
+void renderRamp(float* const* output, const float* const* input, unsigned int numChannels, unsigned int numSamples)
+{
+    DSP::Ramp<float> ramp(0.02f);
+    ramp.prepare(Golden::SampleRate, true, 0.f);
+    ramp.setTarget(1.f);
+
+    unsigned int pos { 0 };
+    Golden::forEachBlock(output, input, numChannels, numSamples, [&](float* const* out, const float* const* in, unsigned int n)
+    {
+        if (pos < numSamples / 2 && pos + n >= numSamples / 2)
+            ramp.setTarget(0.25f);
+        ramp.applyGain(out, in, numChannels, n);
+        pos += n;
+    });
+}
+
+// Summing and inverse gain kernels, a new target every 700 samples, so ramps
+// start and settle in the middle of blocks
+void renderRampSum(float* const* output, const float* const* input, unsigned int numChannels, unsigned int numSamples)
+{
+    DSP::Ramp<float> ramp(0.01f);
+    ramp.prepare(Golden::SampleRate, true, 0.f);
+
+    unsigned int pos { 0 };
+    unsigned int step { 0 };
+    Golden::forEachBlock(output, input, numChannels, numSamples, [&](float* const* out, const float* const* in, unsigned int n)
+    {
+        if (pos >= step * 700u)
+            ramp.setTarget(++step % 2 == 0 ? 0.2f : 0.8f);
+        ramp.applyInverseGain(out, in, numChannels, n);
+        ramp.applySum(out, numChannels, n);
+        pos += n;
+    });
+}
+
+void renderKeithBarrReverb(float* const* output, const float* const* input, unsigned int numChannels, unsigned int numSamples)
+{
+    DSP::KeithBarrReverb reverb(numChannels, 0.5f);
+    reverb.prepare(Golden::SampleRate, numChannels);
+
+    Golden::forEachBlock(output, input, numChannels, numSamples, [&](float* const* out, const float* const* in, unsigned int n)
+    {
+        reverb.process(out, in, numChannels, n);
+    });
+}
+
+void renderDattorroReverb(float* const* output, const float* const* input, unsigned int numChannels, unsigned int numSamples, float brightness, float decay)
+{
+    DSP::DattorroReverb reverb(Golden::SampleRate, numChannels, brightness, decay);
+    reverb.prepare(Golden::SampleRate, numChannels);
+    reverb.setBrightness(brightness);
+    reverb.setDecay(decay);
+
+    Golden::forEachBlock(output, input, numChannels, numSamples, [&](float* const* out, const float* const* in, unsigned int n)
+    {
+        reverb.process(out, in, numChannels, n);
+    });
+}
+
+void renderDattorroReverbDefault(float* const* output, const float* const* input, unsigned int numChannels, unsigned int numSamples)
+{
+    renderDattorroReverb(output, input, numChannels, numSamples, 0.5f, 0.5f);
+}
+
+void renderDattorroReverbLong(float* const* output, const float* const* input, unsigned int numChannels, unsigned int numSamples)
+{
+    renderDattorroReverb(output, input, numChannels, numSamples, 0.2f, 0.9f);
+}
+
+// Four stereo lanes with their own brightness and decay, lane l on channels 2l and 2l + 1
+void renderDattorroReverbBank(float* const* output, const float* const* input, unsigned int numChannels, unsigned int numSamples)
+{
+    constexpr unsigned int numLanes { 4 };
+
+    DSP::DattorroReverbBank bank(numLanes, 0.5f, 0.5f);
+    bank.prepare(Golden::SampleRate);
+    for (unsigned int l = 0; l < numLanes; ++l)
+    {
+        bank.setBrightness(l, 0.2f + 0.2f * static_cast<float>(l));
+        bank.setDecay(l, 0.3f + 0.15f * static_cast<float>(l));
+    }
+
+    for (unsigned int ch = 0; ch < numChannels; ++ch)
+        std::copy(input[ch], input[ch] + numSamples, output[ch]);
+
+    // The bank processes its lane buffers in place
+    Golden::forEachBlock(output, input, numChannels, numSamples, [&](float* const* out, const float* const*, unsigned int n)
+    {
+        for (unsigned int l = 0; l < numLanes; ++l)
+            bank.setLaneBuffers(l, out + 2 * l, 2);
+        bank.process(n);
+    });
+}
+
+void renderGranularPitchShifter(float* const* output, const float* const* input, unsigned int numChannels, unsigned int numSamples)
+{
+    DSP::GranularPitchShifter shifter(20.f, numChannels);
+    shifter.prepare(Golden::SampleRate);
+    shifter.setPitchRatio(1.5f);
+
+    Golden::forEachBlock(output, input, numChannels, numSamples, [&](float* const* out, const float* const* in, unsigned int n)
+    {
+        shifter.process(out, in, numChannels, n);
+    });
+}
+
+void renderShimmer(float* const* output, const float* const* input, unsigned int numChannels, unsigned int numSamples)
+{
+    DSP::Shimmer shimmer(100.f, 20.f, numChannels);
+    shimmer.setBuildup(10.f);
+    shimmer.prepare(Golden::SampleRate, 100.f, numChannels, Golden::BlockSize);
+    shimmer.setRatio1(2.f);
+    shimmer.setRatio2(0.5f);
+
+    Golden::forEachBlock(output, input, numChannels, numSamples, [&](float* const* out, const float* const* in, unsigned int n)
+    {
+        shimmer.process(out, in, numChannels, n);
+    });
+}
+
+// Exponentially decaying noise response, a different one per channel
+void renderConvolutionReverb(float* const* output, const float* const* input, unsigned int numChannels, unsigned int numSamples)
+{
+    std::vector<std::vector<float>> ir(numChannels, std::vector<float>(ConvolutionIrSamples));
+    std::vector<const float*> irPtrs(numChannels);
+    for (unsigned int ch = 0; ch < numChannels; ++ch)
+    {
+        uint32_t noiseState { 0x2545F491u * (ch + 1u) };
+        for (unsigned int n = 0; n < ConvolutionIrSamples; ++n)
+        {
+            noiseState ^= noiseState << 13;
+            noiseState ^= noiseState >> 17;
+            noiseState ^= noiseState << 5;
+            const double noise { static_cast<double>(noiseState >> 8) / 16777216.0 - 0.5 };
+            ir[ch][n] = static_cast<float>(0.1 * noise * std::exp(-static_cast<double>(n) / 6000.0));
+        }
+        irPtrs[ch] = ir[ch].data();
+    }
+
+    DSP::ConvolutionReverb reverb(numChannels);
+    reverb.prepare(Golden::SampleRate);
+    reverb.setImpulseResponse(irPtrs.data(), numChannels, ConvolutionIrSamples);
+
+    Golden::forEachBlock(output, input, numChannels, numSamples, [&](float* const* out, const float* const* in, unsigned int n)
+    {
+        reverb.process(out, in, numChannels, n);
+    });
+}
+
+}
+
+namespace Golden
+{
+
+const std::vector<Case>& getCases()
+{
+    static const std::vector<Case> cases {
+        { "DelayLine", Impulse, 2, NumSamples, renderDelayLine },
+        { "DelayLine", Noise, 2, NumSamples, renderDelayLine },
+        { "DelayLineInterleaved", Sweep, 2, NumSamples, renderDelayLineInterleaved },
+        { "AllPassChunked", Impulse, 2, NumSamples, renderAllPassChunked },
+        { "AllPassChunked", Noise, 2, NumSamples, renderAllPassChunked },
+        { "AllPassShort", Noise, 2, NumSamples, renderAllPassShort },
+        { "Ramp", Noise, 2, NumSamples, renderRamp },
+        { "RampSum", Noise, 2, NumSamples, renderRampSum },
+        { "KeithBarrReverb", Impulse, 2, ReverbSamples, renderKeithBarrReverb },
+        { "KeithBarrReverb", Noise, 2, NumSamples, renderKeithBarrReverb },
+        { "DattorroReverb", Impulse, 2, ReverbSamples, renderDattorroReverbDefault },
+        { "DattorroReverbLong", Noise, 2, NumSamples, renderDattorroReverbLong },
+        { "DattorroReverbBank", Noise, 8, NumSamples, renderDattorroReverbBank },
+        { "GranularPitchShifter", Sweep, 2, NumSamples, renderGranularPitchShifter },
+        { "Shimmer", Impulse, 2, NumSamples, renderShimmer },
+        { "Shimmer", Sweep, 2, NumSamples, renderShimmer },
+        { "ConvolutionReverb", Noise, 2, ConvolutionSamples, renderConvolutionReverb, ConvolutionToleranceDb }
+    };
+
+    return cases;
+}
+
+}
\ No newline at end of file
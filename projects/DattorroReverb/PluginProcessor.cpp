@@ -107,6 +107,7 @@ void DattorroReverbProcessor::releaseResources()
 void DattorroReverbProcessor::processBlock(juce::AudioBuffer<float>& buffer, juce::MidiBuffer& /*midiMessages*/)
 {
     juce::ScopedNoDenormals noDenormals;
+    mrta::RealtimeScope realtimeScope("DattorroReverbProcessor::processBlock");
     parameterManager.updateParameters();
 
     const unsigned int numChannels{ static_cast<unsigned int>(buffer.getNumChannels()) };
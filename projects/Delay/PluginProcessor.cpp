@@ -96,6 +96,7 @@ void DelayAudioProcessor::releaseResources()
 void DelayAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juce::MidiBuffer& /*midiMessages*/)
 {
     juce::ScopedNoDenormals noDenormals;
+    mrta::RealtimeScope realtimeScope("DelayAudioProcessor::processBlock");
     parameterManager.updateParameters();
 
     const unsigned int numChannels { static_cast<unsigned int>(buffer.getNumChannels()) };
@@ -105,6 +105,7 @@ void DelayLineProcessor::releaseResources()
 void DelayLineProcessor::processBlock(juce::AudioBuffer<float>& buffer, juce::MidiBuffer& /*midiMessages*/)
 {
     juce::ScopedNoDenormals noDenormals;
+    mrta::RealtimeScope realtimeScope("DelayLineProcessor::processBlock");
     parameterManager.updateParameters();
 
     const unsigned int numChannels{ static_cast<unsigned int>(buffer.getNumChannels()) };
@@ -71,6 +71,7 @@ void EnvelopeGeneratorAudioProcessor::releaseResources()
 void EnvelopeGeneratorAudioProcessor::processBlock(juce::AudioBuffer<float>& buffer, juce::MidiBuffer& /*midiMessages*/)
 {
     juce::ScopedNoDenormals noDenormals;
+    mrta::RealtimeScope realtimeScope("EnvelopeGeneratorAudioProcessor::processBlock");
     parameterManager.updateParameters();
 
     const unsigned int numChannels{ static_cast<unsigned int>(buffer.getNumChannels()) };
@@ -75,6 +75,7 @@ void FlangerAudioProcessor::releaseResources()
 void FlangerAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juce::MidiBuffer& /*midiMessages*/)
 {
     juce::ScopedNoDenormals noDenormals;
+    mrta::RealtimeScope realtimeScope("FlangerAudioProcessor::processBlock");
     parameterManager.updateParameters();
 
     const unsigned int numChannels { static_cast<unsigned int>(buffer.getNumChannels()) };
@@ -54,6 +54,7 @@ void LeakyIntegratorProcessor::releaseResources()
 void LeakyIntegratorProcessor::processBlock(juce::AudioBuffer<float>& buffer, juce::MidiBuffer& /*midiMessages*/)
 {
     juce::ScopedNoDenormals noDenormals;
+    mrta::RealtimeScope realtimeScope("LeakyIntegratorProcessor::processBlock");
     parameterManager.updateParameters();
 
     const unsigned int numChannels{ static_cast<unsigned int>(buffer.getNumChannels()) };
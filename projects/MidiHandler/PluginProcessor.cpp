@@ -51,6 +51,7 @@ void MidiHandlerAudioProcessor::releaseResources()
 void MidiHandlerAudioProcessor::processBlock(juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages)
 {
     juce::ScopedNoDenormals noDenormals;
+    mrta::RealtimeScope realtimeScope("MidiHandlerAudioProcessor::processBlock");
     paramManager.updateParameters();
 
     synth.renderNextBlock(buffer, midiMessages, 0, buffer.getNumSamples());
@@ -79,6 +79,7 @@ void MainProcessor::prepareToPlay(double sampleRate, int samplesPerBlock)
 void MainProcessor::processBlock(juce::AudioBuffer<float>& buffer, juce::MidiBuffer& /*midiMessages*/)
 {
     juce::ScopedNoDenormals noDenormals;
+    mrta::RealtimeScope realtimeScope("MainProcessor::processBlock");
     parameterManager.updateParameters();
 
     {
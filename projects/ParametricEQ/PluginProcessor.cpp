@@ -116,6 +116,7 @@ void ParametricEQAudioProcessor::releaseResources()
 void ParametricEQAudioProcessor::processBlock(juce::AudioBuffer<float>& buffer, juce::MidiBuffer& /*midiMessages*/)
 {
     juce::ScopedNoDenormals noDenormals;
+    mrta::RealtimeScope realtimeScope("ParametricEQAudioProcessor::processBlock");
     parameterManager.updateParameters();
 
     eq.process(buffer.getArrayOfWritePointers(), buffer.getArrayOfReadPointers(), buffer.getNumChannels(), buffer.getNumSamples());
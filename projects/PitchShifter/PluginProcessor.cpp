@@ -34,6 +34,7 @@ void PitchShifterProcessor::releaseResources()
 void PitchShifterProcessor::processBlock(juce::AudioBuffer<float>& buffer, juce::MidiBuffer&)
 {
     juce::ScopedNoDenormals noDenormals;
+    mrta::RealtimeScope realtimeScope("PitchShifterProcessor::processBlock");
     parameterManager.updateParameters();
 
     float* const* writePtrs = buffer.getArrayOfWritePointers();
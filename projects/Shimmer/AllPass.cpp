@@ -1,10 +1,13 @@
 #include "AllPass.h"
 
+#include <algorithm>
+#include <cmath>
+
 namespace DSP
 {
 
 AllPass::AllPass(float initDelayMs, float initCoeff, unsigned int initNumChannels) :
-    delayLine(static_cast<unsigned int>(std::round(initDelayMs * static_cast<float>(0.001 * sampleRate))),
+    delayLine(static_cast<unsigned int>(std::round(initDelayMs * static_cast<float>(0.001 * DSP::DelayLine::MaxSampleRate))),
                static_cast<unsigned int>(std::min(std::max(initNumChannels, 1u), MaxChannels))),
     delayTimeMs { initDelayMs },
     coeff { initCoeff }
@@ -43,41 +46,95 @@ void AllPass::setDelayTime(float newDelayMs)
 }
 
 void AllPass::process(float* const* output, const float* const* input, unsigned int numChannels, unsigned int numSamples)
-{    
+{
+    numChannels = std::min(numChannels, MaxChannels);
+
+    // While a chunk is not longer than the delay, every delay output it needs
+    // was written by previous chunks, so it can be read upfront in one go
+    // and the chunk input written back as contiguous spans
+    const unsigned int delay { delayLine.getDelaySamples() };
+    const unsigned int capacity { delayLine.getCapacity() };
+    const unsigned int maxChunk { delay < capacity ? std::min({ delay, capacity - delay, BlockChunkSamples }) : 0u };
 
-    for (unsigned int n = 0; n < numSamples; ++n)
+    unsigned int start { 0 };
+    while (maxChunk > 0 && start < numSamples)
     {
-        // Compute the input to the delay line 
-        //
-        float delayIn[2] { 0.f, 0.f };
+        const unsigned int chunk { std::min(numSamples - start, maxChunk) };
+
         for (unsigned int ch = 0; ch < numChannels; ++ch)
         {
-            delayIn[ch] = -coeff * feedbackState[ch] + input[ch][n];
+            float delayOut[BlockChunkSamples];
+            delayLine.readBlock(ch, delay, delayOut, chunk);
+
+            const DSP::DelayLine::SplitSpan delayIn { delayLine.getWriteSpan(ch, chunk) };
+            const float* x { input[ch] + start };
+            float* y { output[ch] + start };
+            float state { feedbackState[ch] };
+
+            for (unsigned int n = 0; n < delayIn.firstSize; ++n)
+            {
+                float& d { delayIn.first[n * delayIn.stride] };
+                d = -coeff * state + x[n] + antiDenormal;
+                y[n] = coeff * d + state;
+                state = delayOut[n];
+            }
+
+            for (unsigned int n = 0; n < delayIn.secondSize; ++n)
+            {
+                const unsigned int i { delayIn.firstSize + n };
+                float& d { delayIn.second[n * delayIn.stride] };
+                d = -coeff * state + x[i] + antiDenormal;
+                y[i] = coeff * d + state;
+                state = delayOut[i];
+            }
+
+            feedbackState[ch] = state;
         }
 
-        for (unsigned int ch = 0; ch < numChannels; ++ch)
+        delayLine.advanceWrite(chunk);
+        start += chunk;
+    }
+
+    // Short delays go sample by sample
+    if (start < numSamples)
+    {
+        if (numChannels == 1)
+            processShortDelay<1>(output, input, start, numSamples - start);
+        else if (numChannels == MaxChannels)
+            processShortDelay<MaxChannels>(output, input, start, numSamples - start);
+    }
+}
+
+template <unsigned int N>
+void AllPass::processShortDelay(float* const* output, const float* const* input, unsigned int startSample, unsigned int numSamples)
+{
+    for (unsigned int n = startSample; n < startSample + numSamples; ++n)
+    {
+        // Compute the input to the delay line and the output
+        float delayIn[N];
+        for (unsigned int ch = 0; ch < N; ++ch)
         {
-            // Compute the output
+            delayIn[ch] = -coeff * feedbackState[ch] + input[ch][n] + antiDenormal;
             output[ch][n] = coeff * delayIn[ch] + feedbackState[ch];
         }
 
         // Process delay
-        delayLine.process(feedbackState, delayIn, numChannels);
-        
+        delayLine.processSample<N>(feedbackState, delayIn);
     }
-
 }
 
 void AllPass::process(float* output, const float* input, unsigned int numChannels)
 {
+    numChannels = std::min(numChannels, MaxChannels);
+
     // Preallocate inputs to delay line
-    float delayIn[2] { 0.f, 0.f };
+    float delayIn[MaxChannels] { };
 
     // Iterate over channels
     for (unsigned int ch = 0; ch < numChannels; ++ch)
     {
         // Compute the delay line input
-        delayIn[ch] = -coeff * feedbackState[ch] + input[ch];
+        delayIn[ch] = -coeff * feedbackState[ch] + input[ch] + antiDenormal;
         // Compute the process output
         output[ch] = coeff * delayIn[ch] + feedbackState[ch];
     }
@@ -88,14 +145,16 @@ void AllPass::process(float* output, const float* input, unsigned int numChannel
 
 void AllPass::process(float*output, const float* input, unsigned int numChannels, const float* modInput)
 {
+    numChannels = std::min(numChannels, MaxChannels);
+
     // Preallocate inputs to delay line
-    float delayIn[2] { 0.f, 0.f };
+    float delayIn[MaxChannels] { };
 
     // Iterate over channels
     for (unsigned int ch = 0; ch < numChannels; ++ch)
     {
         // Compute the delay line input
-        delayIn[ch] = -coeff * feedbackState[ch] + input[ch];
+        delayIn[ch] = -coeff * feedbackState[ch] + input[ch] + antiDenormal;
         // Compute the process output
         output[ch] = coeff * delayIn[ch] + feedbackState[ch];
     }
@@ -104,9 +163,19 @@ void AllPass::process(float*output, const float* input, unsigned int numChannels
     delayLine.process(feedbackState, delayIn, modInput, numChannels);
 }
 
+void AllPass::setDenormalSafe(bool enabled)
+{
+    antiDenormal = enabled ? AntiDenormalOffset : 0.f;
+}
+
 float AllPass::getSample(unsigned int channel, unsigned int index)
 {
     return delayLine.getSample(channel, index);
 }
 
+void AllPass::setTaps(const unsigned int* newTaps, unsigned int numTaps)
+{
+    delayLine.setTaps(newTaps, numTaps);
+}
+
 }
\ No newline at end of file
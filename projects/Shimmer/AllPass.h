@@ -1,6 +1,7 @@
 #pragma once
 
 #include "DelayLine.h"
+#include "Denormals.h"
 
 namespace DSP
 {
@@ -8,6 +9,7 @@ namespace DSP
 class AllPass
 {
 public:
+    // The delay memory fits initDelayMs at DSP::DelayLine::MaxSampleRate, longer delays are clamped
     AllPass(float initDelayMs, float initCoeff, unsigned int initNumChannels);
     AllPass() = delete; // Prevent default constructor
 
@@ -19,7 +21,7 @@ public:
     AllPass(AllPass&&) = delete; // move constructor
     const AllPass& operator=(AllPass&&) = delete; // move assignment operator
 
-    // Update sample rate, reallocates and clear internal buffers
+    // Update sample rate and clear internal buffers, reallocates only for more channels
     void prepare(double sampleRate, unsigned int numChannels);
 
     // Clear content of internal buffer
@@ -40,12 +42,35 @@ public:
     // Process single sample of audio with modulation
     void process(float* output, const float* input, unsigned int numChannels, const float* modInput);
 
+    // Fixed channel count flavours of the single-sample processing, the channel loop unrolls
+    template <unsigned int N>
+    void processSample(float* output, const float* input);
+
+    template <unsigned int N>
+    void processSample(float* output, const float* input, const float* modInput);
+
+    // Add a tiny offset to the feedback, so decaying tails never turn into denormals
+    // even when flush-to-zero is off, on by default
+    void setDenormalSafe(bool enabled);
+
     // Get sample from delay line at requested index
     float getSample(unsigned int channel, unsigned int index);
 
+    // Fixed multi-tap reads from the delay line, see DSP::DelayLine::setTaps()
+    void setTaps(const unsigned int* newTaps, unsigned int numTaps);
+    void readTaps(unsigned int channel, float* output) const { delayLine.readTaps(channel, output); }
+    void readTaps(unsigned int channel, float* output, float modInput) const { delayLine.readTaps(channel, output, modInput); }
+
     static constexpr unsigned int MaxChannels { 2 };
 
+    // Maximum chunk length of the block processing fast path
+    static constexpr unsigned int BlockChunkSamples { 64 };
+
 private: 
+    // Sample by sample block processing for delays shorter than a chunk
+    template <unsigned int N>
+    void processShortDelay(float* const* output, const float* const* input, unsigned int startSample, unsigned int numSamples);
+
     double sampleRate { 48000.0 };
 
     // vector of delay lines of all sections
@@ -53,9 +78,40 @@ private:
     
     float delayTimeMs;
     float coeff;
+    float antiDenormal { AntiDenormalOffset };
 
     // one state per channel
-    float feedbackState[2] { 0.f, 0.f };
+    float feedbackState[MaxChannels] { };
 };
 
+template <unsigned int N>
+void AllPass::processSample(float* output, const float* input)
+{
+    static_assert(N <= MaxChannels, "Too many channels");
+
+    float delayIn[N];
+    for (unsigned int ch = 0; ch < N; ++ch)
+    {
+        delayIn[ch] = -coeff * feedbackState[ch] + input[ch] + antiDenormal;
+        output[ch] = coeff * delayIn[ch] + feedbackState[ch];
+    }
+
+    delayLine.processSample<N>(feedbackState, delayIn);
+}
+
+template <unsigned int N>
+void AllPass::processSample(float* output, const float* input, const float* modInput)
+{
+    static_assert(N <= MaxChannels, "Too many channels");
+
+    float delayIn[N];
+    for (unsigned int ch = 0; ch < N; ++ch)
+    {
+        delayIn[ch] = -coeff * feedbackState[ch] + input[ch] + antiDenormal;
+        output[ch] = coeff * delayIn[ch] + feedbackState[ch];
+    }
+
+    delayLine.processSample<N>(feedbackState, delayIn, modInput);
+}
+
 }
\ No newline at end of file
@@ -30,7 +30,7 @@ void Biquad::reallocateChannels(unsigned int maxNumChannels)
 {
     allocatedChannels = maxNumChannels;
     states.resize(allocatedChannels * allocatedSections * StatesPerSection);
-    std::fill(states.begin(), states.end(), 0.f);
+    clear();
 }
 
 void Biquad::reallocateSections(unsigned int numSections)
@@ -39,7 +39,7 @@ void Biquad::reallocateSections(unsigned int numSections)
     coeffs.resize(allocatedSections * CoeffsPerSection);
     states.resize(allocatedChannels * allocatedSections * StatesPerSection);
     std::fill(coeffs.begin(), coeffs.end(), 0.f);
-    std::fill(states.begin(), states.end(), 0.f);
+    clear();
 }
 
 void Biquad::setSectionCoeffs(const std::array<float, CoeffsPerSection>& newSectionCoeffs, unsigned int section)
@@ -48,36 +48,82 @@ void Biquad::setSectionCoeffs(const std::array<float, CoeffsPerSection>& newSect
         std::copy(newSectionCoeffs.begin(), newSectionCoeffs.end(), coeffs.begin() + (section * CoeffsPerSection));
 }
 
-void Biquad::process(float* const* output, const float* const* input, unsigned int numChannels, unsigned int numSamples)
+std::array<float, Biquad::CoeffsPerSection> Biquad::getSectionCoeffs(unsigned int section) const
 {
-    numChannels = std::min(numChannels, allocatedChannels);
-    for (unsigned int c = 0; c < numChannels; ++c)
+    std::array<float, CoeffsPerSection> sectionCoeffs {};
+    if (section < allocatedSections)
+        std::copy(coeffs.begin() + (section * CoeffsPerSection), coeffs.begin() + ((section + 1) * CoeffsPerSection), sectionCoeffs.begin());
+    return sectionCoeffs;
+}
+
+template <unsigned int N>
+void Biquad::processChannels(float* const* output, const float* const* input, unsigned int firstChannel, unsigned int numSamples)
+{
+    for (unsigned int start = 0; start < numSamples; start += ChunkSamples)
     {
-        for (unsigned int n = 0; n < numSamples; ++n)
+        const unsigned int chunk { std::min(numSamples - start, ChunkSamples) };
+
+        // Interleave the channels, frame n holds sample n of every channel
+        float frames[ChunkSamples * N];
+        for (unsigned int c = 0; c < N; ++c)
+            for (unsigned int n = 0; n < chunk; ++n)
+                frames[n * N + c] = input[c][start + n];
+
+        for (unsigned int s = 0; s < allocatedSections; ++s)
         {
-            float x { input[c][n] };
-            for (unsigned int s = 0; s < allocatedSections; ++s)
+            const float* const k { coeffs.data() + s * CoeffsPerSection };
+            const float b0 { k[0] };
+            const float b1 { k[1] };
+            const float b2 { k[2] };
+            const float a1 { k[3] };
+            const float a2 { k[4] };
+
+            float z1[N];
+            float z2[N];
+            for (unsigned int c = 0; c < N; ++c)
             {
-                const unsigned int stateOffset { c * allocatedSections * StatesPerSection + s * StatesPerSection };
-                const unsigned int coeffOffset { s * CoeffsPerSection };
-
-                float acc { x * coeffs[coeffOffset + 0] }; // b0
-                acc += coeffs[coeffOffset + 1] * states[stateOffset + 0]; // b1
-                acc += coeffs[coeffOffset + 2] * states[stateOffset + 1]; // b2
-                acc -= coeffs[coeffOffset + 3] * states[stateOffset + 2]; // a1
-                acc -= coeffs[coeffOffset + 4] * states[stateOffset + 3]; // a2
-
-                states[stateOffset + 1] = states[stateOffset + 0];
-                states[stateOffset + 0] = x;
-                states[stateOffset + 3] = states[stateOffset + 2];
-                states[stateOffset + 2] = acc;
-                x = acc;
+                const unsigned int stateOffset { ((firstChannel + c) * allocatedSections + s) * StatesPerSection };
+                z1[c] = states[stateOffset + 0];
+                z2[c] = states[stateOffset + 1];
+            }
+
+            for (unsigned int n = 0; n < chunk; ++n)
+            {
+                float* const x { frames + n * N };
+                for (unsigned int c = 0; c < N; ++c)
+                {
+                    const float y { b0 * x[c] + z1[c] };
+                    z1[c] = b1 * x[c] - a1 * y + z2[c];
+                    z2[c] = b2 * x[c] - a2 * y;
+                    x[c] = y;
+                }
+            }
+
+            for (unsigned int c = 0; c < N; ++c)
+            {
+                const unsigned int stateOffset { ((firstChannel + c) * allocatedSections + s) * StatesPerSection };
+                states[stateOffset + 0] = z1[c];
+                states[stateOffset + 1] = z2[c];
             }
-            output[c][n] = x;
         }
+
+        for (unsigned int c = 0; c < N; ++c)
+            for (unsigned int n = 0; n < chunk; ++n)
+                output[c][start + n] = frames[n * N + c];
     }
 }
 
+void Biquad::process(float* const* output, const float* const* input, unsigned int numChannels, unsigned int numSamples)
+{
+    numChannels = std::min(numChannels, allocatedChannels);
+
+    unsigned int c { 0 };
+    for (; c + 2 <= numChannels; c += 2)
+        processChannels<2>(output + c, input + c, c, numSamples);
+    if (c < numChannels)
+        processChannels<1>(output + c, input + c, c, numSamples);
+}
+
 void Biquad::process(float* output, const float* input, unsigned int numChannels)
 {
     numChannels = std::min(numChannels, allocatedChannels);
@@ -86,20 +132,13 @@ void Biquad::process(float* output, const float* input, unsigned int numChannels
         float x { input[c] };
         for (unsigned int s = 0; s < allocatedSections; ++s)
         {
-            const unsigned int stateOffset { c * allocatedSections * StatesPerSection + s * StatesPerSection };
+            const unsigned int stateOffset { (c * allocatedSections + s) * StatesPerSection };
             const unsigned int coeffOffset { s * CoeffsPerSection };
 
-            float acc { x * coeffs[coeffOffset + 0] }; // b0
-            acc += coeffs[coeffOffset + 1] * states[stateOffset + 0]; // b1
-            acc += coeffs[coeffOffset + 2] * states[stateOffset + 1]; // b2
-            acc -= coeffs[coeffOffset + 3] * states[stateOffset + 2]; // a1
-            acc -= coeffs[coeffOffset + 4] * states[stateOffset + 3]; // a2
-
-            states[stateOffset + 1] = states[stateOffset + 0];
-            states[stateOffset + 0] = x;
-            states[stateOffset + 3] = states[stateOffset + 2];
-            states[stateOffset + 2] = acc;
-            x = acc;
+            const float y { coeffs[coeffOffset + 0] * x + states[stateOffset + 0] }; // b0
+            states[stateOffset + 0] = coeffs[coeffOffset + 1] * x - coeffs[coeffOffset + 3] * y + states[stateOffset + 1]; // b1, a1
+            states[stateOffset + 1] = coeffs[coeffOffset + 2] * x - coeffs[coeffOffset + 4] * y; // b2, a2
+            x = y;
         }
         output[c] = x;
     }
@@ -0,0 +1,324 @@
+#include "ConvolutionReverb.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace DSP
+{
+
+namespace
+{
+
+unsigned int getOrder(unsigned int size)
+{
+    unsigned int order { 0 };
+    while ((1u << order) < size)
+        ++order;
+    return order;
+}
+
+}
+
+ConvolutionReverb::Segment::Segment(unsigned int order, unsigned int initNumChannels) :
+    fft(order + 1),
+    blockSamples { 1u << order },
+    numBins { fft.getNumBins() },
+    numChannels { initNumChannels }
+{
+    window.resize(numChannels * 2 * blockSamples, 0.f);
+    output.resize(numChannels * blockSamples, 0.f);
+    sumRe.resize(numBins, 0.f);
+    sumIm.resize(numBins, 0.f);
+    scratch.resize(2 * blockSamples, 0.f);
+}
+
+void ConvolutionReverb::Segment::setImpulseResponse(const float* const* ir, unsigned int numIrChannels, unsigned int numIrSamples,
+                                                    unsigned int irOffset, unsigned int maxPartitions)
+{
+    numPartitions = numIrSamples > irOffset ? (numIrSamples - irOffset + blockSamples - 1) / blockSamples : 0;
+    numPartitions = std::min(numPartitions, maxPartitions);
+
+    irRe.assign(numChannels * numPartitions * numBins, 0.f);
+    irIm.assign(numChannels * numPartitions * numBins, 0.f);
+    inputRe.assign(numChannels * numPartitions * numBins, 0.f);
+    inputIm.assign(numChannels * numPartitions * numBins, 0.f);
+    inputIndex = 0;
+
+    // The inverse transform is not normalized, fold its scaling into the partitions
+    const float scale { 1.f / static_cast<float>(fft.getSize()) };
+
+    for (unsigned int ch = 0; ch < numChannels; ++ch)
+    {
+        const float* channelIr { ir[std::min(ch, numIrChannels - 1)] };
+
+        for (unsigned int p = 0; p < numPartitions; ++p)
+        {
+            // Partition in the first half, zero padded to the transform size
+            std::fill(scratch.begin(), scratch.end(), 0.f);
+            const unsigned int start { irOffset + p * blockSamples };
+            const unsigned int count { std::min(blockSamples, numIrSamples - start) };
+            for (unsigned int i = 0; i < count; ++i)
+                scratch[i] = channelIr[start + i] * scale;
+
+            const unsigned int offset { (ch * numPartitions + p) * numBins };
+            fft.forward(scratch.data(), irRe.data() + offset, irIm.data() + offset);
+        }
+    }
+
+    clear();
+}
+
+void ConvolutionReverb::Segment::clear()
+{
+    clearInput();
+    std::fill(window.begin(), window.end(), 0.f);
+    std::fill(output.begin(), output.end(), 0.f);
+}
+
+void ConvolutionReverb::Segment::clearInput()
+{
+    std::fill(inputRe.begin(), inputRe.end(), 0.f);
+    std::fill(inputIm.begin(), inputIm.end(), 0.f);
+    inputIndex = 0;
+}
+
+void ConvolutionReverb::Segment::compute(const float* inputWindow, float* blockOutput)
+{
+    if (numPartitions == 0)
+        return;
+
+    for (unsigned int ch = 0; ch < numChannels; ++ch)
+    {
+        const unsigned int channelOffset { ch * numPartitions * numBins };
+        float* const xRe { inputRe.data() + channelOffset };
+        float* const xIm { inputIm.data() + channelOffset };
+        const float* const hRe { irRe.data() + channelOffset };
+        const float* const hIm { irIm.data() + channelOffset };
+
+        fft.forward(inputWindow + ch * 2 * blockSamples, xRe + inputIndex * numBins, xIm + inputIndex * numBins);
+
+        // Partition p applies to the input window pushed p blocks ago
+        std::fill(sumRe.begin(), sumRe.end(), 0.f);
+        std::fill(sumIm.begin(), sumIm.end(), 0.f);
+        unsigned int slot { inputIndex };
+        for (unsigned int p = 0; p < numPartitions; ++p)
+        {
+            const float* const pRe { hRe + p * numBins };
+            const float* const pIm { hIm + p * numBins };
+            const float* const sRe { xRe + slot * numBins };
+            const float* const sIm { xIm + slot * numBins };
+            for (unsigned int b = 0; b < numBins; ++b)
+            {
+                sumRe[b] += pRe[b] * sRe[b] - pIm[b] * sIm[b];
+                sumIm[b] += pRe[b] * sIm[b] + pIm[b] * sRe[b];
+            }
+            slot = slot > 0 ? slot - 1 : numPartitions - 1;
+        }
+
+        // Overlap-save, the second half of the circular convolution is the linear one
+        fft.inverse(sumRe.data(), sumIm.data(), scratch.data());
+        std::memcpy(blockOutput + ch * blockSamples, scratch.data() + blockSamples, blockSamples * sizeof(float));
+    }
+
+    inputIndex = (inputIndex + 1) % numPartitions;
+}
+
+ConvolutionReverb::ConvolutionReverb(unsigned int initNumChannels) :
+    maxNumChannels { std::max(initNumChannels, 1u) },
+    early(getOrder(EarlyBlockSamples), maxNumChannels),
+    middle(getOrder(MiddleBlockSamples), maxNumChannels),
+    late(getOrder(LateBlockSamples), maxNumChannels)
+{
+    head.resize(maxNumChannels * EarlyBlockSamples, 0.f);
+    lateWindow.resize(maxNumChannels * 2 * LateBlockSamples, 0.f);
+    lateOutput.resize(maxNumChannels * LateBlockSamples, 0.f);
+}
+
+ConvolutionReverb::~ConvolutionReverb()
+{
+    worker.stop();
+}
+
+void ConvolutionReverb::prepare(double newSampleRate)
+{
+    sampleRate = std::max(newSampleRate, 1.0);
+    clear();
+}
+
+void ConvolutionReverb::clear()
+{
+    worker.wait();
+
+    early.clear();
+    middle.clear();
+    late.clear();
+    std::fill(lateWindow.begin(), lateWindow.end(), 0.f);
+    std::fill(lateOutput.begin(), lateOutput.end(), 0.f);
+    position = 0;
+    lateResetPending = false;
+    lateJobClearsInput = false;
+}
+
+void ConvolutionReverb::reset()
+{
+    early.clear();
+    middle.clear();
+
+    // A running job owns the late input spectra, lateWindow and lateOutput,
+    // only the window and output used by the audio thread are cleared here
+    std::fill(late.window.begin(), late.window.end(), 0.f);
+    std::fill(late.output.begin(), late.output.end(), 0.f);
+    position = 0;
+    lateResetPending = true;
+}
+
+void ConvolutionReverb::setImpulseResponse(const float* const* ir, unsigned int numIrChannels, unsigned int numIrSamples)
+{
+    worker.wait();
+
+    irSamples = (ir != nullptr && numIrChannels > 0) ? numIrSamples : 0;
+    numIrChannels = std::max(numIrChannels, 1u);
+
+    std::fill(head.begin(), head.end(), 0.f);
+    for (unsigned int ch = 0; ch < maxNumChannels && irSamples > 0; ++ch)
+    {
+        const float* channelIr { ir[std::min(ch, numIrChannels - 1)] };
+        const unsigned int count { std::min(EarlyBlockSamples, irSamples) };
+        for (unsigned int i = 0; i < count; ++i)
+            head[ch * EarlyBlockSamples + EarlyBlockSamples - 1 - i] = channelIr[i];
+    }
+
+    // Each segment ends where the next one starts, the late one runs to the end
+    early.setImpulseResponse(ir, numIrChannels, irSamples, EarlyBlockSamples, (MiddleBlockSamples - EarlyBlockSamples) / EarlyBlockSamples);
+    middle.setImpulseResponse(ir, numIrChannels, irSamples, MiddleBlockSamples, (2 * LateBlockSamples - MiddleBlockSamples) / MiddleBlockSamples);
+    late.setImpulseResponse(ir, numIrChannels, irSamples, 2 * LateBlockSamples, ~0u);
+
+    if (late.numPartitions > 0)
+        worker.start();
+    else
+        worker.stop();
+
+    clear();
+}
+
+void ConvolutionReverb::process(float* const* output, const float* const* input, unsigned int numChannels, unsigned int numSamples)
+{
+    const unsigned int channels { std::min(numChannels, maxNumChannels) };
+
+    if (irSamples == 0)
+    {
+        for (unsigned int ch = 0; ch < channels; ++ch)
+            std::fill(output[ch], output[ch] + numSamples, 0.f);
+        return;
+    }
+
+    float sum[EarlyBlockSamples];
+
+    for (unsigned int pos = 0; pos < numSamples;)
+    {
+        // Chunks never cross an early block boundary
+        const unsigned int earlyPos { position % EarlyBlockSamples };
+        const unsigned int middlePos { position % MiddleBlockSamples };
+        const unsigned int n { std::min(numSamples - pos, EarlyBlockSamples - earlyPos) };
+
+        float mono[EarlyBlockSamples];
+        if (monoInput)
+        {
+            const float* const left { input[0] + pos };
+            const float* const right { input[channels > 1 ? 1 : 0] + pos };
+            for (unsigned int i = 0; i < n; ++i)
+                mono[i] = 0.5f * (left[i] + right[i]);
+        }
+
+        for (unsigned int ch = 0; ch < channels; ++ch)
+        {
+            const float* const in { monoInput ? mono : input[ch] + pos };
+            float* const out { output[ch] + pos };
+
+            float* const earlyWindow { early.window.data() + ch * 2 * EarlyBlockSamples };
+            std::memcpy(earlyWindow + EarlyBlockSamples + earlyPos, in, n * sizeof(float));
+            std::memcpy(middle.window.data() + ch * 2 * MiddleBlockSamples + MiddleBlockSamples + middlePos, in, n * sizeof(float));
+            std::memcpy(late.window.data() + ch * 2 * LateBlockSamples + LateBlockSamples + position, in, n * sizeof(float));
+
+            // Head FIR, the early window holds the previous block as history
+            const float* const taps { head.data() + ch * EarlyBlockSamples };
+            const float* const history { earlyWindow + earlyPos + 1 };
+            std::fill(sum, sum + n, 0.f);
+            for (unsigned int k = 0; k < EarlyBlockSamples; ++k)
+                for (unsigned int i = 0; i < n; ++i)
+                    sum[i] += taps[k] * history[k + i];
+
+            const float* const earlyOut { early.output.data() + ch * EarlyBlockSamples + earlyPos };
+            const float* const middleOut { middle.output.data() + ch * MiddleBlockSamples + middlePos };
+            const float* const lateOut { late.output.data() + ch * LateBlockSamples + position };
+            for (unsigned int i = 0; i < n; ++i)
+                out[i] = sum[i] + earlyOut[i] + middleOut[i] + lateOut[i];
+        }
+
+        pos += n;
+        position += n;
+
+        if (position % EarlyBlockSamples == 0)
+        {
+            early.compute(early.window.data(), early.output.data());
+            for (unsigned int ch = 0; ch < maxNumChannels; ++ch)
+            {
+                float* const w { early.window.data() + ch * 2 * EarlyBlockSamples };
+                std::memcpy(w, w + EarlyBlockSamples, EarlyBlockSamples * sizeof(float));
+            }
+        }
+
+        if (position % MiddleBlockSamples == 0)
+        {
+            middle.compute(middle.window.data(), middle.output.data());
+            for (unsigned int ch = 0; ch < maxNumChannels; ++ch)
+            {
+                float* const w { middle.window.data() + ch * 2 * MiddleBlockSamples };
+                std::memcpy(w, w + MiddleBlockSamples, MiddleBlockSamples * sizeof(float));
+            }
+        }
+
+        if (position == LateBlockSamples)
+        {
+            position = 0;
+
+            if (late.numPartitions > 0)
+            {
+                // The job launched one block ago computed this block
+                worker.wait();
+                late.output.swap(lateOutput);
+                lateJobClearsInput = lateResetPending;
+                if (lateResetPending)
+                {
+                    std::fill(late.output.begin(), late.output.end(), 0.f);
+                    lateResetPending = false;
+                }
+
+                std::copy(late.window.begin(), late.window.end(), lateWindow.begin());
+                for (unsigned int ch = 0; ch < maxNumChannels; ++ch)
+                {
+                    float* const w { late.window.data() + ch * 2 * LateBlockSamples };
+                    std::memcpy(w, w + LateBlockSamples, LateBlockSamples * sizeof(float));
+                }
+
+                if (!worker.launch(&ConvolutionReverb::processLate, this))
+                    processLate(this);
+            }
+        }
+    }
+}
+
+void ConvolutionReverb::processLate(void* context)
+{
+    ConvolutionReverb& self { *static_cast<ConvolutionReverb*>(context) };
+    if (self.lateJobClearsInput)
+        self.late.clearInput();
+    self.late.compute(self.lateWindow.data(), self.lateOutput.data());
+}
+
+double ConvolutionReverb::getTailLengthSeconds() const
+{
+    return static_cast<double>(irSamples) / sampleRate;
+}
+
+}
\ No newline at end of file
@@ -0,0 +1,145 @@
+#pragma once
+
+#include "FFT.h"
+#include "WorkerThread.h"
+
+#include <vector>
+
+namespace DSP
+{
+
+// Convolution reverb for sampled impulse responses, with zero latency.
+// The impulse response is split into segments of growing partition sizes:
+//  - the head, the first EarlyBlockSamples taps, is a direct form FIR,
+//  - the early and middle segments are uniformly partitioned FFT convolutions
+//    run on the audio thread, each one starting one partition into the response,
+//  - the late segment, up to the end of the response, uses long partitions and runs
+//    on a worker thread, it starts two partitions into the response so each job
+//    has a whole partition of time to finish before its output is needed.
+// Only the boundaries of the early partitions cost more than a direct FIR,
+// the longer segments only work once every MiddleBlockSamples / LateBlockSamples.
+class ConvolutionReverb
+{
+public:
+    ConvolutionReverb(unsigned int initNumChannels);
+    ~ConvolutionReverb();
+
+    // No default ctor
+    ConvolutionReverb() = delete;
+
+    // No copy semantics
+    ConvolutionReverb(const ConvolutionReverb&) = delete;
+    const ConvolutionReverb& operator=(const ConvolutionReverb&) = delete;
+
+    // No move semantics
+    ConvolutionReverb(ConvolutionReverb&&) = delete;
+    const ConvolutionReverb& operator=(ConvolutionReverb&&) = delete;
+
+    // Update sample rate and clear the state, the response is kept as is
+    void prepare(double newSampleRate);
+
+    // Clear the state, waits for a running worker job
+    void clear();
+
+    // Clear the state without waiting for the worker, for the audio thread.
+    // The late input history is cleared by the next worker job instead
+    void reset();
+
+    // Load an impulse response, one buffer per channel, channels beyond numIrChannels
+    // use the last one. The response is used sample for sample, at the processing rate.
+    // Allocates the partitions and spawns / joins the worker, must not be called
+    // from the audio thread nor while processing
+    void setImpulseResponse(const float* const* ir, unsigned int numIrChannels, unsigned int numIrSamples);
+
+    // Sum the input channels to mono before the convolution, as the algorithmic reverbs do,
+    // for responses captured from them with the same impulse on every channel. Off by default
+    void setMonoInput(bool enabled) { monoInput = enabled; }
+
+    // True once a non empty impulse response is loaded
+    bool hasImpulseResponse() const { return irSamples > 0; }
+
+    // Process block of audio, can be in place, silent without an impulse response
+    void process(float* const* output, const float* const* input, unsigned int numChannels, unsigned int numSamples);
+
+    // Length of the impulse response
+    double getTailLengthSeconds() const;
+
+    // Partition sizes of the segments, each one divides the next
+    static constexpr unsigned int EarlyBlockSamples { 64 };
+    static constexpr unsigned int MiddleBlockSamples { 1024 };
+    static constexpr unsigned int LateBlockSamples { 8192 };
+
+private:
+    // Uniformly partitioned convolution of one segment of the response
+    struct Segment
+    {
+        Segment(unsigned int order, unsigned int initNumChannels);
+
+        // Partition the response starting at irOffset and size the spectra
+        void setImpulseResponse(const float* const* ir, unsigned int numIrChannels, unsigned int numIrSamples,
+                                unsigned int irOffset, unsigned int maxPartitions);
+
+        void clear();
+        // Clear the input spectra only
+        void clearInput();
+
+        // Push the spectrum of the input window of every channel and write the next
+        // blockSamples of output, overlap-save over all partitions
+        void compute(const float* inputWindow, float* blockOutput);
+
+        DSP::FFT fft;
+        const unsigned int blockSamples;
+        const unsigned int numBins;
+        const unsigned int numChannels;
+        unsigned int numPartitions { 0 };
+
+        // Partition spectra, partition p of channel ch at (ch * numPartitions + p) * numBins
+        std::vector<float> irRe;
+        std::vector<float> irIm;
+        // Input spectra of the last numPartitions windows, same layout, used as a ring
+        std::vector<float> inputRe;
+        std::vector<float> inputIm;
+        unsigned int inputIndex { 0 };
+
+        // Previous and current input block of every channel, 2 * blockSamples each
+        std::vector<float> window;
+        // Output of the current block of every channel, blockSamples each
+        std::vector<float> output;
+
+        // Scratch spectrum and time signal
+        std::vector<float> sumRe;
+        std::vector<float> sumIm;
+        std::vector<float> scratch;
+    };
+
+    // Worker job computing the next late block
+    static void processLate(void* context);
+
+    const unsigned int maxNumChannels;
+    double sampleRate { 48000.0 };
+    unsigned int irSamples { 0 };
+    bool monoInput { false };
+
+    // Head taps of every channel, in reversed order
+    std::vector<float> head;
+
+    Segment early;
+    Segment middle;
+    Segment late;
+
+    // Input window handed to the worker and the late block it is computing
+    std::vector<float> lateWindow;
+    std::vector<float> lateOutput;
+
+    // Position in the current late block
+    unsigned int position { 0 };
+
+    // Set by reset(), the next late boundary drops the block computed from the old input
+    bool lateResetPending { false };
+    // Set before each launch, the job clears the late input spectra before computing
+    bool lateJobClearsInput { false };
+
+    DSP::WorkerThread worker;
+};
+
+}
\ No newline at end of file
@@ -1,5 +1,9 @@
 #include "DattorroReverb.h"
 
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
 namespace DSP
 {
 
@@ -10,7 +14,7 @@ DattorroReverb::DattorroReverb(
     float initDampingCoeff
 ) :
     sampleRate { initSampleRate },
-    preDelay(static_cast<unsigned int>(preDelayMs * static_cast<float>(0.001 * sampleRate)), 1u),
+    preDelay(static_cast<unsigned int>(preDelayMs * static_cast<float>(0.001 * DSP::DelayLine::MaxSampleRate)), 1u),
     toneControl(toneControlCoeff),
     inputDiffuser_1(inputDiffDelayMs_1, inputDiffCoeff_1_2, 1u),
     inputDiffuser_2(inputDiffDelayMs_2, inputDiffCoeff_1_2, 1u),
@@ -19,18 +23,19 @@ DattorroReverb::DattorroReverb(
     lfo(lfoType, lfoFreqHz, lfoDepthMs, 0.f),
     decayDiffuser_left_1(decayDiffDelayMs_left_1 + lfoDepthMs, decayDiffCoeff_1, 1u),
     decayDiffuser_right_1(decayDiffDelayMs_right_1 + lfoDepthMs, decayDiffCoeff_1, 1u),
-    delay_left_1(static_cast<unsigned int>(delayMs_left_1 * static_cast<float>(0.001 * sampleRate)), 1u),
-    delay_right_1(static_cast<unsigned int>(delayMs_right_1 * static_cast<float>(0.001 * sampleRate)), 1u),
+    delay_left_1(static_cast<unsigned int>(delayMs_left_1 * static_cast<float>(0.001 * DSP::DelayLine::MaxSampleRate)), 1u),
+    delay_right_1(static_cast<unsigned int>(delayMs_right_1 * static_cast<float>(0.001 * DSP::DelayLine::MaxSampleRate)), 1u),
     dampingFilter(initDampingFilterCoeff),
     decayCoeff { initDampingCoeff },
     decayDiffuser_left_2(decayDiffDelayMs_left_2, decayDiffCoeff_2, 1u),
     decayDiffuser_right_2(decayDiffDelayMs_right_2, decayDiffCoeff_2, 1u),
-    delay_left_2(static_cast<unsigned int>(delayMs_left_2 * static_cast<float>(0.001 * sampleRate)), 1u),
-    delay_right_2(static_cast<unsigned int>(delayMs_right_2 * static_cast<float>(0.001 * sampleRate)), 1u)
+    delay_left_2(static_cast<unsigned int>(delayMs_left_2 * static_cast<float>(0.001 * DSP::DelayLine::MaxSampleRate)), 1u),
+    delay_right_2(static_cast<unsigned int>(delayMs_right_2 * static_cast<float>(0.001 * DSP::DelayLine::MaxSampleRate)), 1u)
 {
     decayDiffuser_left_1.setDelayTime(decayDiffDelayMs_left_1);
     decayDiffuser_right_1.setDelayTime(decayDiffDelayMs_right_1);
     decayCoeffRamp.prepare(sampleRate, true, decayCoeff);
+    updateTapIndices();
 }
 
 DattorroReverb::~DattorroReverb()
@@ -72,6 +77,8 @@ void DattorroReverb::prepare(double newSampleRate, unsigned int newNumChannels)
     // Prepare feedback state
     feedbackState[0] = 0.f;
     feedbackState[1] = 0.f;
+    // Prepare output taps
+    updateTapIndices();
 
     clear();
 }
@@ -107,104 +114,158 @@ void DattorroReverb::clear()
 }
 
 void DattorroReverb::process(float* const* output, const float* const* input, unsigned int numChannels, unsigned int numSamples)
-{   
-    // Sum the input channels to the first channel
-    for (unsigned int n = 0; n < numSamples; ++n)
-    {   
-        // Preallocate output channels
-        float out_left { 0.f };
-        float out_right { 0.f };
+{
+    for (unsigned int start = 0; start < numSamples; start += MaxBlockSamples)
+    {
+        const unsigned int blockSamples { std::min(numSamples - start, MaxBlockSamples) };
 
         // --------- FEEDFORWARD ---------
+        processFeedforward(monoBuffer.data(), input, numChannels, start, blockSamples);
 
-        // Join stereo channels to mono
-        float left { input[0][n] };
-        float right { (numChannels > 1) ? input[1][n] : input[0][n] };
-        float mono { 0.5f * (left + right) };
+        // ---------- RECURSION ----------
+        for (unsigned int i = 0; i < blockSamples; ++i)
+        {
+            const unsigned int n { start + i };
+
+            // Preallocate output channels
+            float out_left { 0.f };
+            float out_right { 0.f };
+
+            // Divide in stereo channels
+            float left { monoBuffer[i] + feedbackState[0] };
+            float right { monoBuffer[i] + feedbackState[1] };
+
+            // LFO for allpass delay line modulation
+            float* lfoValue = lfo.process();
+
+            // Decay Diffusion 1 processing
+            decayDiffuser_left_1.processSample<1>(&left, &left, &lfoValue[0]);
+            decayDiffuser_right_1.processSample<1>(&right, &right, &lfoValue[1]);
+
+            // Delay line 1 processing
+            delay_left_1.processSample<1>(&left, &left);
+            delay_right_1.processSample<1>(&right, &right);
+
+            // Damping processing 1
+            dampingFilter.processSample<1>(&left, &left);
+            dampingFilter.processSample<1>(&right, &right);
+
+            // Decay processing 1
+            decayCoeffRamp.applyGain(&left, 1u);
+            decayCoeffRamp.applyGain(&right, 1u);
+
+            // Decay Diffusion 2 processing
+            decayDiffuser_left_2.processSample<1>(&left, &left);
+            decayDiffuser_right_2.processSample<1>(&right, &right);
+
+            // Delay line 2 processing
+            delay_left_2.processSample<1>(&left, &left);
+            delay_right_2.processSample<1>(&right, &right);
+
+            // Decay processing 2
+            decayCoeffRamp.applyGain(&left, 1u);
+            decayCoeffRamp.applyGain(&right, 1u);
+
+            // Output taps, every line is read once after its last write of this sample
+            float taps_left_1[DelayLine::MaxTaps];
+            float taps_right_1[DelayLine::MaxTaps];
+            float diffuserTaps_left_2[DelayLine::MaxTaps];
+            float diffuserTaps_right_2[DelayLine::MaxTaps];
+            float taps_left_2[DelayLine::MaxTaps];
+            float taps_right_2[DelayLine::MaxTaps];
+            delay_left_1.readTaps(0, taps_left_1);
+            delay_right_1.readTaps(0, taps_right_1);
+            decayDiffuser_left_2.readTaps(0, diffuserTaps_left_2);
+            decayDiffuser_right_2.readTaps(0, diffuserTaps_right_2);
+            delay_left_2.readTaps(0, taps_left_2);
+            delay_right_2.readTaps(0, taps_right_2);
+
+            // Sum the taps in the order of the original topology
+            out_left += 0.6 * taps_right_1[0];
+            out_left += 0.6 * taps_right_1[1];
+            out_left -= 0.6 * diffuserTaps_right_2[0];
+            out_left += 0.6 * taps_right_2[0];
+            out_left -= 0.6 * taps_left_1[2];
+            out_left -= 0.6 * diffuserTaps_left_2[1];
+            out_left -= 0.6 * taps_left_2[1];
+
+            out_right += 0.6 * taps_left_1[0];
+            out_right += 0.6 * taps_left_1[1];
+            out_right -= 0.6 * diffuserTaps_left_2[0];
+            out_right += 0.6 * taps_left_2[0];
+            out_right -= 0.6 * taps_right_1[2];
+            out_right -= 0.6 * diffuserTaps_right_2[1];
+            out_right -= 0.6 * taps_right_2[1];
+
+            // Update feedback state
+            feedbackState[0] = left;
+            feedbackState[1] = right;
+
+            // Output
+            output[0][n] = out_left;
+            if (numChannels > 1)
+                output[1][n] = out_right;
+        }
+    }
+}
 
-        // Predelay processing
-        preDelay.process(&mono, &mono, 1u);
+void DattorroReverb::processFeedforward(float* mono, const float* const* input, unsigned int numChannels, unsigned int startSample, unsigned int numSamples)
+{
+    // Join stereo channels to mono
+    const float* left { input[0] + startSample };
+    const float* right { (numChannels > 1) ? input[1] + startSample : left };
+    for (unsigned int n = 0; n < numSamples; ++n)
+        mono[n] = 0.5f * (left[n] + right[n]);
 
-        // Tone control processing
-        toneControl.process(&mono, &mono, 1u);
+    float* const monoPtrs[1] { mono };
 
-        // Input diffusion processing
-        inputDiffuser_1.process(&mono, &mono, 1u);
-        inputDiffuser_2.process(&mono, &mono, 1u);
-        inputDiffuser_3.process(&mono, &mono, 1u);
-        inputDiffuser_4.process(&mono, &mono, 1u);
+    // Predelay processing
+    preDelay.process(monoPtrs, monoPtrs, 1u, numSamples);
 
-        // ---------- RECURSION ----------
+    // Tone control processing
+    toneControl.process(monoPtrs, monoPtrs, 1u, numSamples);
 
-        // Divide in stereo channels
-        left = mono + feedbackState[0];
-        right = mono + feedbackState[1];
-
-        // LFO for allpass delay line modulation
-        float* lfoValue = lfo.process();
-
-        // Decay Diffusion 1 processing
-        decayDiffuser_left_1.process(&left, &left, 1u, &lfoValue[0]);
-        decayDiffuser_right_1.process(&right, &right, 1u, &lfoValue[1]);
-
-        // Delay line 1 processing
-        delay_left_1.process(&left, &left, 1u);
-        delay_right_1.process(&right, &right, 1u);
-
-        // First and second tap out
-        out_left += 0.6 * delay_right_1.getSample(0, static_cast<unsigned int>(tapOutMs_left_1 * static_cast<float>(0.001 * sampleRate)));
-        out_left += 0.6 * delay_right_1.getSample(0, static_cast<unsigned int>(tapOutMs_left_2 * static_cast<float>(0.001 * sampleRate)));
-        out_right += 0.6 * delay_left_1.getSample(0, static_cast<unsigned int>(tapOutMs_right_1 * static_cast<float>(0.001 * sampleRate)));
-        out_right += 0.6 * delay_left_1.getSample(0, static_cast<unsigned int>(tapOutMs_right_2 * static_cast<float>(0.001 * sampleRate)));
-
-        // Damping processing 1
-        dampingFilter.process(&left, &left, 1u);
-        dampingFilter.process(&right, &right, 1u);
-
-        // Decay processing 1
-        // left *= decayCoeff;
-        decayCoeffRamp.applyGain(&left, 1u);
-        // right *= decayCoeff;
-        decayCoeffRamp.applyGain(&right, 1u);
-
-        // Decay Diffusion 2 processing
-        decayDiffuser_left_2.process(&left, &left, 1u);
-        decayDiffuser_right_2.process(&right, &right, 1u);
-
-        // Third tap out
-        out_left -= 0.6 * decayDiffuser_right_2.getSample(0, static_cast<unsigned int>(tapOutMs_left_3 * static_cast<float>(0.001 * sampleRate)));
-        out_right -= 0.6 * decayDiffuser_left_2.getSample(0, static_cast<unsigned int>(tapOutMs_right_3 * static_cast<float>(0.001 * sampleRate)));
-
-        // Delay line 2 processing
-        delay_left_2.process(&left, &left, 1u);
-        delay_right_2.process(&right, &right, 1u);
-
-        // Forth tap out
-        out_left += 0.6 * delay_right_2.getSample(0, static_cast<unsigned int>(tapOutMs_left_4 * static_cast<float>(0.001 * sampleRate)));
-        out_right += 0.6 * delay_left_2.getSample(0, static_cast<unsigned int>(tapOutMs_right_4 * static_cast<float>(0.001 * sampleRate)));
-
-        // Decay processing 2
-        // left *= decayCoeff;
-        decayCoeffRamp.applyGain(&left, 1u);
-        // right *= decayCoeff;
-        decayCoeffRamp.applyGain(&right, 1u);
-
-        // Fifth, sixth, and seventh tap out
-        out_left -= 0.6 * delay_left_1.getSample(0, static_cast<unsigned int>(tapOutMs_left_5 * static_cast<float>(0.001 * sampleRate)));
-        out_left -= 0.6 * decayDiffuser_left_2.getSample(0, static_cast<unsigned int>(tapOutMs_left_6 * static_cast<float>(0.001 * sampleRate)));
-        out_left -= 0.6 * delay_left_2.getSample(0, static_cast<unsigned int>(tapOutMs_left_7 * static_cast<float>(0.001 * sampleRate)));
-        out_right -= 0.6 * delay_right_1.getSample(0, static_cast<unsigned int>(tapOutMs_right_5 * static_cast<float>(0.001 * sampleRate)));
-        out_right -= 0.6 * decayDiffuser_right_2.getSample(0, static_cast<unsigned int>(tapOutMs_right_6 * static_cast<float>(0.001 * sampleRate)));
-        out_right -= 0.6 * delay_right_2.getSample(0, static_cast<unsigned int>(tapOutMs_right_7 * static_cast<float>(0.001 * sampleRate)));
-
-        // Update feedback state
-        feedbackState[0] = left;
-        feedbackState[1] = right;
-
-        // Output
-        output[0][n] = out_left;
-        output[1][n] = out_right;
-    }
+    // Input diffusion processing
+    inputDiffuser_1.process(monoPtrs, monoPtrs, 1u, numSamples);
+    inputDiffuser_2.process(monoPtrs, monoPtrs, 1u, numSamples);
+    inputDiffuser_3.process(monoPtrs, monoPtrs, 1u, numSamples);
+    inputDiffuser_4.process(monoPtrs, monoPtrs, 1u, numSamples);
+}
+
+void DattorroReverb::updateTapIndices()
+{
+    const float samplesPerMs { static_cast<float>(0.001 * sampleRate) };
+
+    tapOut_left_1 = static_cast<unsigned int>(tapOutMs_left_1 * samplesPerMs);
+    tapOut_left_2 = static_cast<unsigned int>(tapOutMs_left_2 * samplesPerMs);
+    tapOut_left_3 = static_cast<unsigned int>(tapOutMs_left_3 * samplesPerMs);
+    tapOut_left_4 = static_cast<unsigned int>(tapOutMs_left_4 * samplesPerMs);
+    tapOut_left_5 = static_cast<unsigned int>(tapOutMs_left_5 * samplesPerMs);
+    tapOut_left_6 = static_cast<unsigned int>(tapOutMs_left_6 * samplesPerMs);
+    tapOut_left_7 = static_cast<unsigned int>(tapOutMs_left_7 * samplesPerMs);
+
+    tapOut_right_1 = static_cast<unsigned int>(tapOutMs_right_1 * samplesPerMs);
+    tapOut_right_2 = static_cast<unsigned int>(tapOutMs_right_2 * samplesPerMs);
+    tapOut_right_3 = static_cast<unsigned int>(tapOutMs_right_3 * samplesPerMs);
+    tapOut_right_4 = static_cast<unsigned int>(tapOutMs_right_4 * samplesPerMs);
+    tapOut_right_5 = static_cast<unsigned int>(tapOutMs_right_5 * samplesPerMs);
+    tapOut_right_6 = static_cast<unsigned int>(tapOutMs_right_6 * samplesPerMs);
+    tapOut_right_7 = static_cast<unsigned int>(tapOutMs_right_7 * samplesPerMs);
+
+    // Each line holds the taps of both outputs it feeds, own channel first
+    const unsigned int taps_left_1[3] { tapOut_right_1, tapOut_right_2, tapOut_left_5 };
+    const unsigned int taps_right_1[3] { tapOut_left_1, tapOut_left_2, tapOut_right_5 };
+    const unsigned int diffuserTaps_left_2[2] { tapOut_right_3, tapOut_left_6 };
+    const unsigned int diffuserTaps_right_2[2] { tapOut_left_3, tapOut_right_6 };
+    const unsigned int taps_left_2[2] { tapOut_right_4, tapOut_left_7 };
+    const unsigned int taps_right_2[2] { tapOut_left_4, tapOut_right_7 };
+
+    delay_left_1.setTaps(taps_left_1, 3u);
+    delay_right_1.setTaps(taps_right_1, 3u);
+    decayDiffuser_left_2.setTaps(diffuserTaps_left_2, 2u);
+    decayDiffuser_right_2.setTaps(diffuserTaps_right_2, 2u);
+    delay_left_2.setTaps(taps_left_2, 2u);
+    delay_right_2.setTaps(taps_right_2, 2u);
 }
 
 void DattorroReverb::setBrightness(float newCoeff)
@@ -218,4 +279,39 @@ void DattorroReverb::setDecay(float newCoeff)
     decayCoeffRamp.setTarget(decayCoeff);
 }
 
+void DattorroReverb::setDenormalSafe(bool enabled)
+{
+    // The tank feedback passes through the decay diffusers, which covers it too
+    toneControl.setDenormalSafe(enabled);
+    inputDiffuser_1.setDenormalSafe(enabled);
+    inputDiffuser_2.setDenormalSafe(enabled);
+    inputDiffuser_3.setDenormalSafe(enabled);
+    inputDiffuser_4.setDenormalSafe(enabled);
+    decayDiffuser_left_1.setDenormalSafe(enabled);
+    decayDiffuser_right_1.setDenormalSafe(enabled);
+    dampingFilter.setDenormalSafe(enabled);
+    decayDiffuser_left_2.setDenormalSafe(enabled);
+    decayDiffuser_right_2.setDenormalSafe(enabled);
+}
+
+double DattorroReverb::getTailLengthSeconds() const
+{
+    if (decayCoeff >= 1.f)
+        return std::numeric_limits<double>::infinity();
+
+    // Longest path from the input into the tank
+    const double feedforwardMs { preDelayMs + inputDiffDelayMs_1 + inputDiffDelayMs_2 + inputDiffDelayMs_3 + inputDiffDelayMs_4 };
+    // Each half of the tank feeds back into itself, one trip around the longer half
+    // applies the decay twice
+    const double loopMs { std::max(decayDiffDelayMs_left_1 + delayMs_left_1 + decayDiffDelayMs_left_2 + delayMs_left_2,
+                                   decayDiffDelayMs_right_1 + delayMs_right_1 + decayDiffDelayMs_right_2 + delayMs_right_2) };
+
+    // The damping filter only shortens the tail, leave it out
+    double numLoops { 1.0 };
+    if (decayCoeff > 0.f)
+        numLoops = std::max(-60.0 / (40.0 * std::log10(static_cast<double>(decayCoeff))), 1.0);
+
+    return 0.001 * (feedforwardMs + numLoops * loopMs);
+}
+
 }
\ No newline at end of file
@@ -35,6 +35,8 @@ public:
     void clear();
 
     // Prepare method
+    // The delay memory is allocated once at construction for rates up to
+    // DSP::DelayLine::MaxSampleRate, so switching rates only changes delay lengths
     void prepare(double newSampleRate, unsigned int newNumChannels);
 
     // Process block of audio without modulation
@@ -46,6 +48,13 @@ public:
     void setBrightness(float newCoeff);
     void setDecay(float newCoeff);
 
+    // Keep the allpass and filter recursions out of the denormal range, on by default
+    void setDenormalSafe(bool enabled);
+
+    // Time for the output to decay by 60dB after the input stops,
+    // infinite when the decay coefficient is 1
+    double getTailLengthSeconds() const;
+
     // ==================================================
     // Constants for the Dattorro Reverb algorithm
     // Number of channels
@@ -103,7 +112,16 @@ public:
     static constexpr float lfoDepthMs { 16.f / sampleRate_Original * 1000.f };  // LFO depth in milliseconds
     static constexpr float lfoOffsetMs { 0.f };             // LFO offset in milliseconds
 
+    // Maximum number of samples the feedforward section processes at once
+    static constexpr unsigned int MaxBlockSamples { 128 };
+
 private:
+    // Convert the output tap times to integer delays for the current sample rate
+    void updateTapIndices();
+
+    // Process the feedforward section (mono sum, predelay, tone control and input diffusers) as a block
+    void processFeedforward(float* mono, const float* const* input, unsigned int numChannels, unsigned int startSample, unsigned int numSamples);
+
     double sampleRate;
     // --------- FEEDFORWARD ---------
     // Predelay
@@ -137,6 +155,27 @@ private:
     DSP::DelayLine delay_right_2;
     // Feedback state
     float feedbackState[2] { 0.f, 0.f };
+
+    // Output tap delays in samples
+    // LEFT CHANNEL
+    unsigned int tapOut_left_1 { 0 };
+    unsigned int tapOut_left_2 { 0 };
+    unsigned int tapOut_left_3 { 0 };
+    unsigned int tapOut_left_4 { 0 };
+    unsigned int tapOut_left_5 { 0 };
+    unsigned int tapOut_left_6 { 0 };
+    unsigned int tapOut_left_7 { 0 };
+    // RIGHT CHANNEL
+    unsigned int tapOut_right_1 { 0 };
+    unsigned int tapOut_right_2 { 0 };
+    unsigned int tapOut_right_3 { 0 };
+    unsigned int tapOut_right_4 { 0 };
+    unsigned int tapOut_right_5 { 0 };
+    unsigned int tapOut_right_6 { 0 };
+    unsigned int tapOut_right_7 { 0 };
+
+    // Mono feedforward buffer, the recursion reads from it sample by sample
+    std::array<float, MaxBlockSamples> monoBuffer;
 };
 
 }
\ No newline at end of file
@@ -0,0 +1,414 @@
+#include "DattorroReverbBank.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace DSP
+{
+
+namespace
+{
+
+// Smallest power of two greater or equal than x
+unsigned int nextPowerOfTwo(unsigned int x)
+{
+    unsigned int p { 1u };
+    while (p < x)
+        p <<= 1;
+    return p;
+}
+
+// Frame of a line at the given distance from the write position
+template <unsigned int N, typename LineType>
+float* frameAt(LineType& line, unsigned int index)
+{
+    return line.buffer.data() + (index & line.mask) * N;
+}
+
+// Fixed delay, the line output replaces v
+template <unsigned int N, typename LineType>
+void delayStep(LineType& line, unsigned int writeIndex, float* v)
+{
+    const float* read { frameAt<N>(line, writeIndex - line.delay) };
+    float* write { frameAt<N>(line, writeIndex) };
+
+    for (unsigned int l = 0; l < N; ++l)
+    {
+        const float x { v[l] };
+        v[l] = read[l];
+        write[l] = x;
+    }
+}
+
+// Allpass, same arithmetic as DSP::AllPass, the output replaces v
+template <unsigned int N, typename AllPassType>
+void allPassStep(AllPassType& ap, unsigned int writeIndex, float antiDenormal, float* v)
+{
+    const float* read { frameAt<N>(ap.line, writeIndex - ap.line.delay) };
+    float* write { frameAt<N>(ap.line, writeIndex) };
+    const float coeff { ap.coeff };
+
+    for (unsigned int l = 0; l < N; ++l)
+    {
+        const float delayIn { -coeff * ap.state[l] + v[l] + antiDenormal };
+        v[l] = coeff * delayIn + ap.state[l];
+        ap.state[l] = read[l];
+        write[l] = delayIn;
+    }
+}
+
+// Allpass with a linearly interpolated modulated delay, shared by all lanes
+template <unsigned int N, typename AllPassType>
+void modulatedAllPassStep(AllPassType& ap, unsigned int writeIndex, float antiDenormal, float modInput, float* v)
+{
+    const float m { std::fmax(modInput, 0.f) };
+    const float mFloor { std::floor(m) };
+    const float mFrac0 { m - mFloor };
+    const float mFrac1 { 1.f - mFrac0 };
+
+    const unsigned int readIndex0 { writeIndex - ap.line.delay - static_cast<unsigned int>(mFloor) };
+    const float* read0 { frameAt<N>(ap.line, readIndex0) };
+    const float* read1 { frameAt<N>(ap.line, readIndex0 - 1u) };
+    float* write { frameAt<N>(ap.line, writeIndex) };
+    const float coeff { ap.coeff };
+
+    for (unsigned int l = 0; l < N; ++l)
+    {
+        const float delayIn { -coeff * ap.state[l] + v[l] + antiDenormal };
+        v[l] = coeff * delayIn + ap.state[l];
+        ap.state[l] = read0[l] * mFrac1 + read1[l] * mFrac0;
+        write[l] = delayIn;
+    }
+}
+
+// Accumulate an output tap, read after the line was written in this sample
+template <unsigned int N, typename LineType>
+void addTap(float* out, const LineType& line, unsigned int writeIndex, unsigned int tap, double gain)
+{
+    const float* read { line.buffer.data() + ((writeIndex + 1u - tap) & line.mask) * N };
+
+    for (unsigned int l = 0; l < N; ++l)
+        out[l] = static_cast<float>(out[l] + gain * read[l]);
+}
+
+}
+
+DattorroReverbBank::DattorroReverbBank(unsigned int initNumLanes, float initDampingFilterCoeff, float initDecayCoeff) :
+    numLanes { initNumLanes > 4u ? MaxLanes : 4u },
+    lfo(DattorroReverb::lfoType, DattorroReverb::lfoFreqHz, DattorroReverb::lfoDepthMs, 0.f)
+{
+    inputDiffuser_1.coeff = DattorroReverb::inputDiffCoeff_1_2;
+    inputDiffuser_2.coeff = DattorroReverb::inputDiffCoeff_1_2;
+    inputDiffuser_3.coeff = DattorroReverb::inputDiffCoeff_3_4;
+    inputDiffuser_4.coeff = DattorroReverb::inputDiffCoeff_3_4;
+    decayDiffuser_left_1.coeff = DattorroReverb::decayDiffCoeff_1;
+    decayDiffuser_right_1.coeff = DattorroReverb::decayDiffCoeff_1;
+    decayDiffuser_left_2.coeff = DattorroReverb::decayDiffCoeff_2;
+    decayDiffuser_right_2.coeff = DattorroReverb::decayDiffCoeff_2;
+
+    for (unsigned int l = 0; l < MaxLanes; ++l)
+    {
+        dampingCoeff[l] = std::clamp(initDampingFilterCoeff, 0.f, 1.f);
+        dampingCoeffRamp[l].setRampTime(0.01f);
+        dampingCoeffRamp[l].setTarget(dampingCoeff[l], true);
+
+        decayCoeff[l] = initDecayCoeff;
+        decayCoeffRamp[l].prepare(sampleRate, true, decayCoeff[l]);
+    }
+
+    laneBuffers.fill(nullptr);
+    laneNumChannels.fill(0u);
+
+    monoBlock.resize(MaxBlockSamples * MaxLanes, 0.f);
+    leftBlock.resize(MaxBlockSamples * MaxLanes, 0.f);
+    rightBlock.resize(MaxBlockSamples * MaxLanes, 0.f);
+
+    prepare(sampleRate);
+}
+
+DattorroReverbBank::~DattorroReverbBank()
+{
+}
+
+void DattorroReverbBank::prepareLine(Line& line, unsigned int delay, unsigned int extraSamples)
+{
+    line.delay = std::max(delay, 1u);
+    line.mask = nextPowerOfTwo(line.delay + extraSamples + 1u) - 1u;
+    line.buffer.assign(static_cast<size_t>(line.mask + 1u) * numLanes, 0.f);
+}
+
+void DattorroReverbBank::prepare(double newSampleRate)
+{
+    sampleRate = std::max(newSampleRate, 1.0);
+
+    // Same rounding of the delay times as the single instance reverb
+    const float samplesPerMs { static_cast<float>(0.001 * sampleRate) };
+    auto allPassDelay = [samplesPerMs](float ms) { return static_cast<unsigned int>(std::round(ms * samplesPerMs)); };
+    auto lineDelay = [samplesPerMs](float ms) { return static_cast<unsigned int>(ms * samplesPerMs); };
+
+    // The LFO reads up to its depth beyond the nominal decay diffuser delay
+    const unsigned int modSamples { static_cast<unsigned int>(std::ceil(DattorroReverb::lfoDepthMs * 0.001 * std::max(sampleRate, 48000.0))) + 2u };
+
+    prepareLine(preDelay, lineDelay(DattorroReverb::preDelayMs), 0u);
+    prepareLine(inputDiffuser_1.line, allPassDelay(DattorroReverb::inputDiffDelayMs_1), 0u);
+    prepareLine(inputDiffuser_2.line, allPassDelay(DattorroReverb::inputDiffDelayMs_2), 0u);
+    prepareLine(inputDiffuser_3.line, allPassDelay(DattorroReverb::inputDiffDelayMs_3), 0u);
+    prepareLine(inputDiffuser_4.line, allPassDelay(DattorroReverb::inputDiffDelayMs_4), 0u);
+    prepareLine(decayDiffuser_left_1.line, allPassDelay(DattorroReverb::decayDiffDelayMs_left_1 + DattorroReverb::lfoDepthMs), modSamples);
+    prepareLine(decayDiffuser_right_1.line, allPassDelay(DattorroReverb::decayDiffDelayMs_right_1 + DattorroReverb::lfoDepthMs), modSamples);
+    prepareLine(delay_left_1, lineDelay(DattorroReverb::delayMs_left_1), 0u);
+    prepareLine(delay_right_1, lineDelay(DattorroReverb::delayMs_right_1), 0u);
+    prepareLine(decayDiffuser_left_2.line, allPassDelay(DattorroReverb::decayDiffDelayMs_left_2), 0u);
+    prepareLine(decayDiffuser_right_2.line, allPassDelay(DattorroReverb::decayDiffDelayMs_right_2), 0u);
+    prepareLine(delay_left_2, lineDelay(DattorroReverb::delayMs_left_2), 0u);
+    prepareLine(delay_right_2, lineDelay(DattorroReverb::delayMs_right_2), 0u);
+
+    const float tapsLeftMs[7] { DattorroReverb::tapOutMs_left_1, DattorroReverb::tapOutMs_left_2, DattorroReverb::tapOutMs_left_3,
+                                DattorroReverb::tapOutMs_left_4, DattorroReverb::tapOutMs_left_5, DattorroReverb::tapOutMs_left_6,
+                                DattorroReverb::tapOutMs_left_7 };
+    const float tapsRightMs[7] { DattorroReverb::tapOutMs_right_1, DattorroReverb::tapOutMs_right_2, DattorroReverb::tapOutMs_right_3,
+                                 DattorroReverb::tapOutMs_right_4, DattorroReverb::tapOutMs_right_5, DattorroReverb::tapOutMs_right_6,
+                                 DattorroReverb::tapOutMs_right_7 };
+    for (unsigned int t = 0; t < 7; ++t)
+    {
+        tapOut_left[t] = lineDelay(tapsLeftMs[t]);
+        tapOut_right[t] = lineDelay(tapsRightMs[t]);
+    }
+
+    lfo.prepare(sampleRate);
+
+    for (unsigned int l = 0; l < MaxLanes; ++l)
+    {
+        dampingCoeffRamp[l].prepare(sampleRate, true, dampingCoeff[l]);
+        decayCoeffRamp[l].prepare(sampleRate, true, decayCoeff[l]);
+    }
+
+    clear();
+}
+
+void DattorroReverbBank::clear()
+{
+    Line* lines[] { &preDelay, &inputDiffuser_1.line, &inputDiffuser_2.line, &inputDiffuser_3.line, &inputDiffuser_4.line,
+                    &decayDiffuser_left_1.line, &decayDiffuser_right_1.line, &delay_left_1, &delay_right_1,
+                    &decayDiffuser_left_2.line, &decayDiffuser_right_2.line, &delay_left_2, &delay_right_2 };
+    for (auto* line : lines)
+        std::fill(line->buffer.begin(), line->buffer.end(), 0.f);
+
+    AllPassLine* allPasses[] { &inputDiffuser_1, &inputDiffuser_2, &inputDiffuser_3, &inputDiffuser_4,
+                               &decayDiffuser_left_1, &decayDiffuser_right_1, &decayDiffuser_left_2, &decayDiffuser_right_2 };
+    for (auto* ap : allPasses)
+        ap->state.fill(0.f);
+
+    toneState.fill(0.f);
+    dampingState.fill(0.f);
+    feedbackState_left.fill(0.f);
+    feedbackState_right.fill(0.f);
+    writeIndex = 0;
+}
+
+void DattorroReverbBank::setLaneBuffers(unsigned int lane, float* const* buffers, unsigned int numChannels)
+{
+    if (lane >= numLanes)
+        return;
+
+    laneBuffers[lane] = buffers;
+    laneNumChannels[lane] = buffers != nullptr ? std::min(numChannels, DattorroReverb::MaxChannels) : 0u;
+}
+
+void DattorroReverbBank::process(unsigned int numSamples)
+{
+    if (numLanes == MaxLanes)
+        processLanes<MaxLanes>(numSamples);
+    else
+        processLanes<4>(numSamples);
+
+    laneBuffers.fill(nullptr);
+    laneNumChannels.fill(0u);
+}
+
+template <unsigned int N>
+void DattorroReverbBank::processLanes(unsigned int numSamples)
+{
+    const float toneCoeff { DattorroReverb::toneControlCoeff };
+    const double tapGain { 0.6 };
+
+    for (unsigned int start = 0; start < numSamples; start += MaxBlockSamples)
+    {
+        const unsigned int blockSamples { std::min(numSamples - start, MaxBlockSamples) };
+
+        // Gather lane inputs, joined to mono, into lane-interleaved frames
+        for (unsigned int l = 0; l < N; ++l)
+        {
+            if (laneNumChannels[l] == 0)
+            {
+                for (unsigned int i = 0; i < blockSamples; ++i)
+                    monoBlock[i * N + l] = 0.f;
+                continue;
+            }
+
+            const float* left { laneBuffers[l][0] + start };
+            const float* right { laneNumChannels[l] > 1 ? laneBuffers[l][1] + start : left };
+            for (unsigned int i = 0; i < blockSamples; ++i)
+                monoBlock[i * N + l] = 0.5f * (left[i] + right[i]);
+        }
+
+        for (unsigned int i = 0; i < blockSamples; ++i)
+        {
+            const unsigned int w { writeIndex };
+
+            // --------- FEEDFORWARD ---------
+            float mono[N];
+            std::copy(monoBlock.data() + i * N, monoBlock.data() + (i + 1) * N, mono);
+
+            delayStep<N>(preDelay, w, mono);
+
+            for (unsigned int l = 0; l < N; ++l)
+            {
+                mono[l] = toneCoeff * mono[l] + (1.f - toneCoeff) * toneState[l];
+                toneState[l] = mono[l] + antiDenormal;
+            }
+
+            allPassStep<N>(inputDiffuser_1, w, antiDenormal, mono);
+            allPassStep<N>(inputDiffuser_2, w, antiDenormal, mono);
+            allPassStep<N>(inputDiffuser_3, w, antiDenormal, mono);
+            allPassStep<N>(inputDiffuser_4, w, antiDenormal, mono);
+
+            // ---------- RECURSION ----------
+            float left[N];
+            float right[N];
+            float outLeft[N];
+            float outRight[N];
+            for (unsigned int l = 0; l < N; ++l)
+            {
+                left[l] = mono[l] + feedbackState_left[l];
+                right[l] = mono[l] + feedbackState_right[l];
+                outLeft[l] = 0.f;
+                outRight[l] = 0.f;
+            }
+
+            // LFO for allpass delay line modulation
+            const float* lfoValue { lfo.process() };
+
+            // Decay Diffusion 1 processing
+            modulatedAllPassStep<N>(decayDiffuser_left_1, w, antiDenormal, lfoValue[0], left);
+            modulatedAllPassStep<N>(decayDiffuser_right_1, w, antiDenormal, lfoValue[1], right);
+
+            // Delay line 1 processing
+            delayStep<N>(delay_left_1, w, left);
+            delayStep<N>(delay_right_1, w, right);
+
+            // First and second tap out
+            addTap<N>(outLeft, delay_right_1, w, tapOut_left[0], tapGain);
+            addTap<N>(outLeft, delay_right_1, w, tapOut_left[1], tapGain);
+            addTap<N>(outRight, delay_left_1, w, tapOut_right[0], tapGain);
+            addTap<N>(outRight, delay_left_1, w, tapOut_right[1], tapGain);
+
+            // Damping processing 1, one filter state runs through both channels
+            // and the coefficient ramp advances twice per channel, as in the single reverb
+            for (unsigned int l = 0; l < N; ++l)
+            {
+                const float inGainLeft { dampingCoeffRamp[l].getNext() };
+                const float stateGainLeft { 1.f - dampingCoeffRamp[l].getNext() };
+                left[l] = inGainLeft * left[l] + stateGainLeft * dampingState[l];
+                dampingState[l] = left[l] + antiDenormal;
+                const float inGainRight { dampingCoeffRamp[l].getNext() };
+                const float stateGainRight { 1.f - dampingCoeffRamp[l].getNext() };
+                right[l] = inGainRight * right[l] + stateGainRight * dampingState[l];
+                dampingState[l] = right[l] + antiDenormal;
+            }
+
+            // Decay processing 1
+            for (unsigned int l = 0; l < N; ++l)
+            {
+                left[l] *= decayCoeffRamp[l].getNext();
+                right[l] *= decayCoeffRamp[l].getNext();
+            }
+
+            // Decay Diffusion 2 processing
+            allPassStep<N>(decayDiffuser_left_2, w, antiDenormal, left);
+            allPassStep<N>(decayDiffuser_right_2, w, antiDenormal, right);
+
+            // Third tap out
+            addTap<N>(outLeft, decayDiffuser_right_2.line, w, tapOut_left[2], -tapGain);
+            addTap<N>(outRight, decayDiffuser_left_2.line, w, tapOut_right[2], -tapGain);
+
+            // Delay line 2 processing
+            delayStep<N>(delay_left_2, w, left);
+            delayStep<N>(delay_right_2, w, right);
+
+            // Forth tap out
+            addTap<N>(outLeft, delay_right_2, w, tapOut_left[3], tapGain);
+            addTap<N>(outRight, delay_left_2, w, tapOut_right[3], tapGain);
+
+            // Decay processing 2
+            for (unsigned int l = 0; l < N; ++l)
+            {
+                left[l] *= decayCoeffRamp[l].getNext();
+                right[l] *= decayCoeffRamp[l].getNext();
+            }
+
+            // Fifth, sixth, and seventh tap out
+            addTap<N>(outLeft, delay_left_1, w, tapOut_left[4], -tapGain);
+            addTap<N>(outLeft, decayDiffuser_left_2.line, w, tapOut_left[5], -tapGain);
+            addTap<N>(outLeft, delay_left_2, w, tapOut_left[6], -tapGain);
+            addTap<N>(outRight, delay_right_1, w, tapOut_right[4], -tapGain);
+            addTap<N>(outRight, decayDiffuser_right_2.line, w, tapOut_right[5], -tapGain);
+            addTap<N>(outRight, delay_right_2, w, tapOut_right[6], -tapGain);
+
+            // Update feedback state
+            for (unsigned int l = 0; l < N; ++l)
+            {
+                feedbackState_left[l] = left[l];
+                feedbackState_right[l] = right[l];
+            }
+
+            std::copy(outLeft, outLeft + N, leftBlock.data() + i * N);
+            std::copy(outRight, outRight + N, rightBlock.data() + i * N);
+
+            ++writeIndex;
+        }
+
+        // Scatter lane outputs
+        for (unsigned int l = 0; l < N; ++l)
+        {
+            if (laneNumChannels[l] == 0)
+                continue;
+
+            float* left { laneBuffers[l][0] + start };
+            for (unsigned int i = 0; i < blockSamples; ++i)
+                left[i] = leftBlock[i * N + l];
+
+            if (laneNumChannels[l] > 1)
+            {
+                float* right { laneBuffers[l][1] + start };
+                for (unsigned int i = 0; i < blockSamples; ++i)
+                    right[i] = rightBlock[i * N + l];
+            }
+        }
+    }
+}
+
+void DattorroReverbBank::setBrightness(unsigned int lane, float newCoeff)
+{
+    if (lane >= numLanes)
+        return;
+
+    dampingCoeff[lane] = std::clamp(newCoeff, 0.f, 1.f);
+    dampingCoeffRamp[lane].setTarget(dampingCoeff[lane]);
+}
+
+void DattorroReverbBank::setDecay(unsigned int lane, float newCoeff)
+{
+    if (lane >= numLanes)
+        return;
+
+    decayCoeff[lane] = std::clamp(newCoeff, 0.f, 1.f);
+    decayCoeffRamp[lane].setTarget(decayCoeff[lane]);
+}
+
+void DattorroReverbBank::setDenormalSafe(bool enabled)
+{
+    antiDenormal = enabled ? AntiDenormalOffset : 0.f;
+}
+
+}
\ No newline at end of file
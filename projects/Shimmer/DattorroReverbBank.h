@@ -0,0 +1,139 @@
+#pragma once
+
+#include "DattorroReverb.h"
+#include "LFO.h"
+#include "Ramp.h"
+#include "Denormals.h"
+
+#include <array>
+#include <vector>
+
+namespace DSP
+{
+
+// Bank of Dattorro reverbs processed together, one reverb per lane.
+// Every lane runs the topology and constants of DSP::DattorroReverb with its own
+// input, output, brightness and decay, the sample rate and the LFO are shared.
+// Delay memory is stored lane-interleaved (structure of arrays), so the same tap
+// of all lanes is one contiguous load and the per-sample math of the whole bank
+// runs across lanes in SIMD registers.
+class DattorroReverbBank
+{
+public:
+    DattorroReverbBank(
+        unsigned int initNumLanes,                   // Number of reverbs, 4 or 8
+        float initDampingFilterCoeff = 0.005f,       // Damping filter coefficient of all lanes
+        float initDecayCoeff = 0.50f                 // Decay coefficient of all lanes
+    );
+    ~DattorroReverbBank();
+
+    // No default ctor
+    DattorroReverbBank() = delete;
+
+    // No copy semantics
+    DattorroReverbBank(const DattorroReverbBank&) = delete;
+    const DattorroReverbBank& operator=(const DattorroReverbBank&) = delete;
+
+    // No move semantics
+    DattorroReverbBank(DattorroReverbBank&&) = delete;
+    const DattorroReverbBank& operator=(DattorroReverbBank&&) = delete;
+
+    // Update sample rate, reallocates and clears the delay memory of all lanes
+    void prepare(double newSampleRate);
+
+    // Clear the state of all lanes
+    void clear();
+
+    // Set the in-place audio buffers a lane processes in the next call to process()
+    // Lanes without buffers process silence and their output is dropped
+    void setLaneBuffers(unsigned int lane, float* const* buffers, unsigned int numChannels);
+
+    // Process numSamples samples of every lane in place, lane buffers are reset afterwards
+    void process(unsigned int numSamples);
+
+    // Per lane parameters, same ranges as DSP::DattorroReverb
+    void setBrightness(unsigned int lane, float newCoeff);
+    void setDecay(unsigned int lane, float newCoeff);
+
+    // Same denormal protection as DSP::DattorroReverb, for all lanes, on by default
+    void setDenormalSafe(bool enabled);
+
+    unsigned int getNumLanes() const { return numLanes; }
+
+    static constexpr unsigned int MaxLanes { 8 };
+    static constexpr unsigned int MaxBlockSamples { DattorroReverb::MaxBlockSamples };
+
+private:
+    // Lane-interleaved delay memory, frame i holds sample i of every lane
+    struct Line
+    {
+        std::vector<float> buffer;
+        unsigned int mask { 0 };
+        unsigned int delay { 0 };
+    };
+
+    // Allpass on top of a line, one feedback state per lane
+    struct AllPassLine
+    {
+        Line line;
+        float coeff { 0.f };
+        std::array<float, MaxLanes> state;
+    };
+
+    // Size a line for the given delay plus extra read distance and clear it
+    void prepareLine(Line& line, unsigned int delay, unsigned int extraSamples);
+
+    // Process the whole bank with a fixed lane count
+    template <unsigned int N>
+    void processLanes(unsigned int numSamples);
+
+    const unsigned int numLanes;
+    double sampleRate { 48000.0 };
+
+    // Shared write position, every line advances by one frame per sample
+    unsigned int writeIndex { 0 };
+
+    // --------- FEEDFORWARD ---------
+    Line preDelay;
+    std::array<float, MaxLanes> toneState;
+    AllPassLine inputDiffuser_1;
+    AllPassLine inputDiffuser_2;
+    AllPassLine inputDiffuser_3;
+    AllPassLine inputDiffuser_4;
+
+    // ---------- RECURSION ----------
+    DSP::LFO lfo;
+    AllPassLine decayDiffuser_left_1;
+    AllPassLine decayDiffuser_right_1;
+    Line delay_left_1;
+    Line delay_right_1;
+    AllPassLine decayDiffuser_left_2;
+    AllPassLine decayDiffuser_right_2;
+    Line delay_left_2;
+    Line delay_right_2;
+    std::array<float, MaxLanes> dampingState;
+    std::array<float, MaxLanes> feedbackState_left;
+    std::array<float, MaxLanes> feedbackState_right;
+
+    // Per lane parameters
+    std::array<DSP::Ramp<float>, MaxLanes> dampingCoeffRamp;
+    std::array<DSP::Ramp<float>, MaxLanes> decayCoeffRamp;
+    std::array<float, MaxLanes> dampingCoeff;
+    std::array<float, MaxLanes> decayCoeff;
+    float antiDenormal { AntiDenormalOffset };
+
+    // Output tap delays in samples
+    unsigned int tapOut_left[7] { };
+    unsigned int tapOut_right[7] { };
+
+    // Lane audio buffers of the next process() call
+    std::array<float* const*, MaxLanes> laneBuffers;
+    std::array<unsigned int, MaxLanes> laneNumChannels;
+
+    // Lane-interleaved block buffers
+    std::vector<float> monoBlock;
+    std::vector<float> leftBlock;
+    std::vector<float> rightBlock;
+};
+
+}
\ No newline at end of file
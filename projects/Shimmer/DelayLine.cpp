@@ -2,88 +2,144 @@
 
 #include <algorithm>
 #include <cmath>
+#include <memory>
 
 namespace DSP
 {
 
-DelayLine::DelayLine(unsigned int maxLengthSamples, unsigned int numChannels)
+namespace
+{
+
+// Smallest power of two greater or equal than x
+unsigned int nextPowerOfTwo(unsigned int x)
+{
+    unsigned int p { 1u };
+    while (p < x)
+        p <<= 1;
+    return p;
+}
+
+}
+
+DelayLine::DelayLine(unsigned int maxLengthSamples, unsigned int numChannels, Layout initLayout) :
+    layout { initLayout }
 {
     delayBufferSize = std::max(maxLengthSamples + 1u, 1u);
-    for (unsigned int ch = 0; ch < numChannels; ++ch)
-        delayBuffer.emplace_back(delayBufferSize, 0.f);
+    bufferMask = nextPowerOfTwo(delayBufferSize) - 1u;
+    allocate(numChannels);
 }
 
 DelayLine::~DelayLine()
 {
 }
 
+void DelayLine::allocate(unsigned int newNumChannels)
+{
+    const unsigned int capacity { bufferMask + 1u };
+    const size_t numFloats { static_cast<size_t>(capacity) * newNumChannels };
+    const size_t paddingFloats { BufferAlignment / sizeof(float) };
+
+    // Only grow the arena, channel counts that fit reuse the current allocation
+    if (arena.size() < numFloats + paddingFloats)
+        arena.resize(numFloats + paddingFloats, 0.f);
+
+    void* alignedStart { arena.data() };
+    size_t space { arena.size() * sizeof(float) };
+    buffer = static_cast<float*>(std::align(BufferAlignment, numFloats * sizeof(float), alignedStart, space));
+
+    allocatedChannels = newNumChannels;
+    channelStride = (layout == Planar) ? capacity : 1u;
+    sampleStride = (layout == Planar) ? 1u : std::max(allocatedChannels, 1u);
+}
+
 void DelayLine::clear()
 {
-    for (auto& b : delayBuffer)
-        std::fill(b.begin(), b.end(), 0.f);
+    std::fill(arena.begin(), arena.end(), 0.f);
 }
 
 void DelayLine::prepare(unsigned int newDelaySamples, unsigned int numChannels)
 {
-    delayBuffer.clear();
-    for (unsigned int ch = 0; ch < numChannels; ++ch)
-        delayBuffer.emplace_back(std::max(delayBufferSize, 1u), 0.f);
-    delaySamples = newDelaySamples;
+    allocate(numChannels);
+    clear();
+    setDelaySamples(newDelaySamples);
 }
 
 void DelayLine::process(float* const* output, const float* const* input, unsigned int numChannels, unsigned int numSamples)
 {
-    const unsigned int delayBufferSize { static_cast<unsigned int>(delayBuffer[0].size()) };
+    const unsigned int capacity { bufferMask + 1u };
+
+    numChannels = std::min(numChannels, allocatedChannels);
+
+    // When the samples read by this block are never overwritten by it,
+    // the whole block is two contiguous copies in and two out.
+    // Input is written first so in-place processing is safe.
+    if (delaySamples < capacity && numSamples <= std::min(delaySamples, capacity - delaySamples))
+    {
+        for (unsigned int ch = 0; ch < numChannels; ++ch)
+        {
+            writeBlock(ch, input[ch], numSamples);
+            readBlock(ch, delaySamples, output[ch], numSamples);
+        }
+
+        advanceWrite(numSamples);
+        return;
+    }
 
-    numChannels = std::min(numChannels, static_cast<unsigned int>(delayBuffer.size()));
     for (unsigned int ch = 0; ch < numChannels; ++ch)
     {
+        float* const channelBuffer { buffer + ch * channelStride };
         unsigned int workingWriteIndex { writeIndex };
-        unsigned int workingReadIndex { (workingWriteIndex + delayBufferSize - delaySamples) % delayBufferSize };
+        unsigned int workingReadIndex { (workingWriteIndex - delaySamples) & bufferMask };
 
         for (unsigned int n = 0; n < numSamples; ++n)
         {
             const float x { input[ch][n] };
-            output[ch][n] = delayBuffer[ch][workingReadIndex];
-            delayBuffer[ch][workingWriteIndex] = x;
+            output[ch][n] = channelBuffer[workingReadIndex * sampleStride];
+            channelBuffer[workingWriteIndex * sampleStride] = x;
 
-            ++workingWriteIndex; workingWriteIndex %= delayBufferSize;
-            ++workingReadIndex; workingReadIndex %= delayBufferSize;
+            ++workingWriteIndex; workingWriteIndex &= bufferMask;
+            ++workingReadIndex; workingReadIndex &= bufferMask;
         }
     }
 
-    writeIndex += numSamples; writeIndex %= delayBufferSize;
+    writeIndex += numSamples; writeIndex &= bufferMask;
 }
 
 void DelayLine::process(float* output, const float* input, unsigned int numChannels)
 {
-    const unsigned int delayBufferSize{ static_cast<unsigned int>(delayBuffer[0].size()) };
+    numChannels = std::min(numChannels, allocatedChannels);
 
-    numChannels = std::min(numChannels, static_cast<unsigned int>(delayBuffer.size()));
+    // Mono and stereo run the unrolled kernels
+    switch (numChannels)
+    {
+        case 1: processSample<1>(output, input); return;
+        case 2: processSample<2>(output, input); return;
+        default: break;
+    }
 
-    unsigned int workingWriteIndex { writeIndex };
-    unsigned int workingReadIndex { (workingWriteIndex + delayBufferSize - delaySamples) % delayBufferSize };
+    float* const writeFrame { buffer + writeIndex * sampleStride };
+    const float* const readFrame { buffer + ((writeIndex - delaySamples) & bufferMask) * sampleStride };
 
     for (unsigned int ch = 0; ch < numChannels; ++ch)
     {
         const float x { input[ch] };
-        output[ch] = delayBuffer[ch][workingReadIndex];
-        delayBuffer[ch][workingWriteIndex] = x;
+        output[ch] = readFrame[ch * channelStride];
+        writeFrame[ch * channelStride] = x;
     }
 
-    ++writeIndex; writeIndex %= delayBufferSize;
+    ++writeIndex; writeIndex &= bufferMask;
 }
 
 void DelayLine::process(float* const* audioOutput, const float* const* audioInput, const float* const* modInput, unsigned int numChannels, unsigned int numSamples)
 {
-    const unsigned int delayBufferSize{ static_cast<unsigned int>(delayBuffer[0].size()) };
-
-    numChannels = std::min(numChannels, static_cast<unsigned int>(delayBuffer.size()));
+    numChannels = std::min(numChannels, allocatedChannels);
     for (unsigned int ch = 0; ch < numChannels; ++ch)
     {
+        float* const channelBuffer { buffer + ch * channelStride };
+
         // Calculate base indices based on fixed delay time
         unsigned int workingWriteIndex { writeIndex };
-        unsigned int workingReadIndex { (workingWriteIndex + delayBufferSize - delaySamples) % delayBufferSize };
+        unsigned int workingReadIndex { (workingWriteIndex - delaySamples) & bufferMask };
 
         for (unsigned int n = 0; n < numSamples; ++n)
         {
@@ -94,12 +150,12 @@ void DelayLine::process(float* const* audioOutput, const float* const* audioInpu
             const float mFrac1 { 1.f - mFrac0 };
 
             // Calculate read indices
-            const unsigned int readIndex0 { (workingReadIndex + delayBufferSize - static_cast<unsigned int>(mFloor)) % delayBufferSize };
-            const unsigned int readIndex1 { (readIndex0 + delayBufferSize - 1u) % delayBufferSize };
+            const unsigned int readIndex0 { (workingReadIndex - static_cast<unsigned int>(mFloor)) & bufferMask };
+            const unsigned int readIndex1 { (readIndex0 - 1u) & bufferMask };
 
             // Read from delay line
-            const float read0 = delayBuffer[ch][readIndex0];
-            const float read1 = delayBuffer[ch][readIndex1];
+            const float read0 = channelBuffer[readIndex0 * sampleStride];
+            const float read1 = channelBuffer[readIndex1 * sampleStride];
 
             // Read audio input
             const float x { audioInput[ch][n] };
@@ -108,29 +164,37 @@ void DelayLine::process(float* const* audioOutput, const float* const* audioInpu
             audioOutput[ch][n] = read0 * mFrac1 + read1 * mFrac0;
 
             // Write input
-            delayBuffer[ch][workingWriteIndex] = x;
+            channelBuffer[workingWriteIndex * sampleStride] = x;
 
             // Increament indices
-            ++workingWriteIndex; workingWriteIndex %= delayBufferSize;
-            ++workingReadIndex; workingReadIndex %= delayBufferSize;
+            ++workingWriteIndex; workingWriteIndex &= bufferMask;
+            ++workingReadIndex; workingReadIndex &= bufferMask;
         }
     }
 
     // Update persistent write index
-    writeIndex += numSamples; writeIndex %= delayBufferSize;
+    writeIndex += numSamples; writeIndex &= bufferMask;
 }
 
 void DelayLine::process(float* audioOutput, const float* audioInput, const float* modInput, unsigned int numChannels)
 {
-    const unsigned int delayBufferSize{ static_cast<unsigned int>(delayBuffer[0].size()) };
+    numChannels = std::min(numChannels, allocatedChannels);
 
-    // Calculate base indices based on fixed delay time
-    unsigned int workingWriteIndex { writeIndex };
-    unsigned int workingReadIndex { (workingWriteIndex + delayBufferSize - delaySamples) % delayBufferSize };
+    // Mono and stereo run the unrolled kernels
+    switch (numChannels)
+    {
+        case 1: processSample<1>(audioOutput, audioInput, modInput); return;
+        case 2: processSample<2>(audioOutput, audioInput, modInput); return;
+        default: break;
+    }
 
-    numChannels = std::min(numChannels, static_cast<unsigned int>(delayBuffer.size()));
+    // Calculate base indices based on fixed delay time
+    const unsigned int workingWriteIndex { writeIndex };
+    const unsigned int workingReadIndex { (workingWriteIndex - delaySamples) & bufferMask };
     for (unsigned int ch = 0; ch < numChannels; ++ch)
     {
+        float* const channelBuffer { buffer + ch * channelStride };
+
         // Linear interpolation coefficients
         const float m { std::fmax(modInput[ch], 0.f) };
         const float mFloor { std::floor(m) };
@@ -138,12 +202,12 @@ void DelayLine::process(float* audioOutput, const float* audioInput, const float
         const float mFrac1 { 1.f - mFrac0 };
 
         // Calculate read indeces
-        const unsigned int readIndex0 { (workingReadIndex + delayBufferSize - static_cast<unsigned int>(mFloor)) % delayBufferSize };
-        const unsigned int readIndex1 { (readIndex0 + delayBufferSize - 1u) % delayBufferSize };
+        const unsigned int readIndex0 { (workingReadIndex - static_cast<unsigned int>(mFloor)) & bufferMask };
+        const unsigned int readIndex1 { (readIndex0 - 1u) & bufferMask };
 
         // Read from delay line
-        const float read0 = delayBuffer[ch][readIndex0];
-        const float read1 = delayBuffer[ch][readIndex1];
+        const float read0 = channelBuffer[readIndex0 * sampleStride];
+        const float read1 = channelBuffer[readIndex1 * sampleStride];
 
         // Read audio input
         const float x { audioInput[ch] };
@@ -152,21 +216,20 @@ void DelayLine::process(float* audioOutput, const float* audioInput, const float
         audioOutput[ch] = read0 * mFrac1 + read1 * mFrac0;
 
         // Write input
-        delayBuffer[ch][workingWriteIndex] = x;
+        channelBuffer[workingWriteIndex * sampleStride] = x;
     }
 
     // Update persistent write index
-    ++writeIndex; writeIndex %= delayBufferSize;
+    ++writeIndex; writeIndex &= bufferMask;
 }
 
 void DelayLine::process(float* audioOutput, const float* audioInput, const float* modInput, int channel)
 {
-    const unsigned int delayBufferSize{ static_cast<unsigned int>(delayBuffer[0].size()) };
-    const unsigned int numChannels{ static_cast<unsigned int>(delayBuffer.size()) };
+    float* const channelBuffer { buffer + static_cast<unsigned int>(channel) * channelStride };
 
     // Calculate base indices based on fixed delay time
-    unsigned int workingWriteIndex { writeIndex };
-    unsigned int workingReadIndex { (workingWriteIndex + delayBufferSize - delaySamples) % delayBufferSize };
+    const unsigned int workingWriteIndex { writeIndex };
+    const unsigned int workingReadIndex { (workingWriteIndex - delaySamples) & bufferMask };
 
     // Linear interpolation coefficients
     const float m { std::fmax(modInput[channel], 0.f) };
@@ -175,12 +238,12 @@ void DelayLine::process(float* audioOutput, const float* audioInput, const float
     const float mFrac1 { 1.f - mFrac0 };
 
     // Calculate read indeces
-    const unsigned int readIndex0 { (workingReadIndex + delayBufferSize - static_cast<unsigned int>(mFloor)) % delayBufferSize };
-    const unsigned int readIndex1 { (readIndex0 + delayBufferSize - 1u) % delayBufferSize };
+    const unsigned int readIndex0 { (workingReadIndex - static_cast<unsigned int>(mFloor)) & bufferMask };
+    const unsigned int readIndex1 { (readIndex0 - 1u) & bufferMask };
 
     // Read from delay line
-    const float read0 = delayBuffer[channel][readIndex0];
-    const float read1 = delayBuffer[channel][readIndex1];
+    const float read0 = channelBuffer[readIndex0 * sampleStride];
+    const float read1 = channelBuffer[readIndex1 * sampleStride];
 
     // Read audio input
     const float x { audioInput[channel] };
@@ -189,25 +252,89 @@ void DelayLine::process(float* audioOutput, const float* audioInput, const float
     audioOutput[channel] = read0 * mFrac1 + read1 * mFrac0;
 
     // Write input
-    delayBuffer[channel][workingWriteIndex] = x;
+    channelBuffer[workingWriteIndex * sampleStride] = x;
 
     // Update persistent write index
-    ++writeIndex; writeIndex %= delayBufferSize;
+    ++writeIndex; writeIndex &= bufferMask;
 }
 
 void DelayLine::setDelaySamples(unsigned int newDelaySamples)
 {
-    delaySamples = std::max(std::min(newDelaySamples, static_cast<unsigned int>(delayBuffer[0].size() - 1u)), 1u);
+    delaySamples = std::max(std::min(newDelaySamples, delayBufferSize - 1u), 1u);
 }
 
 float DelayLine::getSample(unsigned int channel, unsigned int index) const
-{   
-    const unsigned int delayBufferSize{ static_cast<unsigned int>(delayBuffer[0].size()) };
-
+{
     index = std::max(std::min(index, delayBufferSize - 1u), 1u);
-    unsigned int workingReadIndex { (writeIndex + delayBufferSize - index) % delayBufferSize };
+    return buffer[channel * channelStride + ((writeIndex - index) & bufferMask) * sampleStride];
+}
+
+void DelayLine::setTaps(const unsigned int* newTaps, unsigned int newNumTaps)
+{
+    numTaps = std::min(newNumTaps, MaxTaps);
+    for (unsigned int t = 0; t < numTaps; ++t)
+        taps[t] = std::max(std::min(newTaps[t], delayBufferSize - 1u), 1u);
+}
 
-    return delayBuffer[channel][workingReadIndex];
+DelayLine::SplitSpan DelayLine::getReadSpan(unsigned int channel, unsigned int delay, unsigned int numSamples)
+{
+    const unsigned int capacity { bufferMask + 1u };
+    const unsigned int startIndex { (writeIndex - delay) & bufferMask };
+    float* const channelBuffer { buffer + channel * channelStride };
+
+    numSamples = std::min(numSamples, capacity);
+
+    SplitSpan span;
+    span.first = channelBuffer + startIndex * sampleStride;
+    span.firstSize = std::min(numSamples, capacity - startIndex);
+    span.second = channelBuffer;
+    span.secondSize = numSamples - span.firstSize;
+    span.stride = sampleStride;
+    return span;
+}
+
+DelayLine::SplitSpan DelayLine::getWriteSpan(unsigned int channel, unsigned int numSamples)
+{
+    return getReadSpan(channel, 0u, numSamples);
+}
+
+void DelayLine::readBlock(unsigned int channel, unsigned int delay, float* output, unsigned int numSamples)
+{
+    const SplitSpan span { getReadSpan(channel, delay, numSamples) };
+
+    if (span.stride == 1u)
+    {
+        std::copy(span.first, span.first + span.firstSize, output);
+        std::copy(span.second, span.second + span.secondSize, output + span.firstSize);
+        return;
+    }
+
+    for (unsigned int n = 0; n < span.firstSize; ++n)
+        output[n] = span.first[n * span.stride];
+    for (unsigned int n = 0; n < span.secondSize; ++n)
+        output[span.firstSize + n] = span.second[n * span.stride];
+}
+
+void DelayLine::writeBlock(unsigned int channel, const float* input, unsigned int numSamples)
+{
+    const SplitSpan span { getWriteSpan(channel, numSamples) };
+
+    if (span.stride == 1u)
+    {
+        std::copy(input, input + span.firstSize, span.first);
+        std::copy(input + span.firstSize, input + span.firstSize + span.secondSize, span.second);
+        return;
+    }
+
+    for (unsigned int n = 0; n < span.firstSize; ++n)
+        span.first[n * span.stride] = input[n];
+    for (unsigned int n = 0; n < span.secondSize; ++n)
+        span.second[n * span.stride] = input[span.firstSize + n];
+}
+
+void DelayLine::advanceWrite(unsigned int numSamples)
+{
+    writeIndex += numSamples; writeIndex &= bufferMask;
 }
 
 }
\ No newline at end of file
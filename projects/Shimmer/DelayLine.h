@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cmath>
 #include <vector>
 
 namespace DSP
@@ -8,7 +9,16 @@ namespace DSP
 class DelayLine
 {
 public:
-    DelayLine(unsigned int maxLengthSamples, unsigned int numChannels);
+    // Memory layout of the channels in the delay buffer
+    // Planar stores each channel contiguously, Interleaved stores all channels
+    // of a sample next to each other, which suits multichannel reads at the same tap
+    enum Layout : unsigned int
+    {
+        Planar = 0,
+        Interleaved
+    };
+
+    DelayLine(unsigned int maxLengthSamples, unsigned int numChannels, Layout initLayout = Planar);
     ~DelayLine();
 
     // No default ctor
@@ -25,8 +35,10 @@ public:
     // Clear the contents of the delay buffer
     void clear();
 
-    // Reallocate delay buffer for the new channel count and clear its contents
-    void prepare(unsigned int maxLengthSamples, unsigned int numChannels);
+    // Set the delay time and channel count and clear the buffer contents
+    // The delay time is clamped to the length given at construction, like setDelaySamples()
+    // Memory is only reallocated if the channels do not fit in the current buffer
+    void prepare(unsigned int newDelaySamples, unsigned int numChannels);
 
     // Process audio with the currently (fixed) set delay time
     void process(float* const* output, const float* const* input, unsigned int numChannels, unsigned int numSamples);
@@ -47,18 +59,175 @@ public:
     // Single-channel single-sample flavour of the modulated delay time processing
     void process(float* audioOutput, const float* audioInput, const float* modInput, int channel);
 
+    // Fixed channel count flavours of the single-sample processing, for callers that know
+    // their channel count at compile time, so the channel loop unrolls
+    // N must not be larger than the prepared channel count
+    template <unsigned int N>
+    void processSample(float* output, const float* input);
+
+    template <unsigned int N>
+    void processSample(float* audioOutput, const float* audioInput, const float* modInput);
+
     // Set the current delay time in samples
     void setDelaySamples(unsigned int newDelaySamples);
 
     // Get sample at requested index
     float getSample(unsigned int channel, unsigned int index) const;
 
+    // Set the fixed read taps, in samples before the write position, clamped like getSample()
+    // Offsets are resolved once here, so readTaps() only wraps them around the write position
+    void setTaps(const unsigned int* newTaps, unsigned int newNumTaps);
+
+    // Read all taps of a channel in one call, output holds getNumTaps() samples in tap order
+    void readTaps(unsigned int channel, float* output) const;
+
+    // Interpolated flavour, every tap is moved further back by the same fractional
+    // modulation in samples, with the linear interpolation of the modulated process()
+    void readTaps(unsigned int channel, float* output, float modInput) const;
+
+    unsigned int getNumTaps() const { return numTaps; }
+
+    // Region of a delay buffer channel split in (at most) two segments
+    // The segments are in chronological order, oldest sample first
+    // Consecutive samples are 'stride' floats apart, 1 for the planar layout
+    struct SplitSpan
+    {
+        float* first { nullptr };
+        unsigned int firstSize { 0 };
+        float* second { nullptr };
+        unsigned int secondSize { 0 };
+        unsigned int stride { 1 };
+    };
+
+    // Get the region holding numSamples samples, starting at the sample
+    // written 'delay' samples before the current write position
+    SplitSpan getReadSpan(unsigned int channel, unsigned int delay, unsigned int numSamples);
+
+    // Get the region where the next numSamples input samples will be written
+    SplitSpan getWriteSpan(unsigned int channel, unsigned int numSamples);
+
+    // Copy numSamples samples starting at 'delay' samples in the past into output
+    void readBlock(unsigned int channel, unsigned int delay, float* output, unsigned int numSamples);
+
+    // Copy numSamples input samples to the current write position
+    // The write position is only moved by advanceWrite, so all channels can be written first
+    void writeBlock(unsigned int channel, const float* input, unsigned int numSamples);
+
+    // Move the write position forward after writing thru spans or writeBlock
+    void advanceWrite(unsigned int numSamples);
+
+    // Get the current delay time in samples
+    unsigned int getDelaySamples() const { return delaySamples; }
+
+    // Get the buffer capacity in samples, always a power of two
+    unsigned int getCapacity() const { return bufferMask + 1u; }
+
+    // Get the channel memory layout
+    Layout getLayout() const { return layout; }
+
+    // Alignment of the delay buffer in bytes
+    static constexpr unsigned int BufferAlignment { 64 };
+
+    // Highest sample rate the effects size their delay memory for at construction,
+    // so preparing them for any rate up to it only changes delay lengths
+    static constexpr double MaxSampleRate { 192000.0 };
+
+    // Maximum number of taps set with setTaps()
+    static constexpr unsigned int MaxTaps { 8 };
 
 private:
-    std::vector<std::vector<float>> delayBuffer;
+    // Make sure the arena fits all channels and point the buffer at its aligned start
+    void allocate(unsigned int newNumChannels);
+
+    // Single allocation holding all channels, over-allocated for alignment
+    std::vector<float> arena;
+    // Aligned start of the delay buffer inside the arena
+    float* buffer { nullptr };
+    // Sample (ch, i) lives at buffer[ch * channelStride + i * sampleStride]
+    unsigned int channelStride { 0 };
+    unsigned int sampleStride { 1 };
+    unsigned int allocatedChannels { 0 };
+    Layout layout { Planar };
+    // Requested buffer size, delay times are clamped to it
     unsigned int delayBufferSize { 0 };
+    // Allocated buffer size is rounded up to a power of two, indices wrap with this mask
+    unsigned int bufferMask { 0 };
     unsigned int delaySamples { 0 };
     unsigned int writeIndex { 0 };
+    // Read taps in samples before the write position
+    unsigned int taps[MaxTaps] { };
+    unsigned int numTaps { 0 };
 };
 
+inline void DelayLine::readTaps(unsigned int channel, float* output) const
+{
+    const float* const channelBuffer { buffer + channel * channelStride };
+
+    for (unsigned int t = 0; t < numTaps; ++t)
+        output[t] = channelBuffer[((writeIndex - taps[t]) & bufferMask) * sampleStride];
+}
+
+inline void DelayLine::readTaps(unsigned int channel, float* output, float modInput) const
+{
+    const float* const channelBuffer { buffer + channel * channelStride };
+
+    const float m { std::fmax(modInput, 0.f) };
+    const float mFloor { std::floor(m) };
+    const float mFrac0 { m - mFloor };
+    const float mFrac1 { 1.f - mFrac0 };
+    const unsigned int modIndex { writeIndex - static_cast<unsigned int>(mFloor) };
+
+    for (unsigned int t = 0; t < numTaps; ++t)
+    {
+        const unsigned int readIndex0 { (modIndex - taps[t]) & bufferMask };
+        const unsigned int readIndex1 { (readIndex0 - 1u) & bufferMask };
+        output[t] = channelBuffer[readIndex0 * sampleStride] * mFrac1 + channelBuffer[readIndex1 * sampleStride] * mFrac0;
+    }
+}
+
+template <unsigned int N>
+void DelayLine::processSample(float* output, const float* input)
+{
+    float* const writeFrame { buffer + writeIndex * sampleStride };
+    const float* const readFrame { buffer + ((writeIndex - delaySamples) & bufferMask) * sampleStride };
+
+    for (unsigned int ch = 0; ch < N; ++ch)
+    {
+        const float x { input[ch] };
+        output[ch] = readFrame[ch * channelStride];
+        writeFrame[ch * channelStride] = x;
+    }
+
+    ++writeIndex; writeIndex &= bufferMask;
+}
+
+template <unsigned int N>
+void DelayLine::processSample(float* audioOutput, const float* audioInput, const float* modInput)
+{
+    const unsigned int workingWriteIndex { writeIndex };
+    const unsigned int workingReadIndex { (workingWriteIndex - delaySamples) & bufferMask };
+
+    for (unsigned int ch = 0; ch < N; ++ch)
+    {
+        float* const channelBuffer { buffer + ch * channelStride };
+
+        const float m { std::fmax(modInput[ch], 0.f) };
+        const float mFloor { std::floor(m) };
+        const float mFrac0 { m - mFloor };
+        const float mFrac1 { 1.f - mFrac0 };
+
+        const unsigned int readIndex0 { (workingReadIndex - static_cast<unsigned int>(mFloor)) & bufferMask };
+        const unsigned int readIndex1 { (readIndex0 - 1u) & bufferMask };
+
+        const float read0 = channelBuffer[readIndex0 * sampleStride];
+        const float read1 = channelBuffer[readIndex1 * sampleStride];
+
+        const float x { audioInput[ch] };
+        audioOutput[ch] = read0 * mFrac1 + read1 * mFrac0;
+        channelBuffer[workingWriteIndex * sampleStride] = x;
+    }
+
+    ++writeIndex; writeIndex &= bufferMask;
+}
+
 }
\ No newline at end of file
@@ -0,0 +1,12 @@
+#pragma once
+
+namespace DSP
+{
+
+// Offset added inside the recursive filters while their denormal protection is on.
+// Decaying feedback settles on it instead of falling into the denormal range, which
+// is slow on most CPUs unless flush-to-zero is enabled, as juce::ScopedNoDenormals does.
+// About -400dBFS, inaudible and still far above the smallest normal float.
+static constexpr float AntiDenormalOffset { 1e-20f };
+
+}
\ No newline at end of file
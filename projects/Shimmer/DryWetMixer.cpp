@@ -0,0 +1,115 @@
+#include "DryWetMixer.h"
+
+#include <algorithm>
+
+namespace DSP
+{
+
+DryWetMixer::DryWetMixer(float initMix, float initWetGain, float mixRampTimeSec, float wetGainRampTimeSec) :
+    mixRamp(mixRampTimeSec),
+    wetGainRamp(wetGainRampTimeSec),
+    mix { std::clamp(initMix, 0.f, 1.f) },
+    wetGain { initWetGain }
+{
+    mixRamp.setTarget(mix, true);
+    wetGainRamp.setTarget(wetGain, true);
+}
+
+DryWetMixer::~DryWetMixer()
+{
+}
+
+void DryWetMixer::prepare(double sampleRate)
+{
+    mixRamp.prepare(sampleRate, true, mix);
+    wetGainRamp.prepare(sampleRate, true, wetGain);
+}
+
+void DryWetMixer::setMix(float newMix, bool skipRamp)
+{
+    mix = std::clamp(newMix, 0.f, 1.f);
+    mixRamp.setTarget(mix, skipRamp);
+}
+
+void DryWetMixer::setWetGain(float newWetGain, bool skipRamp)
+{
+    wetGain = newWetGain;
+    wetGainRamp.setTarget(wetGain, skipRamp);
+}
+
+bool DryWetMixer::isWetMuted() const
+{
+    return mixRamp.isSettled() && wetGainRamp.isSettled()
+        && mixRamp.getCurrentValue() * wetGainRamp.getCurrentValue() == 0.f;
+}
+
+void DryWetMixer::process(float* const* output, const float* const* dry, const float* const* wet, unsigned int numChannels, unsigned int numSamples)
+{
+    unsigned int start { 0 };
+
+    // While a ramp moves, compute both gains for a chunk, then mix every channel with them
+    while (start < numSamples && !(mixRamp.isSettled() && wetGainRamp.isSettled()))
+    {
+        const unsigned int count { std::min(numSamples - start, ChunkSamples) };
+        float dryGains[ChunkSamples];
+        float wetGains[ChunkSamples];
+        for (unsigned int n = 0; n < count; ++n)
+        {
+            const float m { mixRamp.getNext() };
+            dryGains[n] = 1.f - m;
+            wetGains[n] = m * wetGainRamp.getNext();
+        }
+
+        for (unsigned int ch = 0; ch < numChannels; ++ch)
+        {
+            float* const out { output[ch] + start };
+            const float* const inDry { dry[ch] + start };
+            const float* const inWet { wet[ch] + start };
+            for (unsigned int n = 0; n < count; ++n)
+                out[n] = inDry[n] * dryGains[n] + inWet[n] * wetGains[n];
+        }
+
+        start += count;
+    }
+
+    if (start == numSamples)
+        return;
+
+    // Settled, constant gains for the rest of the block
+    const float dryGain { 1.f - mixRamp.getCurrentValue() };
+    const float wetGainTotal { mixRamp.getCurrentValue() * wetGainRamp.getCurrentValue() };
+    const unsigned int count { numSamples - start };
+
+    for (unsigned int ch = 0; ch < numChannels; ++ch)
+    {
+        float* const out { output[ch] + start };
+        const float* const inDry { dry[ch] + start };
+        const float* const inWet { wet[ch] + start };
+
+        if (wetGainTotal == 0.f)
+        {
+            if (dryGain == 1.f)
+            {
+                if (out != inDry)
+                    std::copy(inDry, inDry + count, out);
+            }
+            else
+            {
+                for (unsigned int n = 0; n < count; ++n)
+                    out[n] = inDry[n] * dryGain;
+            }
+        }
+        else if (dryGain == 0.f)
+        {
+            for (unsigned int n = 0; n < count; ++n)
+                out[n] = inWet[n] * wetGainTotal;
+        }
+        else
+        {
+            for (unsigned int n = 0; n < count; ++n)
+                out[n] = inDry[n] * dryGain + inWet[n] * wetGainTotal;
+        }
+    }
+}
+
+}
\ No newline at end of file
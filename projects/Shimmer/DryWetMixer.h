@@ -0,0 +1,57 @@
+#pragma once
+
+#include "Ramp.h"
+
+namespace DSP
+{
+
+// Ramped dry/wet mix with an extra gain on the wet path, in one pass per channel
+// output = dry * (1 - mix) + wet * mix * wetGain
+class DryWetMixer
+{
+public:
+    DryWetMixer(
+        float initMix,                      // Wet proportion, 0 to 1
+        float initWetGain = 1.f,            // Gain applied to the wet signal only
+        float mixRampTimeSec = 0.05f,       // Ramp time of mix changes
+        float wetGainRampTimeSec = 0.05f    // Ramp time of wet gain changes
+    );
+    ~DryWetMixer();
+
+    // No default ctor
+    DryWetMixer() = delete;
+
+    // No copy semantics
+    DryWetMixer(const DryWetMixer&) = delete;
+    const DryWetMixer& operator=(const DryWetMixer&) = delete;
+
+    // No move semantics
+    DryWetMixer(DryWetMixer&&) = delete;
+    const DryWetMixer& operator=(DryWetMixer&&) = delete;
+
+    // Update sample rate, skips the ramps to their targets
+    void prepare(double sampleRate);
+
+    // Set the wet proportion, optionally skipping the ramp
+    void setMix(float newMix, bool skipRamp = false);
+
+    // Set the gain of the wet signal, optionally skipping the ramp
+    void setWetGain(float newWetGain, bool skipRamp = false);
+
+    // True once both ramps settled on a zero wet gain, process() then ignores the wet input
+    bool isWetMuted() const;
+
+    // Mix dry and wet into output, output may be the same buffer as dry or wet
+    void process(float* const* output, const float* const* dry, const float* const* wet, unsigned int numChannels, unsigned int numSamples);
+
+    // Samples of ramped gains computed at once while a ramp is moving
+    static constexpr unsigned int ChunkSamples { 64 };
+
+private:
+    DSP::Ramp<float> mixRamp;
+    DSP::Ramp<float> wetGainRamp;
+    float mix;
+    float wetGain;
+};
+
+}
\ No newline at end of file
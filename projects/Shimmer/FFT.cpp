@@ -0,0 +1,134 @@
+#include "FFT.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace DSP
+{
+
+FFT::FFT(unsigned int initOrder) :
+    size { 1u << std::max(initOrder, 2u) },
+    half { size / 2 }
+{
+    const double pi { 3.14159265358979323846 };
+
+    // Twiddles of every stage stored contiguously, the stage of span s starts at s - 1
+    twiddleRe.resize(half);
+    twiddleIm.resize(half);
+    for (unsigned int span = 1; span < half; span <<= 1)
+    {
+        for (unsigned int k = 0; k < span; ++k)
+        {
+            const double phase { -pi * static_cast<double>(k) / static_cast<double>(span) };
+            twiddleRe[span - 1 + k] = static_cast<float>(std::cos(phase));
+            twiddleIm[span - 1 + k] = static_cast<float>(std::sin(phase));
+        }
+    }
+
+    splitRe.resize(half + 1);
+    splitIm.resize(half + 1);
+    for (unsigned int k = 0; k <= half; ++k)
+    {
+        const double phase { -2.0 * pi * static_cast<double>(k) / static_cast<double>(size) };
+        splitRe[k] = static_cast<float>(std::cos(phase));
+        splitIm[k] = static_cast<float>(std::sin(phase));
+    }
+
+    unsigned int bits { 0 };
+    while ((1u << bits) < half)
+        ++bits;
+
+    bitReverse.resize(half);
+    for (unsigned int i = 0; i < half; ++i)
+    {
+        unsigned int r { 0 };
+        for (unsigned int b = 0; b < bits; ++b)
+            r |= ((i >> b) & 1u) << (bits - 1 - b);
+        bitReverse[i] = r;
+    }
+
+    workRe.resize(half);
+    workIm.resize(half);
+}
+
+FFT::~FFT()
+{
+}
+
+void FFT::forward(const float* input, float* outputRe, float* outputIm)
+{
+    // Pack even samples into the real part and odd samples into the imaginary part
+    for (unsigned int m = 0; m < half; ++m)
+    {
+        workRe[bitReverse[m]] = input[2 * m];
+        workIm[bitReverse[m]] = input[2 * m + 1];
+    }
+
+    transform(workRe.data(), workIm.data());
+
+    // Split the spectra of the even and odd samples and combine them
+    for (unsigned int k = 0; k <= half; ++k)
+    {
+        const unsigned int a { k < half ? k : 0 };
+        const unsigned int b { k > 0 ? half - k : 0 };
+        const float evenRe { 0.5f * (workRe[a] + workRe[b]) };
+        const float evenIm { 0.5f * (workIm[a] - workIm[b]) };
+        const float oddRe { 0.5f * (workIm[a] + workIm[b]) };
+        const float oddIm { -0.5f * (workRe[a] - workRe[b]) };
+        outputRe[k] = evenRe + splitRe[k] * oddRe - splitIm[k] * oddIm;
+        outputIm[k] = evenIm + splitRe[k] * oddIm + splitIm[k] * oddRe;
+    }
+}
+
+void FFT::inverse(const float* inputRe, const float* inputIm, float* output)
+{
+    // Rebuild the packed spectrum, conjugated so the forward transform inverts it
+    for (unsigned int k = 0; k < half; ++k)
+    {
+        const float diffRe { inputRe[k] - inputRe[half - k] };
+        const float diffIm { inputIm[k] + inputIm[half - k] };
+        const float evenRe { inputRe[k] + inputRe[half - k] };
+        const float evenIm { inputIm[k] - inputIm[half - k] };
+        const float oddRe { diffRe * splitRe[k] + diffIm * splitIm[k] };
+        const float oddIm { diffIm * splitRe[k] - diffRe * splitIm[k] };
+        workRe[bitReverse[k]] = evenRe - oddIm;
+        workIm[bitReverse[k]] = -(evenIm + oddRe);
+    }
+
+    transform(workRe.data(), workIm.data());
+
+    for (unsigned int m = 0; m < half; ++m)
+    {
+        output[2 * m] = workRe[m];
+        output[2 * m + 1] = -workIm[m];
+    }
+}
+
+void FFT::transform(float* re, float* im) const
+{
+    for (unsigned int span = 1; span < half; span <<= 1)
+    {
+        const float* const wRe { twiddleRe.data() + span - 1 };
+        const float* const wIm { twiddleIm.data() + span - 1 };
+
+        for (unsigned int start = 0; start < half; start += 2 * span)
+        {
+            float* const aRe { re + start };
+            float* const aIm { im + start };
+            float* const bRe { re + start + span };
+            float* const bIm { im + start + span };
+
+            for (unsigned int k = 0; k < span; ++k)
+            {
+                const float tRe { bRe[k] * wRe[k] - bIm[k] * wIm[k] };
+                const float tIm { bRe[k] * wIm[k] + bIm[k] * wRe[k] };
+                bRe[k] = aRe[k] - tRe;
+                bIm[k] = aIm[k] - tIm;
+                aRe[k] += tRe;
+                aIm[k] += tIm;
+            }
+        }
+    }
+}
+
+}
\ No newline at end of file
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <vector>
+
+namespace DSP
+{
+
+// Real-input radix-2 FFT, computed as a complex FFT of half the size.
+// Spectra are stored as split real and imaginary arrays of getNumBins() bins,
+// from DC up to Nyquist. The tables and the work buffer are allocated at
+// construction, so forward() and inverse() never allocate.
+class FFT
+{
+public:
+    // Transform size is 2^initOrder samples, at least 4
+    FFT(unsigned int initOrder);
+    ~FFT();
+
+    // No default ctor
+    FFT() = delete;
+
+    // No copy semantics
+    FFT(const FFT&) = delete;
+    const FFT& operator=(const FFT&) = delete;
+
+    // No move semantics
+    FFT(FFT&&) = delete;
+    const FFT& operator=(FFT&&) = delete;
+
+    // Transform getSize() real samples into getNumBins() complex bins
+    void forward(const float* input, float* outputRe, float* outputIm);
+
+    // Transform getNumBins() complex bins back into getSize() real samples
+    // The output is not normalized, it is scaled by getSize()
+    void inverse(const float* inputRe, const float* inputIm, float* output);
+
+    unsigned int getSize() const { return size; }
+    unsigned int getNumBins() const { return half + 1; }
+
+private:
+    // In place complex FFT of half samples, the input in bit reversed order
+    void transform(float* re, float* im) const;
+
+    const unsigned int size;
+    const unsigned int half;
+
+    // exp(-pi i k / span) for every butterfly span of the complex FFT
+    std::vector<float> twiddleRe;
+    std::vector<float> twiddleIm;
+    // exp(-2 pi i k / size) to split the packed spectrum, k <= half
+    std::vector<float> splitRe;
+    std::vector<float> splitIm;
+    std::vector<unsigned int> bitReverse;
+
+    // Packed complex signal of the current transform
+    std::vector<float> workRe;
+    std::vector<float> workIm;
+};
+
+}
\ No newline at end of file
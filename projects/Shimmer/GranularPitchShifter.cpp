@@ -9,22 +9,35 @@ GranularPitchShifter::GranularPitchShifter(float blockSizeMs, unsigned int numCh
     : blockSizeMs(blockSizeMs), numChannels(numChannels)
 {
     delayBuffer.resize(numChannels);
-    window.clear(); // to be generated in prepare()
+
+    // Hann window, two grains half a grain apart always sum to one
+    const double pi { std::acos(-1.0) };
+    window.resize(WindowSize + 1);
+    for (unsigned int i = 0; i <= WindowSize; ++i)
+    {
+        const double s { std::sin(pi * static_cast<double>(i) / static_cast<double>(WindowSize)) };
+        window[i] = static_cast<float>(s * s);
+    }
 }
 
 void GranularPitchShifter::prepare(double newSampleRate)
 {
     sampleRate = newSampleRate;
 
-    bufferSize = static_cast<unsigned int>(std::ceil(sampleRate)); // 1-second buffer
-    blockSizeSamples = static_cast<unsigned int>(std::ceil(blockSizeMs * 0.001 * sampleRate));
-    fracBlockSizeSamples = blockSizeSamples / 4;
+    blockSizeSamples = std::max(static_cast<unsigned int>(std::ceil(blockSizeMs * 0.001 * sampleRate)), 1u);
+
+    // Longest read distance plus one chunk written ahead of the reads
+    const unsigned int minBufferSize { blockSizeSamples + static_cast<unsigned int>(MinDelaySamples) + 2u + ChunkSamples };
+    unsigned int bufferSize { 1u };
+    while (bufferSize < minBufferSize)
+        bufferSize <<= 1;
+    bufferMask = bufferSize - 1u;
 
     for (auto& buf : delayBuffer)
-        buf.resize(bufferSize, 0.0f);
+        buf.assign(bufferSize, 0.0f);
 
-    window.resize(blockSizeSamples);
-    writeIndex = 0;
+    setPitchRatio(pitchRatio);
+    clear();
 }
 
 void GranularPitchShifter::clear()
@@ -32,65 +45,94 @@ void GranularPitchShifter::clear()
     for (auto& buf : delayBuffer)
         std::fill(buf.begin(), buf.end(), 0.0f);
     writeIndex = 0;
+    grainPhase = 0.0f;
 }
 
 void GranularPitchShifter::setPitchRatio(float ratio)
 {
     pitchRatio = ratio;
+
+    // The read delay of a grain sweeps its length at (1 - ratio) samples per sample
+    phaseIncrement = (1.0f - pitchRatio) / static_cast<float>(std::max(blockSizeSamples, 1u));
 }
 
-float GranularPitchShifter::readInterpolated(const std::vector<float>& buffer, float position) const
+float GranularPitchShifter::getWindow(float phase) const
 {
-    int index1 = static_cast<int>(std::floor(position)) % bufferSize;
-    int index2 = (index1 + 1) % bufferSize;
-    float frac = position - std::floor(position);
+    const float position { phase * static_cast<float>(WindowSize) };
+    const unsigned int index { std::min(static_cast<unsigned int>(position), WindowSize - 1u) };
+    const float frac { position - static_cast<float>(index) };
 
-    return (1.0f - frac) * buffer[index1] + frac * buffer[index2];
+    return window[index] + frac * (window[index + 1] - window[index]);
 }
 
-void GranularPitchShifter::process(float* const* output, const float* const* input, unsigned int numChannels, unsigned int numSamples)
+void GranularPitchShifter::computeTaps(GrainTaps& taps, unsigned int numSamples)
 {
-    // Step 1: Write input samples to delay buffer
+    const float grainSize { static_cast<float>(blockSizeSamples) };
+
     for (unsigned int n = 0; n < numSamples; ++n)
     {
-        for (unsigned int ch = 0; ch < numChannels; ++ch)
-        {
-            delayBuffer[ch][writeIndex] = input[ch][n];
-        }
-
-        writeIndex = (writeIndex + 1) % bufferSize;
+        const float phase1 { grainPhase };
+        const float phase2 { phase1 < 0.5f ? phase1 + 0.5f : phase1 - 0.5f };
+
+        // Read delay relative to the write position of this sample
+        const float delay1 { MinDelaySamples + phase1 * grainSize };
+        const float delay2 { MinDelaySamples + phase2 * grainSize };
+        const unsigned int delayInt1 { static_cast<unsigned int>(delay1) };
+        const unsigned int delayInt2 { static_cast<unsigned int>(delay2) };
+
+        taps.index1[n] = writeIndex + n - delayInt1;
+        taps.index2[n] = writeIndex + n - delayInt2;
+        taps.frac1[n] = delay1 - static_cast<float>(delayInt1);
+        taps.frac2[n] = delay2 - static_cast<float>(delayInt2);
+        taps.gain1[n] = getWindow(phase1);
+        taps.gain2[n] = getWindow(phase2);
+
+        // Advance and wrap the grain phase
+        grainPhase += phaseIncrement;
+        grainPhase -= std::floor(grainPhase);
     }
+}
 
-    // Step 2: Read and overlap two grains with interpolation and Hann blending
-    for (unsigned int ch = 0; ch < numChannels; ++ch)
-    {
-        auto& buf = delayBuffer[ch];
-        float* out = output[ch];
-
-        // Use a safe offset from write head
-        float safeDelay = static_cast<float>(2 * blockSizeSamples);
-        float readBase1 = fmodf(static_cast<float>(writeIndex + bufferSize) - safeDelay, bufferSize);
-        float readBase2 = fmodf(readBase1 + fracBlockSizeSamples * pitchRatio, bufferSize);
+void GranularPitchShifter::process(float* const* output, const float* const* input, unsigned int numChannels, unsigned int numSamples)
+{
+    numChannels = std::min(numChannels, static_cast<unsigned int>(delayBuffer.size()));
 
-        for (unsigned int n = 0; n < numSamples; ++n)
-        {
-            float grainOffset = static_cast<float>(n) * pitchRatio;
-            float pos1 = fmodf(readBase1 + grainOffset, bufferSize);
-            float pos2 = fmodf(readBase2 + grainOffset, bufferSize);
+    GrainTaps taps;
 
-            float phase = static_cast<float>(n) / static_cast<float>(numSamples);
+    for (unsigned int start = 0; start < numSamples; start += ChunkSamples)
+    {
+        const unsigned int chunk { std::min(numSamples - start, ChunkSamples) };
 
-            float sample1 = readInterpolated(buf, pos1);
-            float sample2 = readInterpolated(buf, pos2);
+        // Step 1: Write input samples to delay buffer, before the reads so in-place processing is safe
+        for (unsigned int ch = 0; ch < numChannels; ++ch)
+        {
+            float* buf { delayBuffer[ch].data() };
+            for (unsigned int n = 0; n < chunk; ++n)
+                buf[(writeIndex + n) & bufferMask] = input[ch][start + n];
+        }
 
-            // out[n] = 0.5f * (sample1 + sample2); // Equal-blend crossfade
-            // Crossfade phase in [0, 1]
-            float fade1 = std::sin(halfPi * phase);
-            float fade2  = std::cos(halfPi * phase);
-            out[n] = 0.5 * (sample1 * fade1 + sample2 * fade2);
+        // Step 2: Grain taps are the same for all channels
+        computeTaps(taps, chunk);
 
+        // Step 3: Read and overlap two grains with interpolation and Hann blending
+        for (unsigned int ch = 0; ch < numChannels; ++ch)
+        {
+            const float* buf { delayBuffer[ch].data() };
+            float* out { output[ch] + start };
+
+            for (unsigned int n = 0; n < chunk; ++n)
+            {
+                const float sample1 { (1.0f - taps.frac1[n]) * buf[taps.index1[n] & bufferMask]
+                                      + taps.frac1[n] * buf[(taps.index1[n] - 1u) & bufferMask] };
+                const float sample2 { (1.0f - taps.frac2[n]) * buf[taps.index2[n] & bufferMask]
+                                      + taps.frac2[n] * buf[(taps.index2[n] - 1u) & bufferMask] };
+
+                out[n] = taps.gain1[n] * sample1 + taps.gain2[n] * sample2;
+            }
         }
+
+        writeIndex = (writeIndex + chunk) & bufferMask;
     }
 }
 
-} // namespace DSP
+} // namespace DSP
\ No newline at end of file
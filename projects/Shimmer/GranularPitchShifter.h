@@ -16,6 +16,7 @@ public:
     void prepare(double sampleRate);
 
     // Process audio buffers: input -> output (per-channel, interleaved)
+    // Grains run continuously across calls, the output does not depend on the block size
     void process(float* const* output, const float* const* input, unsigned int numChannels, unsigned int numSamples);
 
     // Set pitch ratio: 1.0 = no shift, >1.0 = pitch up, <1.0 = pitch down
@@ -24,24 +25,43 @@ public:
     // Clear delay buffers and internal state
     void clear();
 
+    // Number of segments of the grain window table
+    static constexpr unsigned int WindowSize { 1024 };
+    // Number of samples whose grain taps are computed in one go
+    static constexpr unsigned int ChunkSamples { 64 };
+    // Shortest read distance from the write head in samples
+    static constexpr float MinDelaySamples { 2.f };
+
 private:
+    // Read taps of the two grains for each sample of a chunk, shared by all channels
+    struct GrainTaps
+    {
+        unsigned int index1[ChunkSamples];
+        unsigned int index2[ChunkSamples];
+        float frac1[ChunkSamples];
+        float frac2[ChunkSamples];
+        float gain1[ChunkSamples];
+        float gain2[ChunkSamples];
+    };
+
+    // Compute the read taps of numSamples samples and advance the grain phase
+    void computeTaps(GrainTaps& taps, unsigned int numSamples);
+
+    // Interpolated lookup of the window table, phase in [0, 1)
+    float getWindow(float phase) const;
+
     std::vector<std::vector<float>> delayBuffer; // Per-channel circular delay buffer
-    std::vector<float> window;                  // Hann window
+    std::vector<float> window;                  // Hann window table, WindowSize + 1 points
 
     unsigned int writeIndex { 0 };              // Write head index
-    unsigned int bufferSize { 0 };              // Total delay buffer size (in samples)
+    unsigned int bufferMask { 0 };              // Delay buffer size is a power of two, indices wrap with this mask
     unsigned int blockSizeSamples { 0 };        // Grain size (in samples)
     float blockSizeMs { 0.0f };                 // Grain size (in milliseconds)
-    unsigned int fracBlockSizeSamples { 0 };    // For overlapping grains
     float pitchRatio { 1.0f };                  // Playback rate of grains
+    float grainPhase { 0.0f };                  // Phase of the first grain in [0, 1), the second one is half a grain apart
+    float phaseIncrement { 0.0f };              // Grain phase advance per sample
     double sampleRate { 48000.0 };              // Sample rate
     unsigned int numChannels { 0 };             // Number of audio channels
-
-
-    const float halfPi = M_PI / 2.0f;
-
-    // Linear interpolation read from fractional delay position
-    float readInterpolated(const std::vector<float>& buffer, float position) const;
 };
 
-} // namespace DSP
+} // namespace DSP
\ No newline at end of file
@@ -0,0 +1,117 @@
+#include "ImpulseResponseCache.h"
+
+#include <cstring>
+#include <limits>
+
+namespace DSP
+{
+
+namespace
+{
+
+uint64_t alignUp(uint64_t offset, uint64_t alignment)
+{
+    return (offset + alignment - 1) / alignment * alignment;
+}
+
+}
+
+ImpulseResponseCache::ImpulseResponseCache(const void* initData, size_t initSize) :
+    data { static_cast<const unsigned char*>(initData) },
+    size { initSize }
+{
+    // Header and entries are read in place, so the data has to be aligned for them
+    if (data == nullptr || size < sizeof(Header) || reinterpret_cast<uintptr_t>(data) % alignof(Entry) != 0)
+        return;
+
+    const Header& header { *reinterpret_cast<const Header*>(data) };
+    if (std::memcmp(header.magic, Magic, sizeof(Magic)) != 0 || header.version != Version || !(header.sampleRate > 0.0))
+        return;
+
+    if (header.entriesOffset % alignof(Entry) != 0 || header.entriesOffset > size
+        || header.numEntries > (size - header.entriesOffset) / sizeof(Entry))
+        return;
+
+    const Entry* entries { reinterpret_cast<const Entry*>(data + header.entriesOffset) };
+    for (uint32_t i = 0; i < header.numEntries; ++i)
+    {
+        const Entry& entry { entries[i] };
+        const uint64_t bytes { static_cast<uint64_t>(entry.numChannels) * entry.numSamples * sizeof(float) };
+        if (entry.numChannels == 0 || entry.dataOffset % alignof(float) != 0
+            || entry.dataOffset > size || bytes > size - entry.dataOffset)
+            return;
+    }
+
+    valid = true;
+}
+
+ImpulseResponseCache::~ImpulseResponseCache()
+{
+}
+
+double ImpulseResponseCache::getSampleRate() const
+{
+    return valid ? reinterpret_cast<const Header*>(data)->sampleRate : 0.0;
+}
+
+unsigned int ImpulseResponseCache::getNumEntries() const
+{
+    return valid ? reinterpret_cast<const Header*>(data)->numEntries : 0u;
+}
+
+const ImpulseResponseCache::Entry& ImpulseResponseCache::getEntry(unsigned int index) const
+{
+    const Header& header { *reinterpret_cast<const Header*>(data) };
+    return reinterpret_cast<const Entry*>(data + header.entriesOffset)[index];
+}
+
+const float* ImpulseResponseCache::getChannel(unsigned int index, unsigned int channel) const
+{
+    const Entry& entry { getEntry(index) };
+    return reinterpret_cast<const float*>(data + entry.dataOffset) + static_cast<size_t>(channel) * entry.numSamples;
+}
+
+int ImpulseResponseCache::findNearest(Reverb reverb, float decay, float brightness, float damping) const
+{
+    int nearest { -1 };
+    float nearestDistance { std::numeric_limits<float>::max() };
+
+    for (unsigned int i = 0; i < getNumEntries(); ++i)
+    {
+        const Entry& entry { getEntry(i) };
+        if (entry.reverb != reverb)
+            continue;
+
+        const float distance { (entry.decay - decay) * (entry.decay - decay)
+                               + (entry.brightness - brightness) * (entry.brightness - brightness)
+                               + (entry.damping - damping) * (entry.damping - damping) };
+        if (distance < nearestDistance)
+        {
+            nearest = static_cast<int>(i);
+            nearestDistance = distance;
+        }
+    }
+
+    return nearest;
+}
+
+uint64_t ImpulseResponseCache::layout(Header& header, std::vector<Entry>& entries)
+{
+    std::memcpy(header.magic, Magic, sizeof(Magic));
+    header.version = Version;
+    header.numEntries = static_cast<uint32_t>(entries.size());
+    header.entriesOffset = alignUp(sizeof(Header), alignof(Entry));
+
+    uint64_t offset { header.entriesOffset + entries.size() * sizeof(Entry) };
+    for (Entry& entry : entries)
+    {
+        entry.reserved = 0;
+        entry.reserved2 = 0.f;
+        entry.dataOffset = alignUp(offset, DataAlignment);
+        offset = entry.dataOffset + static_cast<uint64_t>(entry.numChannels) * entry.numSamples * sizeof(float);
+    }
+
+    return offset;
+}
+
+}
\ No newline at end of file
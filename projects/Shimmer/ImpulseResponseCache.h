@@ -0,0 +1,93 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace DSP
+{
+
+// Binary file of impulse responses of the algorithmic reverbs, one per parameter grid point,
+// written by the shimmer_ir_capture tool. The file is laid out to be memory mapped and read
+// in place: a Header, numEntries Entry records, then the samples of every entry, channel
+// after channel as 32 bit floats, each entry starting on a DataAlignment byte boundary.
+// All fields are stored in the byte order of the machine that wrote the file, readers on
+// the other byte order see a wrong magic and reject the file.
+class ImpulseResponseCache
+{
+public:
+    // Reverb a response was captured from
+    enum Reverb : uint32_t
+    {
+        Dattorro = 0,
+        KeithBarr
+    };
+
+    struct Header
+    {
+        char magic[8];
+        uint32_t version;
+        uint32_t numEntries;
+        double sampleRate;
+        uint64_t entriesOffset;
+    };
+
+    struct Entry
+    {
+        uint32_t reverb;
+        uint32_t numChannels;
+        uint32_t numSamples;
+        uint32_t reserved;
+        // Parameters of the grid point, zero for parameters the reverb does not have
+        float decay;
+        float brightness;
+        float damping;
+        float reserved2;
+        // Byte offset of the samples from the start of the file
+        uint64_t dataOffset;
+    };
+
+    // View over a cache in memory, usually a memory mapped file, the data is not copied
+    // and must outlive the view
+    ImpulseResponseCache(const void* initData, size_t initSize);
+    ~ImpulseResponseCache();
+
+    // No default ctor
+    ImpulseResponseCache() = delete;
+
+    // No copy semantics
+    ImpulseResponseCache(const ImpulseResponseCache&) = delete;
+    const ImpulseResponseCache& operator=(const ImpulseResponseCache&) = delete;
+
+    // No move semantics
+    ImpulseResponseCache(ImpulseResponseCache&&) = delete;
+    const ImpulseResponseCache& operator=(ImpulseResponseCache&&) = delete;
+
+    // True if the header and every entry lie within the data
+    bool isValid() const { return valid; }
+
+    double getSampleRate() const;
+    unsigned int getNumEntries() const;
+    const Entry& getEntry(unsigned int index) const;
+
+    // Samples of one channel of an entry
+    const float* getChannel(unsigned int index, unsigned int channel) const;
+
+    // Index of the entry of a reverb closest to the given parameters, -1 if there is none
+    int findNearest(Reverb reverb, float decay, float brightness, float damping) const;
+
+    // Fill the magic, version and entry table offset of a header and the data offsets of
+    // the entries, whose reverb, size and parameters are set. Returns the file size.
+    static uint64_t layout(Header& header, std::vector<Entry>& entries);
+
+    static constexpr char Magic[8] { 'S', 'H', 'I', 'M', 'I', 'R', 'C', '\0' };
+    static constexpr uint32_t Version { 1 };
+    static constexpr uint64_t DataAlignment { 64 };
+
+private:
+    const unsigned char* data;
+    const size_t size;
+    bool valid { false };
+};
+
+}
\ No newline at end of file
@@ -1,5 +1,8 @@
 #include "KeithBarrReverb.h"
 
+#include <algorithm>
+#include <cmath>
+
 namespace DSP
 {
 
@@ -18,11 +21,11 @@ KeithBarrReverb::KeithBarrReverb(
     ringAllPass_2(ringDelayMs_2, AllPassCoeff, 1u),
     ringAllPass_3(ringDelayMs_3, AllPassCoeff, 1u),
     ringAllPass_4(ringDelayMs_4, AllPassCoeff, 1u),
-    // initialize delay lines (stereo output)
-    delay_1(static_cast<unsigned int>(delayMs_1 * static_cast<float>(0.001 * sampleRate)), 1u),
-    delay_2(static_cast<unsigned int>(delayMs_2 * static_cast<float>(0.001 * sampleRate)), 1u),
-    delay_3(static_cast<unsigned int>(delayMs_3 * static_cast<float>(0.001 * sampleRate)), 1u),
-    delay_4(static_cast<unsigned int>(delayMs_4 * static_cast<float>(0.001 * sampleRate)), 1u),
+    // initialize delay lines (stereo output), sized for the highest supported sample rate
+    delay_1(static_cast<unsigned int>(delayMs_1 * static_cast<float>(0.001 * DSP::DelayLine::MaxSampleRate)), 1u),
+    delay_2(static_cast<unsigned int>(delayMs_2 * static_cast<float>(0.001 * DSP::DelayLine::MaxSampleRate)), 1u),
+    delay_3(static_cast<unsigned int>(delayMs_3 * static_cast<float>(0.001 * DSP::DelayLine::MaxSampleRate)), 1u),
+    delay_4(static_cast<unsigned int>(delayMs_4 * static_cast<float>(0.001 * DSP::DelayLine::MaxSampleRate)), 1u),
     // dampling filters
     dampingCoeff { initDampingCoeff }
 {
@@ -82,14 +85,101 @@ void KeithBarrReverb::clear()
     feedbackState_2 = 0.f;
     feedbackState_3 = 0.f;
     feedbackState_4 = 0.f;
-    // Reset damping coefficents
-    dampingCoeff = 0.5f;
 }
 
 void KeithBarrReverb::process(float* const* output, const float* const* input, unsigned int numChannels, unsigned int numSamples)
+{
+    DSP::AllPass* const ringAllPass[NumBranches] { &ringAllPass_1, &ringAllPass_2, &ringAllPass_3, &ringAllPass_4 };
+    DSP::DelayLine* const delay[NumBranches] { &delay_1, &delay_2, &delay_3, &delay_4 };
+    float* const feedbackState[NumBranches] { &feedbackState_1, &feedbackState_2, &feedbackState_3, &feedbackState_4 };
+
+    // Every branch of the ring feeds back through its delay line, so while a chunk
+    // is not longer than the shortest delay the whole ring output of the chunk was
+    // written by previous chunks. Each branch then becomes a feedforward chain
+    // processed as contiguous blocks instead of sample by sample.
+    unsigned int maxChunk { RingChunkSamples };
+    for (unsigned int b = 0; b < NumBranches; ++b)
+    {
+        const unsigned int delaySamples { delay[b]->getDelaySamples() };
+        const unsigned int capacity { delay[b]->getCapacity() };
+        maxChunk = delaySamples < capacity ? std::min({ maxChunk, delaySamples, capacity - delaySamples }) : 0u;
+    }
+
+    if (maxChunk == 0)
+    {
+        processPerSample(output, input, numChannels, 0, numSamples);
+        return;
+    }
+
+    for (unsigned int start = 0; start < numSamples;)
+    {
+        const unsigned int chunk { std::min(numSamples - start, maxChunk) };
+
+        // ---------- INPUT ALLPASS ----------
+        float mono[RingChunkSamples];
+        for (unsigned int n = 0; n < chunk; ++n)
+        {
+            // Join stereo channels to mono
+            const float left { input[0][start + n] };
+            const float right { (numChannels > 1) ? input[1][start + n] : input[0][start + n] };
+            mono[n] = 0.5f * (left + right);
+        }
+
+        float* monoPtr[1] { mono };
+        inputAllPass_1.process(monoPtr, monoPtr, 1u, chunk);
+        inputAllPass_2.process(monoPtr, monoPtr, 1u, chunk);
+        inputAllPass_3.process(monoPtr, monoPtr, 1u, chunk);
+        inputAllPass_4.process(monoPtr, monoPtr, 1u, chunk);
+
+        // ---------- RING ----------
+        // Read the delay outputs of the chunk upfront
+        float delayOut[NumBranches][RingChunkSamples];
+        for (unsigned int b = 0; b < NumBranches; ++b)
+            delay[b]->readBlock(0, delay[b]->getDelaySamples(), delayOut[b], chunk);
+
+        for (unsigned int b = 0; b < NumBranches; ++b)
+        {
+            // Each branch is fed by the damped output of the previous one,
+            // delayed by one sample
+            const unsigned int prev { (b + NumBranches - 1) % NumBranches };
+            const float* prevOut { delayOut[prev] };
+
+            float ringIn[RingChunkSamples];
+            ringIn[0] = mono[0] + *feedbackState[prev];
+            for (unsigned int n = 1; n < chunk; ++n)
+                ringIn[n] = mono[n] + prevOut[n - 1] * dampingCoeff;
+
+            // Ring all pass processing
+            float* ringPtr[1] { ringIn };
+            ringAllPass[b]->process(ringPtr, ringPtr, 1u, chunk);
+
+            // Delay line input
+            delay[b]->writeBlock(0, ringIn, chunk);
+        }
+
+        // Damping processing and update feedback state
+        for (unsigned int b = 0; b < NumBranches; ++b)
+        {
+            *feedbackState[b] = delayOut[b][chunk - 1] * dampingCoeff;
+            delay[b]->advanceWrite(chunk);
+        }
+
+        // Write to output buffers
+        for (unsigned int n = 0; n < chunk; ++n)
+        {
+            const float y { delayOut[0][n] + delayOut[1][n] + delayOut[2][n] + delayOut[3][n] };
+            for (unsigned int ch = 0; ch < numChannels; ++ch)
+                output[ch][start + n] = y;
+        }
+
+        start += chunk;
+    }
+}
+
+void KeithBarrReverb::processPerSample(float* const* output, const float* const* input, unsigned int numChannels, unsigned int startSample, unsigned int numSamples)
 {   
     // Sum the input channels to the first channel
-    for (unsigned int n = 0; n < numSamples; ++n)
+    for (unsigned int n = startSample; n < startSample + numSamples; ++n)
     {   
         // Preallocate output channels
         float out_left { 0.f };
@@ -101,10 +191,10 @@ void KeithBarrReverb::process(float* const* output, const float* const* input, u
         float mono { 0.5f * (left + right) };
 
         // ---------- INPUT ALLPASS ----------
-        inputAllPass_1.process(&mono, &mono, 1u);
-        inputAllPass_2.process(&mono, &mono, 1u);
-        inputAllPass_3.process(&mono, &mono, 1u);
-        inputAllPass_4.process(&mono, &mono, 1u);
+        inputAllPass_1.processSample<1>(&mono, &mono);
+        inputAllPass_2.processSample<1>(&mono, &mono);
+        inputAllPass_3.processSample<1>(&mono, &mono);
+        inputAllPass_4.processSample<1>(&mono, &mono);
 
         // ---------- RING ----------
 
@@ -120,16 +210,16 @@ void KeithBarrReverb::process(float* const* output, const float* const* input, u
         float output_4 = 0.f;
         
         // ring all pass processing
-        ringAllPass_1.process(&input_1, &input_1, 1u);
-        ringAllPass_2.process(&input_2, &input_2, 1u);
-        ringAllPass_3.process(&input_3, &input_3, 1u);
-        ringAllPass_4.process(&input_4, &input_4, 1u);   
+        ringAllPass_1.processSample<1>(&input_1, &input_1);
+        ringAllPass_2.processSample<1>(&input_2, &input_2);
+        ringAllPass_3.processSample<1>(&input_3, &input_3);
+        ringAllPass_4.processSample<1>(&input_4, &input_4);   
 
         // Delay line processing
-        delay_1.process(&output_1, &input_1, 1u);
-        delay_2.process(&output_2, &input_2, 1u);
-        delay_3.process(&output_3, &input_3, 1u);
-        delay_4.process(&output_4, &input_4, 1u);
+        delay_1.processSample<1>(&output_1, &input_1);
+        delay_2.processSample<1>(&output_2, &input_2);
+        delay_3.processSample<1>(&output_3, &input_3);
+        delay_4.processSample<1>(&output_4, &input_4);
 
         // Damping processing and update feedback state
         feedbackState_1 = output_1 * dampingCoeff;
@@ -150,4 +240,31 @@ void KeithBarrReverb::setDampingCoeff(float newCoeff)
 {
     dampingCoeff = std::clamp(newCoeff, 0.0f, 0.9f);
 }
+
+void KeithBarrReverb::setDenormalSafe(bool enabled)
+{
+    // The ring feedback passes through the ring allpasses, which covers it too
+    inputAllPass_1.setDenormalSafe(enabled);
+    inputAllPass_2.setDenormalSafe(enabled);
+    inputAllPass_3.setDenormalSafe(enabled);
+    inputAllPass_4.setDenormalSafe(enabled);
+    ringAllPass_1.setDenormalSafe(enabled);
+    ringAllPass_2.setDenormalSafe(enabled);
+    ringAllPass_3.setDenormalSafe(enabled);
+    ringAllPass_4.setDenormalSafe(enabled);
+}
+
+double KeithBarrReverb::getTailLengthSeconds() const
+{
+    const double feedforwardMs { inputDiffDelayMs_1 + inputDiffDelayMs_2 + inputDiffDelayMs_3 + inputDiffDelayMs_4 };
+    // Every branch feeds the next one, one trip around the ring goes through all of them
+    const double loopMs { ringDelayMs_1 + delayMs_1 + ringDelayMs_2 + delayMs_2
+                        + ringDelayMs_3 + delayMs_3 + ringDelayMs_4 + delayMs_4 };
+
+    double numLoops { 1.0 };
+    if (dampingCoeff > 0.f)
+        numLoops = std::max(-60.0 / (20.0 * NumBranches * std::log10(static_cast<double>(dampingCoeff))), 1.0);
+
+    return 0.001 * (feedforwardMs + numLoops * loopMs);
+}
 }
\ No newline at end of file
@@ -31,14 +31,26 @@ public:
     void clear();
 
     // Prepare method
+    // The delay memory is allocated once at construction for rates up to
+    // DSP::DelayLine::MaxSampleRate, so switching rates only changes delay lengths
     void prepare(double newSampleRate, unsigned int newNumChannels);
 
     // Process block of audio without modulation
     void process(float* const*  output, const float* const* input, unsigned int numChannels, unsigned int numSamples);
 
+    // Process block of audio one sample at a time through every branch
+    // Reference for the chunked ring in process(), both give identical output
+    void processPerSample(float* const* output, const float* const* input, unsigned int numChannels, unsigned int startSample, unsigned int numSamples);
+
     // ==================================================
     void setDampingCoeff(float newCoeff);
 
+    // Keep the allpass recursions out of the denormal range, on by default
+    void setDenormalSafe(bool enabled);
+
+    // Time for the output to decay by 60dB after the input stops
+    double getTailLengthSeconds() const;
+
     // ==================================================
     // Constants for the Keith Barr Reverb algorithm
     // Number of channels
@@ -64,6 +76,11 @@ public:
     // feedback / feedforward coefficients
     static constexpr float AllPassCoeff {  0.5f };
 
+    // Number of allpass / delay branches in the ring
+    static constexpr unsigned int NumBranches { 4 };
+    // Maximum chunk length of the ring block processing
+    static constexpr unsigned int RingChunkSamples { 64 };
+
 
 private:
     double sampleRate { 48000.0 };
@@ -34,29 +34,38 @@ void LeakyIntegrator::setCoeff(float newCoeff)
     coeffRamp.setTarget(coeff);
 }
 
+void LeakyIntegrator::setDenormalSafe(bool enabled)
+{
+    antiDenormal = enabled ? AntiDenormalOffset : 0.f;
+}
+
 void LeakyIntegrator::process(float* const* output, const float* const* input, unsigned int numChannels, unsigned int numSamples)
 {    
+    if (numChannels == 1)
+        processBlock<1>(output, input, numSamples);
+    else if (numChannels >= MaxChannels)
+        processBlock<MaxChannels>(output, input, numSamples);
+}
 
+template <unsigned int N>
+void LeakyIntegrator::processBlock(float* const* output, const float* const* input, unsigned int numSamples)
+{
     for (unsigned int n = 0; n < numSamples; ++n)
     {
-        float toOutput[2] { 0.f, 0.f };
-        for (unsigned int ch = 0; ch < numChannels; ++ch)
+        for (unsigned int ch = 0; ch < N; ++ch)
         {
             output[ch][n] = coeffRamp.getNext() * input[ch][n] + (1.f - coeffRamp.getNext()) * feedbackState[ch];
-            feedbackState[ch] = output[ch][n];
+            feedbackState[ch] = output[ch][n] + antiDenormal;
         }
     }
-
 }
 
 void LeakyIntegrator::process(float* output, const float* input, unsigned int numChannels)
 {
-    for (unsigned int ch = 0; ch < numChannels; ++ch)
-    {
-        output[ch] = coeffRamp.getNext() * input[ch] + (1.f - coeffRamp.getNext()) * feedbackState[ch];
-        feedbackState[ch] = output[ch];
-    }
-
+    if (numChannels == 1)
+        processSample<1>(output, input);
+    else if (numChannels >= MaxChannels)
+        processSample<MaxChannels>(output, input);
 }
 
 }
\ No newline at end of file
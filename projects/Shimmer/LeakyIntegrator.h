@@ -1,6 +1,7 @@
 #pragma once
 
 #include "Ramp.h"
+#include "Denormals.h"
 
 namespace DSP
 {
@@ -30,19 +31,46 @@ public:
     // Set new coefficient
     void setCoeff(float newCoeff);
 
+    // Add a tiny offset to the stored state, so decaying tails never turn into denormals
+    // even when flush-to-zero is off, the output is left as is, on by default
+    void setDenormalSafe(bool enabled);
+
     // Process block of audio 
     void process(float* const* output, const float* const* input, unsigned int numChannels, unsigned int numSamples);
 
     // Process single sample of audio
     void process(float* output, const float* input, unsigned int numChannels);
+
+    // Fixed channel count flavour of the single-sample processing, the channel loop unrolls
+    template <unsigned int N>
+    void processSample(float* output, const float* input);
     // ======================
 
+    static constexpr unsigned int MaxChannels { 2 };
+
 private:
+    // Block processing with a fixed channel count
+    template <unsigned int N>
+    void processBlock(float* const* output, const float* const* input, unsigned int numSamples);
+
     DSP::Ramp<float> coeffRamp;
     float coeff;
+    float antiDenormal { AntiDenormalOffset };
 
     // one state per channel
-    float feedbackState[2] { 0.f, 0.f };
+    float feedbackState[MaxChannels] { };
 };
 
+template <unsigned int N>
+void LeakyIntegrator::processSample(float* output, const float* input)
+{
+    static_assert(N <= MaxChannels, "Too many channels");
+
+    for (unsigned int ch = 0; ch < N; ++ch)
+    {
+        output[ch] = coeffRamp.getNext() * input[ch] + (1.f - coeffRamp.getNext()) * feedbackState[ch];
+        feedbackState[ch] = output[ch] + antiDenormal;
+    }
+}
+
 }
\ No newline at end of file
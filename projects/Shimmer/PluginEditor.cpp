@@ -6,7 +6,7 @@ ShimmerAudioProcessorEditor::ShimmerAudioProcessorEditor(ShimmerAudioProcessor&
     main(
         audioProcessor.getParameterManager(),
         paramHeight,
-        { Param::ID::Enabled, Param::ID::Mix }
+        { Param::ID::Enabled, Param::ID::Mix, Param::ID::Convolution }
     ),
     pitchShifter(
         audioProcessor.getParameterManager(),
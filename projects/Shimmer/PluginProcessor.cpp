@@ -3,6 +3,18 @@
 
 #include <algorithm>
 
+// Peak absolute value across channels
+static float getPeakLevel(const float* const* buffers, unsigned int numChannels, unsigned int numSamples)
+{
+    float peak { 0.f };
+    for (unsigned int ch = 0; ch < numChannels; ++ch)
+    {
+        const auto range { juce::FloatVectorOperations::findMinAndMax(buffers[ch], static_cast<int>(numSamples)) };
+        peak = std::max({ peak, -range.getStart(), range.getEnd() });
+    }
+    return peak;
+}
+
 static const std::vector<mrta::ParameterInfo> Parameters
 {
     { Param::ID::Enabled,    Param::Name::Enabled,    Param::Ranges::EnabledOff,   Param::Ranges::EnabledOn, Param::Ranges::EnabledDefault },
@@ -18,21 +30,23 @@ static const std::vector<mrta::ParameterInfo> Parameters
     { Param::ID::Brightness, Param::Name::Brightness, "",                Param::Ranges::BrightnessDefault, Param::Ranges::BrightnessMin, Param::Ranges::BrightnessMax, Param::Ranges::BrightnessInc, Param::Ranges::BrightnessSkw },
     // Jon Dattorro's reverb parameters
     { Param::ID::Decay,      Param::Name::Decay,      "",                Param::Ranges::DecayDefault,      Param::Ranges::DecayMin,      Param::Ranges::DecayMax,      Param::Ranges::DecayInc,      Param::Ranges::DecaySkw },
+    // Convolution reverb parameters
+    { Param::ID::Convolution, Param::Name::Convolution, Param::Ranges::ConvolutionOff, Param::Ranges::ConvolutionOn, Param::Ranges::ConvolutionDefault },
 };
 
 ShimmerAudioProcessor::ShimmerAudioProcessor() :
-    parameterManager(*this, ProjectInfo::projectName, Parameters),
+    parameterManager(*this, ProjectInfo::projectName, Parameters, mrta::ParameterManager::Coalescing),
     enabled { Param::Ranges::EnabledDefault },
-    enableRamp(0.05f),
     mix { Param::Ranges::MixDefault },
-    mixRamp(0.05f),
+    // Dry/wet mix, the wet gain is the enable switch
+    outputMixer(Param::Ranges::MixDefault, Param::Ranges::EnabledDefault ? 1.f : 0.f),
     // Shimmer effect
     shimmer(Param::Ranges::BuildupMax, 5.f, 2),
     // Pitch shifter parameters
     shift1 { Param::Ranges::Shift1Default },
     shift2 { Param::Ranges::Shift2Default },
     amount { Param::Ranges::AmountDefault },
-    amountRamp(Param::Ranges::AmountDefault),
+    amountMixer(Param::Ranges::AmountDefault, 1.f, Param::Ranges::AmountDefault),
     buildUp { Param::Ranges::BuildupDefault },
     // Keith Barr's reverb effect
     KBReverb(MaxChannels, Param::Ranges::DampCoeffDefault),
@@ -48,7 +62,10 @@ ShimmerAudioProcessor::ShimmerAudioProcessor() :
     ),
     // Jon Dattorro's reverb parameters
     brightness { Param::Ranges::BrightnessDefault },
-    decay { Param::Ranges::DecayDefault }
+    decay { Param::Ranges::DecayDefault },
+    // Convolution reverb
+    convolutionReverb(MaxChannels),
+    convolution { Param::Ranges::ConvolutionDefault }
 {
     // Set the Parameteric Equalizer 
     eq.setBandType(0, static_cast<DSP::ParametricEqualizer::FilterType>(std::round(2)));    // Low Shelf
@@ -66,20 +83,20 @@ ShimmerAudioProcessor::ShimmerAudioProcessor() :
     [this](float newValue, bool force)
     {
         enabled = newValue > 0.5f;
-        enableRamp.setTarget(enabled ? 1.f : 0.f, force);
+        outputMixer.setWetGain(enabled ? 1.f : 0.f, force);
     });
     parameterManager.registerParameterCallback(Param::ID::Mix,
     [this](float newMix, bool /*force*/)
     {
         mix = std::clamp(newMix, Param::Ranges::MixMin, Param::Ranges::MixMax);
-        mixRamp.setTarget(mix);
+        outputMixer.setMix(mix);
     });
     // Pitch Shifter Parameters
     parameterManager.registerParameterCallback(Param::ID::Amount,
     [this] (float value, bool /*force*/)
     {
         amount = std::clamp(value, Param::Ranges::AmountMin, Param::Ranges::AmountMax);;
-        amountRamp.setTarget(amount);
+        amountMixer.setMix(amount);
     });
     parameterManager.registerParameterCallback(Param::ID::Buildup,
     [this] (float value, bool /*force*/)
@@ -113,6 +130,8 @@ ShimmerAudioProcessor::ShimmerAudioProcessor() :
     {
         brightness = std::clamp(newBrightness, Param::Ranges::BrightnessMin, Param::Ranges::BrightnessMax);
         dattorroReverb.setBrightness(brightness);
+        if (reverbBank != nullptr)
+            reverbBank->setBrightness(reverbBankLane, brightness);
     });
     // Jon Dattorro's reverb parameters
     parameterManager.registerParameterCallback(Param::ID::Decay,
@@ -120,6 +139,15 @@ ShimmerAudioProcessor::ShimmerAudioProcessor() :
     {
         decay = std::clamp(newDecay, Param::Ranges::DecayMin, Param::Ranges::DecayMax);
         dattorroReverb.setDecay(decay);
+        if (reverbBank != nullptr)
+            reverbBank->setDecay(reverbBankLane, decay);
+    });
+    // Convolution reverb parameters
+    parameterManager.registerParameterCallback(Param::ID::Convolution,
+    [this](float newValue, bool /*force*/)
+    {
+        // The reverb left behind is cleared by processBlock() while it does not run
+        convolution = newValue > 0.5f;
     });
 }
 
@@ -127,30 +155,40 @@ ShimmerAudioProcessor::~ShimmerAudioProcessor()
 {
 }
 
-void ShimmerAudioProcessor::prepareToPlay(double newSampleRate, int samplesPerBlock)
+void ShimmerAudioProcessor::prepareToPlay(double newSampleRate, int /*samplesPerBlock*/)
 {
     const unsigned int numChannels { static_cast<unsigned int>(std::max(getMainBusNumInputChannels(), getMainBusNumOutputChannels())) };
     sampleRate = std::max(newSampleRate, 1.0);
 
-    shimmer.prepare(sampleRate, Param::Ranges::BuildupMax, numChannels, samplesPerBlock);
+    // Host blocks are processed in fixed slices, so nothing depends on the announced block size
+    sliceSamples = isNonRealtime() ? MaxNonRealtimeProcessBlockSamples : MaxProcessBlockSamples;
+
+    shimmer.prepare(sampleRate, Param::Ranges::BuildupMax, numChannels, sliceSamples);
+    // Offline renders tend to use large blocks, run the two pitch shifters concurrently there
+    shimmer.setParallelEnabled(isNonRealtime());
     eq.prepare(sampleRate, numChannels);
     KBReverb.prepare(sampleRate, numChannels);
-    amountRamp.prepare(sampleRate, true, Param::Ranges::AmountDefault);
+    amountMixer.prepare(sampleRate);
     dattorroReverb.prepare(sampleRate, numChannels);
+    convolutionReverb.prepare(sampleRate);
 
-    enableRamp.prepare(sampleRate, true, enabled ? 1.f : 0.f);
-    mixRamp.prepare(sampleRate, true, mix);
+    outputMixer.prepare(sampleRate);
 
-    shimmerBuffer.setSize(static_cast<int>(numChannels), samplesPerBlock);
+    shimmerBuffer.setSize(static_cast<int>(numChannels), static_cast<int>(sliceSamples));
     shimmerBuffer.clear();
 
-    reverbBuffer.setSize(static_cast<int>(numChannels), samplesPerBlock);
+    reverbBuffer.setSize(static_cast<int>(numChannels), static_cast<int>(sliceSamples));
     reverbBuffer.clear();
 
-    dryBuffer.setSize(static_cast<int>(numChannels), samplesPerBlock);
-    dryBuffer.clear();
+    wetState = WetState::Running;
+    silentSamples = 0;
+    sleepHoldSamples = static_cast<unsigned int>(std::ceil(SleepHoldSeconds * sampleRate));
 
     parameterManager.updateParameters(true);
+
+    // Every engine was cleared by its prepare()
+    pendingClears = 0;
+    convolutionRunning = isConvolutionActive();
 }
 
 void ShimmerAudioProcessor::releaseResources()
@@ -159,47 +197,263 @@ void ShimmerAudioProcessor::releaseResources()
     eq.clear();
     KBReverb.clear();
     dattorroReverb.clear();
+    convolutionReverb.clear();
     shimmerBuffer.clear();
     reverbBuffer.clear();
-    dryBuffer.clear();
+    pendingClears = 0;
 }
 
 void ShimmerAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juce::MidiBuffer& /*midiMessages*/)
 {
     juce::ScopedNoDenormals noDenormals;
+    mrta::RealtimeScope realtimeScope("ShimmerAudioProcessor::processBlock");
+
+    const unsigned int numChannels { std::min({ static_cast<unsigned int>(buffer.getNumChannels()), static_cast<unsigned int>(reverbBuffer.getNumChannels()), MaxChannels }) };
+    const unsigned int numSamples { static_cast<unsigned int>(buffer.getNumSamples()) };
+    float* const* const bufferPtrs { buffer.getArrayOfWritePointers() };
+
+    // Slices also end at parameter changes, but never before minSubBlockSamples
+    parameterManager.beginBlock(static_cast<int>(numSamples));
+
+    float* io[MaxChannels];
+
+    for (unsigned int pos = 0; pos < numSamples;)
+    {
+        parameterManager.dispatchEvents(static_cast<int>(pos));
+
+        const int nextEvent { parameterManager.getNextEventOffset(static_cast<int>(pos + minSubBlockSamples)) };
+        const unsigned int end { std::min({ pos + sliceSamples, numSamples, static_cast<unsigned int>(nextEvent) }) };
+        const unsigned int n { end - pos };
+
+        for (unsigned int ch = 0; ch < numChannels; ++ch)
+            io[ch] = bufferPtrs[ch] + pos;
+
+        const float inputPeak { getPeakLevel(io, numChannels, n) };
+
+        // Wake up on audible wet changes or input
+        if ((wetState == WetState::Bypassed && !outputMixer.isWetMuted())
+            || (wetState == WetState::Sleeping && inputPeak >= SilenceThreshold))
+        {
+            wetState = WetState::Running;
+            silentSamples = 0;
+        }
+
+        if (wetState == WetState::Running)
+        {
+            // The reverb switched away from keeps its tail until it is cleared
+            if (isConvolutionActive() != convolutionRunning)
+            {
+                pendingClears |= convolutionRunning ? ClearConvolution : ClearDattorro;
+                convolutionRunning = !convolutionRunning;
+            }
+            if ((pendingClears & getRunningEngines()) != 0)
+                clearEngines(pendingClears & getRunningEngines());
+
+            processSliceBeforeReverb(io, numChannels, n);
+
+            // Add Dattorro reverb, or the convolution reverb in its place
+            if (convolutionRunning)
+            {
+                DSP::StageProfiler::Scope scope(profiler, DSP::StageProfiler::Convolution);
+                convolutionReverb.process(reverbBuffer.getArrayOfWritePointers(), reverbBuffer.getArrayOfReadPointers(), numChannels, n);
+            }
+            else
+            {
+                DSP::StageProfiler::Scope scope(profiler, DSP::StageProfiler::Dattorro);
+                dattorroReverb.process(reverbBuffer.getArrayOfWritePointers(), reverbBuffer.getArrayOfReadPointers(), numChannels, n);
+            }
+
+            const float wetPeak { getPeakLevel(reverbBuffer.getArrayOfReadPointers(), numChannels, n) };
+
+            processSliceAfterReverb(io, numChannels, n);
+
+            if (outputMixer.isWetMuted())
+            {
+                stopWetPath(WetState::Bypassed);
+            }
+            else if (inputPeak < SilenceThreshold && wetPeak < SilenceThreshold)
+            {
+                silentSamples += n;
+                if (silentSamples >= sleepHoldSamples)
+                    stopWetPath(WetState::Sleeping);
+            }
+            else
+            {
+                silentSamples = 0;
+            }
+        }
+        else
+        {
+            // The reverb buffer stays cleared while stopped
+            outputMixer.process(io, io, reverbBuffer.getArrayOfReadPointers(), numChannels, n);
+        }
+
+        pos = end;
+    }
+
+    // Clear at most one idle engine per block, the lowest pending one
+    const unsigned int idleClears { pendingClears & ~getRunningEngines() };
+    if (idleClears != 0)
+        clearEngines(idleClears & (~idleClears + 1u));
+
+    // Events within minSubBlockSamples of the last slice start, or of an empty block,
+    // apply from the next block on
+    parameterManager.endBlock();
+}
+
+void ShimmerAudioProcessor::stopWetPath(WetState newState)
+{
+    // The engines hold up to seconds of delay memory, clearing them all here would
+    // spike this block, they are cleared one per block from now on, or on restart
+    // Only the reverb that ran has a tail
+    pendingClears |= ClearBeforeReverb | (convolutionRunning ? ClearConvolution : ClearDattorro);
+    // The slice buffers are short, the reverb buffer stays cleared while stopped
+    shimmerBuffer.clear();
+    reverbBuffer.clear();
+
+    wetState = newState;
+    silentSamples = 0;
+}
+
+unsigned int ShimmerAudioProcessor::getRunningEngines() const
+{
+    if (wetState != WetState::Running)
+        return 0;
+
+    return ClearBeforeReverb | (convolutionRunning ? ClearConvolution : ClearDattorro);
+}
+
+void ShimmerAudioProcessor::clearEngines(unsigned int engines)
+{
+    if ((engines & ClearShimmer) != 0)
+        shimmer.clear();
+    if ((engines & ClearEqualizer) != 0)
+        eq.clear();
+    if ((engines & ClearKeithBarr) != 0)
+        KBReverb.clear();
+    if ((engines & ClearDattorro) != 0)
+        dattorroReverb.clear();
+    // The audio thread never waits for the convolution worker
+    if ((engines & ClearConvolution) != 0)
+        convolutionReverb.reset();
+
+    pendingClears &= ~engines;
+}
+
+void ShimmerAudioProcessor::setMinSubBlockSamples(unsigned int newMinSubBlockSamples)
+{
+    minSubBlockSamples = std::max(newMinSubBlockSamples, 1u);
+}
+
+void ShimmerAudioProcessor::processBlockBeforeReverb(juce::AudioBuffer<float>& buffer)
+{
+    juce::ScopedNoDenormals noDenormals;
+    mrta::RealtimeScope realtimeScope("ShimmerAudioProcessor::processBlockBeforeReverb");
+
     parameterManager.updateParameters();
 
-    const unsigned int numChannels { static_cast<unsigned int>(buffer.getNumChannels()) };
+    const unsigned int numChannels { std::min({ static_cast<unsigned int>(buffer.getNumChannels()), static_cast<unsigned int>(reverbBuffer.getNumChannels()), MaxChannels }) };
     const unsigned int numSamples { static_cast<unsigned int>(buffer.getNumSamples()) };
+    jassert(numSamples <= sliceSamples);
+
+    // processBlock() may have left a tail to clear before this chain runs
+    if ((pendingClears & ClearBeforeReverb) != 0)
+        clearEngines(pendingClears & ClearBeforeReverb);
+
+    processSliceBeforeReverb(buffer.getArrayOfWritePointers(), numChannels, std::min(numSamples, sliceSamples));
+
+    // Hand the reverb input to the shared bank, processed in place
+    if (reverbBank != nullptr)
+        reverbBank->setLaneBuffers(reverbBankLane, reverbBuffer.getArrayOfWritePointers(), numChannels);
+}
+
+void ShimmerAudioProcessor::processBlockAfterReverb(juce::AudioBuffer<float>& buffer)
+{
+    juce::ScopedNoDenormals noDenormals;
+    mrta::RealtimeScope realtimeScope("ShimmerAudioProcessor::processBlockAfterReverb");
 
-    for (int ch = 0; ch < static_cast<int>(numChannels); ++ch)
-    {
-        shimmerBuffer.copyFrom(ch, 0, buffer, ch, 0, static_cast<int>(numSamples));
-        reverbBuffer.copyFrom(ch, 0, buffer, ch, 0, static_cast<int>(numSamples));
-        dryBuffer.copyFrom(ch, 0, buffer, ch, 0, static_cast<int>(numSamples));
-    } 
-
-    shimmer.process(shimmerBuffer.getArrayOfWritePointers(), shimmerBuffer.getArrayOfReadPointers(), numChannels, numSamples);
-    eq.process(shimmerBuffer.getArrayOfWritePointers(), shimmerBuffer.getArrayOfReadPointers(), numChannels, numSamples);
-    KBReverb.process(shimmerBuffer.getArrayOfWritePointers(), shimmerBuffer.getArrayOfReadPointers(), numChannels, numSamples);
-    // Add KR reverb
-    amountRamp.applyGain(shimmerBuffer.getArrayOfWritePointers(), numChannels, numSamples);
-    // Input to Dattorro reverb
-    amountRamp.applyInverseGain(reverbBuffer.getArrayOfWritePointers(), numChannels, numSamples);
-    for (int ch = 0; ch < static_cast<int>(numChannels); ++ch)
-        reverbBuffer.addFrom(ch, 0, shimmerBuffer, ch, 0, static_cast<int>(numSamples));
-    // Add Dattorro reverb
-    dattorroReverb.process(reverbBuffer.getArrayOfWritePointers(), reverbBuffer.getArrayOfReadPointers(), numChannels, numSamples);
-    mixRamp.applyGain(reverbBuffer.getArrayOfWritePointers(), numChannels, numSamples);
-    enableRamp.applyGain(reverbBuffer.getArrayOfWritePointers(), numChannels, numSamples);
-    
-    // Add dry and wet signals
-    mixRamp.applyInverseGain(dryBuffer.getArrayOfWritePointers(), numChannels, numSamples);
-    for (int ch = 0; ch < static_cast<int>(numChannels); ++ch)
-    {
-        buffer.addFrom(ch, 0, dryBuffer, ch, 0, static_cast<int>(numSamples));
-        buffer.addFrom(ch, 0, reverbBuffer, ch, 0, static_cast<int>(numSamples));
+    const unsigned int numChannels { std::min({ static_cast<unsigned int>(buffer.getNumChannels()), static_cast<unsigned int>(reverbBuffer.getNumChannels()), MaxChannels }) };
+    const unsigned int numSamples { static_cast<unsigned int>(buffer.getNumSamples()) };
+    jassert(numSamples <= sliceSamples);
+
+    processSliceAfterReverb(buffer.getArrayOfWritePointers(), numChannels, std::min(numSamples, sliceSamples));
+}
+
+void ShimmerAudioProcessor::processSliceBeforeReverb(float* const* io, unsigned int numChannels, unsigned int numSamples)
+{
+    float* const* const shimmerPtrs { shimmerBuffer.getArrayOfWritePointers() };
+    float* const* const reverbPtrs { reverbBuffer.getArrayOfWritePointers() };
+
+    {
+        DSP::StageProfiler::Scope scope(profiler, DSP::StageProfiler::PitchShift);
+        shimmer.process(shimmerPtrs, io, numChannels, numSamples);
+    }
+    {
+        DSP::StageProfiler::Scope scope(profiler, DSP::StageProfiler::Equalizer);
+        eq.process(shimmerPtrs, shimmerPtrs, numChannels, numSamples);
+    }
+    {
+        DSP::StageProfiler::Scope scope(profiler, DSP::StageProfiler::KeithBarr);
+        KBReverb.process(shimmerPtrs, shimmerPtrs, numChannels, numSamples);
     }
+    // Input to Dattorro reverb, mix of the dry signal and the KB reverb
+    amountMixer.process(reverbPtrs, io, shimmerPtrs, numChannels, numSamples);
+}
+
+void ShimmerAudioProcessor::processSliceAfterReverb(float* const* io, unsigned int numChannels, unsigned int numSamples)
+{
+    float* const* const reverbPtrs { reverbBuffer.getArrayOfWritePointers() };
+
+    // Mix dry and wet signals, the dry signal is the host buffer itself
+    outputMixer.process(io, io, reverbPtrs, numChannels, numSamples);
+}
+
+void ShimmerAudioProcessor::setReverbBank(DSP::DattorroReverbBank* newBank, unsigned int newLane)
+{
+    reverbBank = newBank;
+    reverbBankLane = newLane;
+
+    if (reverbBank != nullptr)
+    {
+        reverbBank->setBrightness(reverbBankLane, brightness);
+        reverbBank->setDecay(reverbBankLane, decay);
+    }
+}
+
+void ShimmerAudioProcessor::setImpulseResponse(const juce::AudioBuffer<float>& ir)
+{
+    // Keep processBlock() out while the partitions are rebuilt
+    suspendProcessing(true);
+    convolutionReverb.setMonoInput(false);
+    convolutionReverb.setImpulseResponse(ir.getArrayOfReadPointers(), static_cast<unsigned int>(ir.getNumChannels()),
+                                         static_cast<unsigned int>(ir.getNumSamples()));
+    suspendProcessing(false);
+}
+
+bool ShimmerAudioProcessor::setImpulseResponseFromCache(const juce::File& cacheFile)
+{
+    juce::MemoryMappedFile mappedFile(cacheFile, juce::MemoryMappedFile::readOnly);
+    const DSP::ImpulseResponseCache cache(mappedFile.getData(), mappedFile.getSize());
+    if (!cache.isValid() || std::abs(cache.getSampleRate() - sampleRate) > 0.5)
+        return false;
+
+    const int index { cache.findNearest(DSP::ImpulseResponseCache::Dattorro, decay, brightness, 0.f) };
+    if (index < 0)
+        return false;
+
+    const auto& entry { cache.getEntry(static_cast<unsigned int>(index)) };
+    const float* ir[MaxChannels];
+    const unsigned int numIrChannels { std::min(entry.numChannels, MaxChannels) };
+    for (unsigned int ch = 0; ch < numIrChannels; ++ch)
+        ir[ch] = cache.getChannel(static_cast<unsigned int>(index), ch);
+
+    // The algorithmic reverbs sum their input to mono, the captured response expects the same
+    suspendProcessing(true);
+    convolutionReverb.setMonoInput(true);
+    convolutionReverb.setImpulseResponse(ir, numIrChannels, entry.numSamples);
+    suspendProcessing(false);
+
+    return true;
 }
 
 void ShimmerAudioProcessor::getStateInformation(juce::MemoryBlock& destData)
@@ -219,7 +473,12 @@ const juce::String ShimmerAudioProcessor::getName() const { return JucePlugin_Na
 bool ShimmerAudioProcessor::acceptsMidi() const { return false; }
 bool ShimmerAudioProcessor::producesMidi() const { return false; }
 bool ShimmerAudioProcessor::isMidiEffect() const { return false; }
-double ShimmerAudioProcessor::getTailLengthSeconds() const { return 0.0; }
+double ShimmerAudioProcessor::getTailLengthSeconds() const
+{
+    // Pitch shifter delay, then the KB reverb feeding the Dattorro or the convolution reverb
+    const double reverbTail { isConvolutionActive() ? convolutionReverb.getTailLengthSeconds() : dattorroReverb.getTailLengthSeconds() };
+    return 0.001 * Param::Ranges::BuildupMax + KBReverb.getTailLengthSeconds() + reverbTail;
+}
 int ShimmerAudioProcessor::getNumPrograms() { return 1; }
 int ShimmerAudioProcessor::getCurrentProgram() { return 0; }
 void ShimmerAudioProcessor::setCurrentProgram(int) { } 
@@ -4,8 +4,13 @@
 #include "Shimmer.h"
 #include "KeithBarrReverb.h"
 #include "DattorroReverb.h"
+#include "DattorroReverbBank.h"
+#include "ConvolutionReverb.h"
+#include "ImpulseResponseCache.h"
 #include "ParametricEqualizer.h"
 #include "Ramp.h"
+#include "DryWetMixer.h"
+#include "StageProfiler.h"
 
 namespace Param
 {
@@ -29,6 +34,9 @@ namespace Param
         // Jon Dattorro's reverb parameters
         static const juce::String Brightness { "rev_brightness" };
         static const juce::String Decay { "rev_decay" };
+
+        // Convolution reverb parameters
+        static const juce::String Convolution { "rev_convolution" };
     }
 
     namespace Name
@@ -48,6 +56,9 @@ namespace Param
         // Jon Dattorro's reverb parameters
         static const juce::String Brightness { "Brightness" };
         static const juce::String Decay { "Decay" };
+
+        // Convolution reverb parameters
+        static const juce::String Convolution { "Convolution" };
     }
 
     namespace Ranges
@@ -106,6 +117,11 @@ namespace Param
         static constexpr float DecayMax { 1.f };
         static constexpr float DecayInc { 0.01f };
         static constexpr float DecaySkw { 1.f };
+
+        // Convolution reverb parameters
+        static const juce::String ConvolutionOff { "Off" };
+        static const juce::String ConvolutionOn { "On" };
+        static constexpr bool ConvolutionDefault { false };
     }
 
     namespace Units
@@ -131,6 +147,40 @@ public:
 
     mrta::ParameterManager& getParameterManager() { return parameterManager; }
 
+    // Attach a profiler to time each stage of the chain, used by offline tools
+    // Pass nullptr to detach, must not be called while processing
+    void setStageProfiler(DSP::StageProfiler* newProfiler) { profiler = newProfiler; }
+
+    // Enroll in a shared reverb bank lane, pass nullptr to leave the bank
+    // Hosts running several processors in lockstep on one thread call, for every block,
+    // processBlockBeforeReverb() on all enrolled processors, then process the bank once,
+    // then processBlockAfterReverb() on all of them. Blocks passed to these two calls
+    // must not be longer than getSliceSamples(). processBlock() always uses the
+    // processor's own reverb. Must not be called while processing.
+    void setReverbBank(DSP::DattorroReverbBank* newBank, unsigned int newLane);
+    void processBlockBeforeReverb(juce::AudioBuffer<float>& buffer);
+    void processBlockAfterReverb(juce::AudioBuffer<float>& buffer);
+
+    // Load the impulse response of the convolution reverb, recorded at the processing sample rate
+    // With the Convolution parameter on, it replaces the Dattorro reverb in processBlock(), the
+    // reverb bank path always uses the bank. Suspends processing while the response is
+    // partitioned, must not be called from the audio thread
+    void setImpulseResponse(const juce::AudioBuffer<float>& ir);
+
+    // Load the Dattorro reverb response closest to the current Brightness and Decay from an
+    // impulse response cache written by shimmer_ir_capture, so the convolution reverb stands in
+    // for the Dattorro reverb. Returns false if the file is not a cache, was captured at another
+    // sample rate or holds no Dattorro response. Same threading rules as setImpulseResponse()
+    bool setImpulseResponseFromCache(const juce::File& cacheFile);
+
+    // Length of the slices processBlock() splits host blocks into
+    unsigned int getSliceSamples() const { return sliceSamples; }
+
+    // processBlock() also splits host blocks at parameter changes, sample accurate up to
+    // this many samples, changes closer than that to the previous split wait for the next one
+    // Must not be called while processing
+    void setMinSubBlockSamples(unsigned int newMinSubBlockSamples);
+
     //==============================================================================
     juce::AudioProcessorEditor* createEditor() override;
     bool hasEditor() const override;
@@ -149,24 +199,26 @@ public:
     static const unsigned int MaxDelaySizeSamples { 1 << 12 };
     static const unsigned int MaxChannels { 2 };
     static const unsigned int MaxProcessBlockSamples{ 32 };
+    // Offline renders use longer slices, so the pitch shifters can run concurrently
+    static const unsigned int MaxNonRealtimeProcessBlockSamples { 2048 };
+    static const unsigned int MinSubBlockSamplesDefault { 16 };
 
 private:
     mrta::ParameterManager parameterManager;
     // Sample rate
     double sampleRate { 48000.0 };
     //Enable/Disable the effect
-    DSP::Ramp<float> enableRamp;
     bool enabled;
     // Mix dry/wet
-    DSP::Ramp<float> mixRamp;
     float mix;
+    DSP::DryWetMixer outputMixer;
     // Shimmer effect
     DSP::Shimmer shimmer;
     // Pitch shifter parameters
     float shift1;
     float shift2;
-    DSP::Ramp<float> amountRamp;
     float amount;
+    DSP::DryWetMixer amountMixer;
     float buildUp;
     // Keith Barr's reverb effect
     DSP::KeithBarrReverb KBReverb;
@@ -178,12 +230,74 @@ private:
     // Jon Dattorro's reverb parameters
     float brightness;
     float decay;
+    // Convolution reverb, used instead of the Dattorro reverb once loaded and enabled
+    DSP::ConvolutionReverb convolutionReverb;
+    bool convolution;
     DSP::Ramp<float> buildupRamp;
 
-    // Internal buffer for processing
+    // The wet chain stops running once it cannot be heard, either bypassed, when the
+    // enable or mix ramps settled on a muted wet signal, or asleep, when the input is
+    // silent and the reverb tail decayed. Only processBlock() lets it stop.
+    enum class WetState
+    {
+        Running,
+        Bypassed,
+        Sleeping
+    };
+
+    // True if the convolution reverb replaces the Dattorro reverb
+    bool isConvolutionActive() const { return convolution && convolutionReverb.hasImpulseResponse(); }
+
+    // Stop running the wet chain, its tail is cleared over the next blocks
+    void stopWetPath(WetState newState);
+
+    // Engines left with a stale tail, cleared one per block while they do not run,
+    // or right before they run again, so no block pays for clearing all of them
+    enum PendingClear : unsigned int
+    {
+        ClearShimmer = 1u << 0,
+        ClearEqualizer = 1u << 1,
+        ClearKeithBarr = 1u << 2,
+        ClearDattorro = 1u << 3,
+        ClearConvolution = 1u << 4
+    };
+    static constexpr unsigned int ClearBeforeReverb { ClearShimmer | ClearEqualizer | ClearKeithBarr };
+    unsigned int pendingClears { 0 };
+    // Reverb that ran last, the other one may hold a tail from before a switch
+    bool convolutionRunning { false };
+
+    // Engines processing in the next slice
+    unsigned int getRunningEngines() const;
+    // Clear the given engines and drop them from the pending ones, never waits on a worker
+    void clearEngines(unsigned int engines);
+
+    WetState wetState { WetState::Running };
+    // Consecutive samples of silent input and wet output
+    unsigned int silentSamples { 0 };
+    unsigned int sleepHoldSamples { 0 };
+
+    // Peak level below which input and wet output count as silent, -100dBFS
+    static constexpr float SilenceThreshold { 1e-5f };
+    // Silence needed before sleeping, longer than the delay from input to reverb output
+    static constexpr double SleepHoldSeconds { 0.5 };
+
+    // Process one slice in place, no longer than sliceSamples
+    void processSliceBeforeReverb(float* const* io, unsigned int numChannels, unsigned int numSamples);
+    void processSliceAfterReverb(float* const* io, unsigned int numChannels, unsigned int numSamples);
+
+    // Internal buffers for processing, sliceSamples long
+    // The dry signal stays in the host buffer, which is processed in place
+    unsigned int sliceSamples { MaxProcessBlockSamples };
+    unsigned int minSubBlockSamples { MinSubBlockSamplesDefault };
     juce::AudioBuffer<float> shimmerBuffer;
     juce::AudioBuffer<float> reverbBuffer;
-    juce::AudioBuffer<float> dryBuffer;
+
+    // Optional shared reverb bank and the lane of this processor
+    DSP::DattorroReverbBank* reverbBank { nullptr };
+    unsigned int reverbBankLane { 0 };
+
+    // Optional stage profiler, only set by offline tools
+    DSP::StageProfiler* profiler { nullptr };
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ShimmerAudioProcessor)
 };
\ No newline at end of file
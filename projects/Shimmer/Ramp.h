@@ -1,5 +1,6 @@
 #pragma once
 
+#include <algorithm>
 #include <cmath>
 
 namespace DSP
@@ -65,11 +66,7 @@ public:
     // Apply summing ramp to a single sample in-place
     void applySum(F* buffers, unsigned int numChannels)
     {
-        const F targetDelta { std::fabs(targetValue - currentValue) };
-        if ((targetDelta > std::fabs(static_cast<F>(2) * rampStep)) && (std::fabs(rampStep) > minDelta))
-            currentValue += rampStep;
-        else
-            currentValue = targetValue;
+        step();
 
         for (unsigned int ch = 0; ch < numChannels; ++ch)
             buffers[ch] += currentValue;
@@ -78,43 +75,42 @@ public:
     // Apply summing ramp to an audio buffer in-place
     void applySum(F* const* buffers, unsigned int numChannels, unsigned int numSamples)
     {
-        for (unsigned int n = 0; n < numSamples; ++n)
-        {
-            const F targetDelta { std::fabs(targetValue - currentValue) };
-            if ((targetDelta > std::fabs(static_cast<F>(2) * rampStep)) && (std::fabs(rampStep) > minDelta))
-                currentValue += rampStep;
-            else
-                currentValue = targetValue;
-
-            for (unsigned int ch = 0; ch < numChannels; ++ch)
-                buffers[ch][n] += currentValue;
-        }
+        applySum(buffers, buffers, numChannels, numSamples);
     }
 
     // Apply summing ramp to an audio buffer out-of-place
     void applySum(F* const* output, const F* const* input, unsigned int numChannels, unsigned int numSamples)
     {
-        for (unsigned int n = 0; n < numSamples; ++n)
-        {
-            const F targetDelta { std::fabs(targetValue - currentValue) };
-            if ((targetDelta > std::fabs(static_cast<F>(2) * rampStep)) && (std::fabs(rampStep) > minDelta))
-                currentValue += rampStep;
-            else
-                currentValue = targetValue;
-
-            for (unsigned int ch = 0; ch < numChannels; ++ch)
-                output[ch][n] = currentValue + input[ch][n];
-        }
+        processSegments(numSamples,
+            [&](const F* values, unsigned int start, unsigned int count)
+            {
+                for (unsigned int ch = 0; ch < numChannels; ++ch)
+                {
+                    F* const out { output[ch] + start };
+                    const F* const in { input[ch] + start };
+                    for (unsigned int n = 0; n < count; ++n)
+                        out[n] = values[n] + in[n];
+                }
+            },
+            [&](F value, unsigned int start, unsigned int count)
+            {
+                for (unsigned int ch = 0; ch < numChannels; ++ch)
+                {
+                    F* const out { output[ch] + start };
+                    const F* const in { input[ch] + start };
+                    if (value == static_cast<F>(0))
+                        copy(out, in, count);
+                    else
+                        for (unsigned int n = 0; n < count; ++n)
+                            out[n] = value + in[n];
+                }
+            });
     }
 
     // Apply gain ramp to an audio buffer in-place for single sample
     void applyGain(F* buffers, unsigned int numChannels)
     {
-        const F targetDelta { std::fabs(targetValue - currentValue) };
-        if ((targetDelta > std::fabs(static_cast<F>(2) * rampStep)) && (std::fabs(rampStep) > minDelta))
-            currentValue += rampStep;
-        else
-            currentValue = targetValue;
+        step();
 
         for (unsigned int ch = 0; ch < numChannels; ++ch)
             buffers[ch] *= currentValue;
@@ -123,43 +119,29 @@ public:
     // Apply gain ramp to an audio buffer in-place
     void applyGain(F* const* buffers, unsigned int numChannels, unsigned int numSamples)
     {
-        for (unsigned int n = 0; n < numSamples; ++n)
-        {
-            const F targetDelta { std::fabs(targetValue - currentValue) };
-            if ((targetDelta > std::fabs(static_cast<F>(2) * rampStep)) && (std::fabs(rampStep) > minDelta))
-                currentValue += rampStep;
-            else
-                currentValue = targetValue;
-
-            for (unsigned int ch = 0; ch < numChannels; ++ch)
-                buffers[ch][n] *= currentValue;
-        }
+        applyGain(buffers, buffers, numChannels, numSamples);
     }
 
     // Apply gain ramp to an audio buffer out-of-place
     void applyGain(F* const* output, const F* const* input, unsigned int numChannels, unsigned int numSamples)
     {
-        for (unsigned int n = 0; n < numSamples; ++n)
-        {
-            const F targetDelta{ std::fabs(targetValue - currentValue) };
-            if ((targetDelta > std::fabs(static_cast<F>(2) * rampStep)) && (std::fabs(rampStep) > minDelta))
-                currentValue += rampStep;
-            else
-                currentValue = targetValue;
-
-            for (unsigned int ch = 0; ch < numChannels; ++ch)
-                output[ch][n] = currentValue * input[ch][n];
-        }
+        processSegments(numSamples,
+            [&](const F* values, unsigned int start, unsigned int count)
+            {
+                for (unsigned int ch = 0; ch < numChannels; ++ch)
+                    multiply(output[ch] + start, input[ch] + start, values, count);
+            },
+            [&](F value, unsigned int start, unsigned int count)
+            {
+                for (unsigned int ch = 0; ch < numChannels; ++ch)
+                    multiply(output[ch] + start, input[ch] + start, value, count);
+            });
     }
 
     // Apply gain ramp to an audio buffer in-place for single sample
     void applyInverseGain(F* buffers, unsigned int numChannels)
     {
-        const F targetDelta { std::fabs(targetValue - currentValue) };
-        if ((targetDelta > std::fabs(static_cast<F>(2) * rampStep)) && (std::fabs(rampStep) > minDelta))
-            currentValue += rampStep;
-        else
-            currentValue = targetValue;
+        step();
 
         for (unsigned int ch = 0; ch < numChannels; ++ch)
             buffers[ch] *= (1 - currentValue);
@@ -168,46 +150,41 @@ public:
     // Apply gain ramp to an audio buffer in-place
     void applyInverseGain(F* const* buffers, unsigned int numChannels, unsigned int numSamples)
     {
-        for (unsigned int n = 0; n < numSamples; ++n)
-        {
-            const F targetDelta { std::fabs(targetValue - currentValue) };
-            if ((targetDelta > std::fabs(static_cast<F>(2) * rampStep)) && (std::fabs(rampStep) > minDelta))
-                currentValue += rampStep;
-            else
-                currentValue = targetValue;
-
-            for (unsigned int ch = 0; ch < numChannels; ++ch)
-                buffers[ch][n] *= (1 - currentValue);
-        }
+        applyInverseGain(buffers, buffers, numChannels, numSamples);
     }
 
     // Apply gain ramp to an audio buffer out-of-place
     void applyInverseGain(F* const* output, const F* const* input, unsigned int numChannels, unsigned int numSamples)
     {
-        for (unsigned int n = 0; n < numSamples; ++n)
-        {
-            const F targetDelta{ std::fabs(targetValue - currentValue) };
-            if ((targetDelta > std::fabs(static_cast<F>(2) * rampStep)) && (std::fabs(rampStep) > minDelta))
-                currentValue += rampStep;
-            else
-                currentValue = targetValue;
-
-            for (unsigned int ch = 0; ch < numChannels; ++ch)
-                output[ch][n] = (1 - currentValue) * input[ch][n];
-        }
+        processSegments(numSamples,
+            [&](const F* values, unsigned int start, unsigned int count)
+            {
+                F inverse[RampChunkSamples];
+                for (unsigned int n = 0; n < count; ++n)
+                    inverse[n] = 1 - values[n];
+
+                for (unsigned int ch = 0; ch < numChannels; ++ch)
+                    multiply(output[ch] + start, input[ch] + start, inverse, count);
+            },
+            [&](F value, unsigned int start, unsigned int count)
+            {
+                for (unsigned int ch = 0; ch < numChannels; ++ch)
+                    multiply(output[ch] + start, input[ch] + start, 1 - value, count);
+            });
     }
 
     float getNext()
     {
-        const F targetDelta { std::fabs(targetValue - currentValue) };
-        if ((targetDelta > std::fabs(static_cast<F>(2) * rampStep)) && (std::fabs(rampStep) > minDelta))
-            currentValue += rampStep;
-        else
-            currentValue = targetValue;
-
+        step();
         return currentValue;
     }
 
+    // True once the ramp reached its target
+    bool isSettled() const { return currentValue == targetValue; }
+
+    // Value of the last processed sample
+    F getCurrentValue() const { return currentValue; }
+
     // Minimum ramp time in secondes
     static constexpr F minRampTime { static_cast<F>(1e-3) }; // 1ms
 
@@ -215,6 +192,82 @@ public:
     static constexpr F minDelta { static_cast<F>(1e-9) };
 
 private:
+    // Samples of ramp values computed at once by the block kernels
+    static constexpr unsigned int RampChunkSamples { 64 };
+
+    // Advance the ramp by one sample
+    void step()
+    {
+        const F targetDelta { std::fabs(targetValue - currentValue) };
+        if ((targetDelta > std::fabs(static_cast<F>(2) * rampStep)) && (std::fabs(rampStep) > minDelta))
+            currentValue += rampStep;
+        else
+            currentValue = targetValue;
+    }
+
+    // Split a block into a linear segment while the ramp moves and a constant segment
+    // once it is settled. The length of the linear segment is computed once, its values
+    // are start + i * step, handed chunk by chunk to rampFn(values, start, count), the
+    // constant segment is handed to constFn(value, start, count), so both can run
+    // branch free across the channels. Ends on the same sample as step() would, the
+    // values differ from its running sum by rounding only.
+    template <typename RampFn, typename ConstFn>
+    void processSegments(unsigned int numSamples, RampFn&& rampFn, ConstFn&& constFn)
+    {
+        unsigned int start { 0 };
+        if (currentValue != targetValue && numSamples > 0)
+        {
+            // step() moves while more than two steps away from the target, then snaps to it
+            const F absStep { std::fabs(rampStep) };
+            const F numSteps { absStep > minDelta ? std::ceil(std::fabs(targetValue - currentValue) / absStep - static_cast<F>(2)) : static_cast<F>(0) };
+            const unsigned int numMoving { static_cast<unsigned int>(std::clamp(numSteps, static_cast<F>(0), static_cast<F>(numSamples))) };
+            const unsigned int rampSamples { std::min(numMoving + 1, numSamples) };
+            const F startValue { currentValue };
+
+            while (start < rampSamples)
+            {
+                F values[RampChunkSamples];
+                const unsigned int count { std::min(rampSamples - start, RampChunkSamples) };
+                for (unsigned int n = 0; n < count; ++n)
+                    values[n] = startValue + static_cast<F>(start + n + 1) * rampStep;
+                if (start + count > numMoving)
+                    values[numMoving - start] = targetValue;
+
+                rampFn(values, start, count);
+                start += count;
+            }
+
+            currentValue = rampSamples > numMoving ? targetValue : startValue + static_cast<F>(rampSamples) * rampStep;
+        }
+
+        if (start < numSamples)
+            constFn(currentValue, start, numSamples - start);
+    }
+
+    static void copy(F* output, const F* input, unsigned int numSamples)
+    {
+        if (output != input)
+            std::copy(input, input + numSamples, output);
+    }
+
+    static void multiply(F* output, const F* input, const F* gains, unsigned int numSamples)
+    {
+        for (unsigned int n = 0; n < numSamples; ++n)
+            output[n] = gains[n] * input[n];
+    }
+
+    // Gains of 1 and 0 skip the multiply
+    static void multiply(F* output, const F* input, F gain, unsigned int numSamples)
+    {
+        if (gain == static_cast<F>(1))
+            copy(output, input, numSamples);
+        else if (gain == static_cast<F>(0))
+            std::fill(output, output + numSamples, static_cast<F>(0));
+        else
+            for (unsigned int n = 0; n < numSamples; ++n)
+                output[n] = gain * input[n];
+    }
+
     double sampleRate { 48000.0 };
     F rampTime;
     F rampStep { static_cast<F>(0) };
@@ -1,12 +1,13 @@
 #include "Shimmer.h"
 
+#include <algorithm>
 #include <cmath>
 
 namespace DSP
 {
 
 Shimmer::Shimmer(float maxTimeMs, float blockSizeMS, unsigned int numChannels) :
-    delayLine(static_cast<unsigned int>(std::ceil(std::fmax(maxTimeMs, 1.f) * static_cast<float>(0.001 * sampleRate))), numChannels),
+    delayLine(static_cast<unsigned int>(std::ceil(std::fmax(maxTimeMs, 1.f) * static_cast<float>(0.001 * DSP::DelayLine::MaxSampleRate))), numChannels, DSP::DelayLine::Interleaved),
     buildupRamp(0.5f),
     shift1(static_cast<float>(std::fmax(blockSizeMS, 20.0f)), numChannels),
     shift2(static_cast<float>(std::fmax(blockSizeMS, 20.0f)), numChannels)
@@ -33,6 +34,8 @@ void Shimmer::prepare(double newSampleRate, float maxTimeMs, unsigned int numCha
     buildupRamp.prepare(sampleRate, true, buildupMs * static_cast<float>(sampleRate * 0.001));
 
     // Resize buffers to match channel count and buffer size
+    maxChunkSamples = std::max(numSamples, 1u);
+
     delayOut.resize(numChannels);
     shifted1.resize(numChannels);
     shifted2.resize(numChannels);
@@ -43,9 +46,9 @@ void Shimmer::prepare(double newSampleRate, float maxTimeMs, unsigned int numCha
 
     for (unsigned int ch = 0; ch < numChannels; ++ch)
     {
-        delayOut[ch].resize(numSamples, 0.0f);
-        shifted1[ch].resize(numSamples, 0.0f);
-        shifted2[ch].resize(numSamples, 0.0f);
+        delayOut[ch].resize(maxChunkSamples, 0.0f);
+        shifted1[ch].resize(maxChunkSamples, 0.0f);
+        shifted2[ch].resize(maxChunkSamples, 0.0f);
 
         delayOutPtrs[ch] = delayOut[ch].data();
         shifted1Ptrs[ch] = shifted1[ch].data();
@@ -63,32 +66,45 @@ void Shimmer::clear()
 
 void Shimmer::process(float* const* output, const float* const* input, unsigned int numChannels, unsigned int numSamples)
 {
-    // Apply delay
-    for (unsigned int n = 0; n < numSamples; ++n)
-    {
-        // Process LFO no modulation, just add zeros for delay/buildup ramp
-        float lfo[2] { 0.f, 0.f };
-        // Apply buildup ramp
-        buildupRamp.applySum(lfo, numChannels);
+    numChannels = std::min({ numChannels, static_cast<unsigned int>(delayOut.size()), static_cast<unsigned int>(MaxChannels) });
+    if (maxChunkSamples == 0)
+        return;
 
-        // Delay in/out
-        float x[2];
-        float y[2];
+    float* outputChunk[MaxChannels];
+    const float* inputChunk[MaxChannels];
 
+    for (unsigned int pos = 0; pos < numSamples; pos += maxChunkSamples)
+    {
         for (unsigned int ch = 0; ch < numChannels; ++ch)
-            x[ch] = input[ch][n];
-
-        // Process delay
-        delayLine.process(y, x, lfo, numChannels);
+        {
+            outputChunk[ch] = output[ch] + pos;
+            inputChunk[ch] = input[ch] + pos;
+        }
 
-        // Write to output buffers
-        for (unsigned int ch = 0; ch < numChannels; ++ch)
-            delayOutPtrs[ch][n] = y[ch];
+        processChunk(outputChunk, inputChunk, numChannels, std::min(maxChunkSamples, numSamples - pos));
     }
+}
+
+void Shimmer::processChunk(float* const* output, const float* const* input, unsigned int numChannels, unsigned int numSamples)
+{
+    // Apply delay
+    if (numChannels == 1)
+        processDelay<1>(input, numSamples);
+    else if (numChannels == MaxChannels)
+        processDelay<MaxChannels>(input, numSamples);
 
     //Apply pitch shifting to delayed signal
+    // Both shifters only read delayOut, so the second one can run on the worker
+    workerNumChannels = numChannels;
+    workerNumSamples = numSamples;
+    const bool parallel { numSamples >= parallelMinBlockSamples && worker.launch(&Shimmer::processShift2, this) };
+
     shift1.process(shifted1Ptrs.data(), const_cast<const float* const*>(delayOutPtrs.data()), numChannels, numSamples);
-    shift2.process(shifted2Ptrs.data(), const_cast<const float* const*>(delayOutPtrs.data()), numChannels, numSamples);
+
+    if (parallel)
+        worker.wait();
+    else
+        processShift2(this);
 
     // Add pitch shifted signals
     for (unsigned int ch = 0; ch < numChannels; ++ch)
@@ -100,6 +116,52 @@ void Shimmer::process(float* const* output, const float* const* input, unsigned
     }
 }
 
+template <unsigned int N>
+void Shimmer::processDelay(const float* const* input, unsigned int numSamples)
+{
+    for (unsigned int n = 0; n < numSamples; ++n)
+    {
+        // Process LFO no modulation, just add zeros for delay/buildup ramp
+        float lfo[N] { };
+        // Apply buildup ramp
+        buildupRamp.applySum(lfo, N);
+
+        // Delay in/out
+        float x[N];
+        float y[N];
+
+        for (unsigned int ch = 0; ch < N; ++ch)
+            x[ch] = input[ch][n];
+
+        // Process delay
+        delayLine.processSample<N>(y, x, lfo);
+
+        // Write to output buffers
+        for (unsigned int ch = 0; ch < N; ++ch)
+            delayOutPtrs[ch][n] = y[ch];
+    }
+}
+
+void Shimmer::processShift2(void* context)
+{
+    Shimmer& self { *static_cast<Shimmer*>(context) };
+    self.shift2.process(self.shifted2Ptrs.data(), const_cast<const float* const*>(self.delayOutPtrs.data()),
+                        self.workerNumChannels, self.workerNumSamples);
+}
+
+void Shimmer::setParallelEnabled(bool enabled)
+{
+    if (enabled)
+        worker.start();
+    else
+        worker.stop();
+}
+
+void Shimmer::setParallelMinBlockSamples(unsigned int newMinBlockSamples)
+{
+    parallelMinBlockSamples = std::max(newMinBlockSamples, 1u);
+}
+
 void Shimmer::setBuildup(float newBuildupMs)
 {
     buildupMs = std::fmax(newBuildupMs, 1.f);
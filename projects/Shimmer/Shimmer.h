@@ -3,6 +3,7 @@
 #include "DelayLine.h"
 #include "Ramp.h"
 #include "GranularPitchShifter.h"
+#include "WorkerThread.h"
 
 namespace DSP
 {
@@ -11,6 +12,7 @@ class Shimmer
 {
 public:
 
+    // maxTimeMs sizes the buildup delay memory for DSP::DelayLine::MaxSampleRate
     Shimmer(float maxTimeMs, float blockSizeMS, unsigned int numChannels);
     ~Shimmer();
 
@@ -26,12 +28,13 @@ public:
     const Shimmer& operator=(Shimmer&&) = delete;
 
     // Update sample rate, reallocates and clear internal buffers
+    // numSamples sizes the temporary buffers, longer blocks are processed in chunks of that size
     void prepare(double sampleRate, float maxTimeMs, unsigned int numChannels, unsigned int numSamples);
 
     // Clear contents of internal buffer
     void clear();
 
-    // Process audio
+    // Process audio, does not allocate for any block size
     void process(float* const* output, const float* const* input, unsigned int numChannels, unsigned int numSamples);
 
     // Set delay/buildup offset in ms
@@ -41,7 +44,15 @@ public:
     void setRatio1(float newRatio1);
     void setRatio2(float newRatio2);
 
+    // Run the second pitch shifter on a worker thread, concurrently with the first one
+    // Spawns / joins the worker, must not be called from the audio thread
+    void setParallelEnabled(bool enabled);
+
+    // Blocks shorter than this are processed serially even if the worker is enabled
+    void setParallelMinBlockSamples(unsigned int newMinBlockSamples);
+
     static constexpr int MaxChannels { 2 };
+    static constexpr unsigned int ParallelMinBlockSamplesDefault { 1024 };
 
 private:
     double sampleRate { 48000.0 };
@@ -53,12 +64,29 @@ private:
 
     DSP::Ramp<float> buildupRamp;
 
+    // Worker running shift2, and the block it is working on
+    DSP::WorkerThread worker;
+    unsigned int parallelMinBlockSamples { ParallelMinBlockSamplesDefault };
+    unsigned int workerNumChannels { 0 };
+    unsigned int workerNumSamples { 0 };
+
+    // Process a chunk no longer than the temporary buffers
+    void processChunk(float* const* output, const float* const* input, unsigned int numChannels, unsigned int numSamples);
+
+    // Run the buildup delay into delayOut with a fixed channel count
+    template <unsigned int N>
+    void processDelay(const float* const* input, unsigned int numSamples);
+
+    // Worker job processing shift2
+    static void processShift2(void* context);
+
     float buildupMs { 0.f };
     float blocksize { 20.f };
     float ratio1 { 1.f };
     float ratio2 { 1.f };
 
-    // Temporary buffers
+    // Temporary buffers, maxChunkSamples long
+    unsigned int maxChunkSamples { 0 };
     std::vector<std::vector<float>> delayOut;
     std::vector<std::vector<float>> shifted1;
     std::vector<std::vector<float>> shifted2;
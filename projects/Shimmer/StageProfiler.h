@@ -0,0 +1,107 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+ #if defined(_MSC_VER)
+  #include <intrin.h>
+ #else
+  #include <x86intrin.h>
+ #endif
+ #define DSP_STAGE_PROFILER_TSC 1
+#else
+ #define DSP_STAGE_PROFILER_TSC 0
+#endif
+
+namespace DSP
+{
+
+// Accumulates the time spent in each stage of the Shimmer signal chain.
+// It is meant to be attached to the processor by offline tools only,
+// when no profiler is attached the audio path skips all timing.
+class StageProfiler
+{
+public:
+    enum Stage : unsigned int
+    {
+        PitchShift = 0,
+        Equalizer,
+        KeithBarr,
+        Dattorro,
+        Convolution,
+        NumStages
+    };
+
+    // Times a single stage for the lifetime of the scope
+    // Does nothing if the profiler is null
+    class Scope
+    {
+    public:
+        Scope(StageProfiler* p, Stage s) :
+            profiler { p },
+            stage { s },
+            start { p != nullptr ? now() : 0u }
+        { }
+
+        ~Scope()
+        {
+            if (profiler != nullptr)
+                profiler->add(stage, now() - start);
+        }
+
+        Scope(const Scope&) = delete;
+        const Scope& operator=(const Scope&) = delete;
+
+    private:
+        StageProfiler* profiler;
+        Stage stage;
+        uint64_t start;
+    };
+
+    StageProfiler() { reset(); }
+
+    // Clear accumulated ticks
+    void reset() { ticks.fill(0u); }
+
+    // Add ticks to a stage
+    void add(Stage stage, uint64_t numTicks) { ticks[stage] += numTicks; }
+
+    // Get accumulated ticks of a stage
+    uint64_t getTicks(Stage stage) const { return ticks[stage]; }
+
+    // Human readable stage name
+    static const char* getStageName(Stage stage)
+    {
+        switch (stage)
+        {
+            case PitchShift: return "Shimmer";
+            case Equalizer: return "ParametricEqualizer";
+            case KeithBarr: return "KeithBarrReverb";
+            case Dattorro: return "DattorroReverb";
+            case Convolution: return "ConvolutionReverb";
+            default: return "";
+        }
+    }
+
+    // Current tick count, CPU cycles where a time stamp counter
+    // is available, nanoseconds otherwise
+    static uint64_t now()
+    {
+#if DSP_STAGE_PROFILER_TSC
+        return static_cast<uint64_t>(__rdtsc());
+#else
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+    }
+
+    // True if ticks are counted in CPU cycles, false if in nanoseconds
+    static constexpr bool TicksAreCycles { DSP_STAGE_PROFILER_TSC == 1 };
+
+private:
+    std::array<uint64_t, NumStages> ticks;
+};
+
+}
\ No newline at end of file
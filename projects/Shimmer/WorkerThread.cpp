@@ -0,0 +1,137 @@
+#include "WorkerThread.h"
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#elif defined(__APPLE__)
+#include <dispatch/dispatch.h>
+#else
+#include <semaphore.h>
+#endif
+
+namespace DSP
+{
+
+// Counting semaphore, posting it does not take a lock and only enters the kernel
+// when a thread is blocked on it
+struct WorkerThread::Semaphore
+{
+#if defined(_WIN32)
+    Semaphore() : handle { CreateSemaphore(nullptr, 0, 1 << 30, nullptr) } { }
+    ~Semaphore() { CloseHandle(handle); }
+    void post() { ReleaseSemaphore(handle, 1, nullptr); }
+    void wait() { WaitForSingleObject(handle, INFINITE); }
+
+    HANDLE handle;
+#elif defined(__APPLE__)
+    Semaphore() : handle { dispatch_semaphore_create(0) } { }
+    ~Semaphore() { dispatch_release(handle); }
+    void post() { dispatch_semaphore_signal(handle); }
+    void wait() { dispatch_semaphore_wait(handle, DISPATCH_TIME_FOREVER); }
+
+    dispatch_semaphore_t handle;
+#else
+    Semaphore() { sem_init(&handle, 0, 0); }
+    ~Semaphore() { sem_destroy(&handle); }
+    void post() { sem_post(&handle); }
+    void wait() { while (sem_wait(&handle) != 0) { } }
+
+    sem_t handle;
+#endif
+};
+
+WorkerThread::WorkerThread() :
+    semaphore { std::make_unique<Semaphore>() }
+{
+}
+
+WorkerThread::~WorkerThread()
+{
+    stop();
+}
+
+void WorkerThread::start()
+{
+    if (thread.joinable())
+        return;
+
+    finished.store(launched.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    running.store(true, std::memory_order_release);
+    thread = std::thread([this] { run(); });
+}
+
+void WorkerThread::stop()
+{
+    if (!thread.joinable())
+        return;
+
+    running.store(false, std::memory_order_seq_cst);
+    wake();
+    thread.join();
+}
+
+bool WorkerThread::launch(Job newJob, void* newContext)
+{
+    if (!isRunning())
+        return false;
+
+    job = newJob;
+    context = newContext;
+    launched.fetch_add(1u, std::memory_order_seq_cst);
+    wake();
+    return true;
+}
+
+void WorkerThread::wait()
+{
+    const uint32_t target { launched.load(std::memory_order_relaxed) };
+
+    unsigned int spins { 0 };
+    while (finished.load(std::memory_order_acquire) != target)
+    {
+        if (++spins > SpinCount)
+            std::this_thread::yield();
+    }
+}
+
+void WorkerThread::wake()
+{
+    // Only one side clears the flag, so every post matches one wait of the worker
+    if (sleeping.exchange(false, std::memory_order_seq_cst))
+        semaphore->post();
+}
+
+void WorkerThread::run()
+{
+    uint32_t done { finished.load(std::memory_order_relaxed) };
+
+    // Jobs are drained before leaving, a launched job is always finished
+    while (running.load(std::memory_order_acquire) || launched.load(std::memory_order_acquire) != done)
+    {
+        const uint32_t pending { launched.load(std::memory_order_acquire) };
+        if (pending != done)
+        {
+            job(context);
+            done = pending;
+            finished.store(done, std::memory_order_release);
+            continue;
+        }
+
+        // Announce the wait, then check again: a launch or stop after the announcement
+        // sees the flag and posts, one before it is seen here
+        sleeping.store(true, std::memory_order_seq_cst);
+        if (launched.load(std::memory_order_seq_cst) != done || !running.load(std::memory_order_seq_cst))
+        {
+            // Take the flag back, or consume the post of a wake() that took it first
+            if (!sleeping.exchange(false, std::memory_order_seq_cst))
+                semaphore->wait();
+            continue;
+        }
+
+        semaphore->wait();
+    }
+}
+
+}
\ No newline at end of file
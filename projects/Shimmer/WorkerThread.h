@@ -0,0 +1,76 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <thread>
+
+namespace DSP
+{
+
+// Single background thread that runs one job at a time on behalf of the audio thread.
+// Launching and waiting for a job never allocates nor locks, the handoff is a pair
+// of atomic counters and the caller waits for completion on a spin barrier.
+// The idle worker blocks on a semaphore, which launch() only posts when the worker
+// is waiting on it, so no CPU is spent while there is nothing to run.
+// Only start() and stop() spawn / join the thread and must be called off the audio thread.
+class WorkerThread
+{
+public:
+    // Job run on the worker, receives the context given to launch()
+    using Job = void (*)(void* context);
+
+    WorkerThread();
+    ~WorkerThread();
+
+    // No copy semantics
+    WorkerThread(const WorkerThread&) = delete;
+    const WorkerThread& operator=(const WorkerThread&) = delete;
+
+    // No move semantics
+    WorkerThread(WorkerThread&&) = delete;
+    const WorkerThread& operator=(WorkerThread&&) = delete;
+
+    // Spawn the worker thread if it is not running yet
+    void start();
+
+    // Join the worker thread, waits for a running job to finish
+    void stop();
+
+    // True if the worker thread is running and can take jobs
+    bool isRunning() const { return running.load(std::memory_order_acquire); }
+
+    // Hand a job to the worker, returns false if the worker is not running,
+    // in which case the caller has to run the job itself
+    // Every successful launch must be followed by a call to wait()
+    bool launch(Job newJob, void* newContext);
+
+    // Block until the last launched job has finished
+    void wait();
+
+    // Spins before the waiting side starts yielding its time slice
+    static constexpr unsigned int SpinCount { 2000 };
+
+private:
+    void run();
+
+    // Post the semaphore if the worker is blocked on it, or about to be
+    void wake();
+
+    // Platform semaphore, lock free to post
+    struct Semaphore;
+    std::unique_ptr<Semaphore> semaphore;
+    // True while the worker is blocked on the semaphore, or about to be
+    std::atomic<bool> sleeping { false };
+
+    std::thread thread;
+    std::atomic<bool> running { false };
+
+    // Job handoff, job and context are published by the launched counter
+    Job job { nullptr };
+    void* context { nullptr };
+    std::atomic<uint32_t> launched { 0 };
+    std::atomic<uint32_t> finished { 0 };
+};
+
+}
\ No newline at end of file
@@ -0,0 +1,1375 @@
+#include <JuceHeader.h>
+#include "PluginProcessor.h"
+#include "StageProfiler.h"
+#include "KeithBarrReverb.h"
+#include "DattorroReverb.h"
+#include "GranularPitchShifter.h"
+#include "Shimmer.h"
+#include "DattorroReverbBank.h"
+#include "ParametricEqualizer.h"
+#include "ConvolutionReverb.h"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstring>
+#include <cstdio>
+#include <ctime>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <vector>
+
+// Offline render and benchmark harness for the Shimmer plugin
+// Streams a WAV file or a synthetic signal through ShimmerAudioProcessor::processBlock
+// without a host and reports real-time factor, per-block latency and per-stage cost.
+//
+// Usage:
+//   shimmer_bench [--input=<file.wav>] [--signal=noise|sine|impulse|silence]
+//                 [--seconds=<s>] [--sample-rate=<Hz>] [--block-sizes=<n,n,...>]
+//                 [--random-blocks] [--seed=<n>] [--output=<file.wav>] [--parallel]
+//   shimmer_bench --verify [--seconds=<s>] [--sample-rate=<Hz>] [--seed=<n>]
+//   shimmer_bench --realtime-check [--seconds=<s>] [--sample-rate=<Hz>] [--seed=<n>]
+//   shimmer_bench --denormal-tail [--seconds=<s>] [--sample-rate=<Hz>] [--block-sizes=<n>] [--seed=<n>]
+//   shimmer_bench --decay-invariance [--seconds=<s>]
+//   shimmer_bench --convolution-load [--seconds=<s>] [--sample-rate=<Hz>] [--block-sizes=<n>] [--seed=<n>]
+//
+// --verify runs the bit-exactness checks of the optimized DSP paths against
+// their reference implementations, and the equal output check of the biquads,
+// and exits with 1 if any of them fails.
+// --realtime-check renders the processor in a few host scenarios and exits with 1
+// if it allocated or locked inside processBlock, needs -DMRTA_REALTIME_CHECKS=ON.
+// --denormal-tail times the decaying tail of the reverbs after a short burst with
+// flush-to-zero off, with and without their denormal protection.
+// --decay-invariance measures the decay time of the reverbs from 44.1 to 192 kHz and
+// exits with 1 if it drifts from the 48 kHz one.
+// --convolution-load times the convolution reverb with a 10 s stereo impulse response and
+// exits with 1 if it takes more than 5% of a core.
+
+namespace
+{
+
+struct Options
+{
+    juce::File inputFile;
+    juce::File outputFile;
+    juce::String signal { "noise" };
+    double sampleRate { 48000.0 };
+    double seconds { 10.0 };
+    std::vector<int> blockSizes { 32, 64, 128, 256, 512, 1024, 2048 };
+    bool randomBlocks { false };
+    bool parallel { false };
+    int seed { 1 };
+};
+
+struct RunResult
+{
+    int blockSize { 0 };
+    double realTimeFactor { 0.0 };
+    double p50Us { 0.0 };
+    double p99Us { 0.0 };
+    double maxUs { 0.0 };
+    double stageTicksPerSample[DSP::StageProfiler::NumStages] { };
+    double totalTicksPerSample { 0.0 };
+};
+
+void printUsage()
+{
+    std::printf("Usage: shimmer_bench [--input=<file.wav>] [--signal=noise|sine|impulse|silence]\n"
+                "                     [--seconds=<s>] [--sample-rate=<Hz>] [--block-sizes=<n,n,...>]\n"
+                "                     [--random-blocks] [--seed=<n>] [--output=<file.wav>] [--parallel]\n"
+                "       shimmer_bench --verify [--seconds=<s>] [--sample-rate=<Hz>] [--seed=<n>]\n"
+                "       shimmer_bench --realtime-check [--seconds=<s>] [--sample-rate=<Hz>] [--seed=<n>]\n"
+                "       shimmer_bench --denormal-tail [--seconds=<s>] [--sample-rate=<Hz>] [--block-sizes=<n>] [--seed=<n>]\n"
+                "       shimmer_bench --decay-invariance [--seconds=<s>]\n"
+                "       shimmer_bench --convolution-load [--seconds=<s>] [--sample-rate=<Hz>] [--block-sizes=<n>] [--seed=<n>]\n");
+}
+
+Options parseOptions(const juce::ArgumentList& args)
+{
+    Options options;
+
+    if (args.containsOption("--input"))
+        options.inputFile = args.getExistingFileForOption("--input");
+
+    if (args.containsOption("--output"))
+        options.outputFile = args.getFileForOption("--output");
+
+    if (args.containsOption("--signal"))
+        options.signal = args.getValueForOption("--signal");
+
+    if (args.containsOption("--seconds"))
+        options.seconds = std::max(args.getValueForOption("--seconds").getDoubleValue(), 0.1);
+
+    if (args.containsOption("--sample-rate"))
+        options.sampleRate = std::max(args.getValueForOption("--sample-rate").getDoubleValue(), 8000.0);
+
+    if (args.containsOption("--block-sizes"))
+    {
+        options.blockSizes.clear();
+        for (const auto& token : juce::StringArray::fromTokens(args.getValueForOption("--block-sizes"), ",", ""))
+            if (token.getIntValue() > 0)
+                options.blockSizes.push_back(token.getIntValue());
+
+        if (options.blockSizes.empty())
+            juce::ConsoleApplication::fail("--block-sizes needs at least one positive block size");
+    }
+
+    if (args.containsOption("--seed"))
+        options.seed = args.getValueForOption("--seed").getIntValue();
+
+    options.randomBlocks = args.containsOption("--random-blocks");
+    options.parallel = args.containsOption("--parallel");
+
+    return options;
+}
+
+juce::AudioBuffer<float> loadInput(Options& options, int numChannels)
+{
+    if (options.inputFile != juce::File())
+    {
+        juce::AudioFormatManager formatManager;
+        formatManager.registerBasicFormats();
+
+        std::unique_ptr<juce::AudioFormatReader> reader { formatManager.createReaderFor(options.inputFile) };
+        if (reader == nullptr)
+            juce::ConsoleApplication::fail("Could not read " + options.inputFile.getFullPathName());
+
+        const int numSamples { static_cast<int>(reader->lengthInSamples) };
+        juce::AudioBuffer<float> input(numChannels, numSamples);
+        input.clear();
+        reader->read(&input, 0, numSamples, 0, true, true);
+
+        // Duplicate mono files to all channels
+        if (reader->numChannels == 1)
+            for (int ch = 1; ch < numChannels; ++ch)
+                input.copyFrom(ch, 0, input, 0, 0, numSamples);
+
+        options.sampleRate = reader->sampleRate;
+        options.seconds = static_cast<double>(numSamples) / options.sampleRate;
+        return input;
+    }
+
+    const int numSamples { static_cast<int>(std::ceil(options.seconds * options.sampleRate)) };
+    juce::AudioBuffer<float> input(numChannels, numSamples);
+    input.clear();
+
+    juce::Random random(options.seed);
+    for (int ch = 0; ch < numChannels; ++ch)
+    {
+        float* x { input.getWritePointer(ch) };
+        for (int n = 0; n < numSamples; ++n)
+        {
+            if (options.signal == "noise")
+                x[n] = 0.5f * (2.f * random.nextFloat() - 1.f);
+            else if (options.signal == "sine")
+                x[n] = 0.5f * std::sin(2.f * juce::MathConstants<float>::pi * 440.f * static_cast<float>(n / options.sampleRate));
+            else if (options.signal == "impulse")
+                x[n] = (n % static_cast<int>(options.sampleRate)) == 0 ? 1.f : 0.f;
+        }
+    }
+
+    return input;
+}
+
+double percentile(const std::vector<double>& sorted, double p)
+{
+    if (sorted.empty())
+        return 0.0;
+
+    const size_t index { static_cast<size_t>(std::ceil(p * static_cast<double>(sorted.size()))) };
+    return sorted[std::min(std::max(index, static_cast<size_t>(1)), sorted.size()) - 1];
+}
+
+// Synthetic room response, noise decaying by 60dB over the given number of samples
+juce::AudioBuffer<float> makeImpulseResponse(int numChannels, int numSamples, int seed)
+{
+    juce::AudioBuffer<float> ir(numChannels, numSamples);
+
+    juce::Random random(seed);
+    for (int ch = 0; ch < numChannels; ++ch)
+    {
+        float* h { ir.getWritePointer(ch) };
+        for (int n = 0; n < numSamples; ++n)
+            h[n] = 0.1f * (2.f * random.nextFloat() - 1.f) * std::pow(0.001f, static_cast<float>(n) / static_cast<float>(numSamples));
+    }
+
+    return ir;
+}
+
+RunResult render(ShimmerAudioProcessor& processor, const juce::AudioBuffer<float>& input, juce::AudioBuffer<float>& output,
+                 const Options& options, int blockSize)
+{
+    using Clock = std::chrono::steady_clock;
+
+    const int numChannels { input.getNumChannels() };
+    const int numSamples { input.getNumSamples() };
+
+    // Render as a non real-time bounce, which enables the parallel paths
+    processor.setNonRealtime(options.parallel);
+    processor.setPlayConfigDetails(numChannels, numChannels, options.sampleRate, blockSize);
+    processor.prepareToPlay(options.sampleRate, blockSize);
+
+    DSP::StageProfiler profiler;
+    processor.setStageProfiler(&profiler);
+
+    output.makeCopyOf(input);
+
+    juce::MidiBuffer midi;
+    juce::Random random(options.seed);
+
+    std::vector<double> blockUs;
+    blockUs.reserve(static_cast<size_t>(numSamples));
+
+    const uint64_t startTicks { DSP::StageProfiler::now() };
+    const auto startTime { Clock::now() };
+
+    for (int pos = 0; pos < numSamples;)
+    {
+        int n { options.randomBlocks ? 1 + random.nextInt(blockSize) : blockSize };
+        n = std::min(n, numSamples - pos);
+
+        juce::AudioBuffer<float> block(output.getArrayOfWritePointers(), numChannels, pos, n);
+
+        const auto blockStart { Clock::now() };
+        processor.processBlock(block, midi);
+        const auto blockEnd { Clock::now() };
+
+        blockUs.push_back(std::chrono::duration<double, std::micro>(blockEnd - blockStart).count());
+        pos += n;
+    }
+
+    const auto endTime { Clock::now() };
+    const uint64_t endTicks { DSP::StageProfiler::now() };
+
+    processor.setStageProfiler(nullptr);
+    processor.releaseResources();
+
+    RunResult result;
+    result.blockSize = blockSize;
+
+    const double elapsedSec { std::chrono::duration<double>(endTime - startTime).count() };
+    result.realTimeFactor = (static_cast<double>(numSamples) / options.sampleRate) / std::max(elapsedSec, 1e-12);
+
+    std::sort(blockUs.begin(), blockUs.end());
+    result.p50Us = percentile(blockUs, 0.50);
+    result.p99Us = percentile(blockUs, 0.99);
+    result.maxUs = blockUs.empty() ? 0.0 : blockUs.back();
+
+    const double numSampleFrames { static_cast<double>(std::max(numSamples, 1)) };
+    for (unsigned int s = 0; s < DSP::StageProfiler::NumStages; ++s)
+        result.stageTicksPerSample[s] = static_cast<double>(profiler.getTicks(static_cast<DSP::StageProfiler::Stage>(s))) / numSampleFrames;
+    result.totalTicksPerSample = static_cast<double>(endTicks - startTicks) / numSampleFrames;
+
+    return result;
+}
+
+void printResults(const std::vector<RunResult>& results, const Options& options)
+{
+    const char* unit { DSP::StageProfiler::TicksAreCycles ? "cycles/sample" : "ns/sample" };
+
+    std::printf("\nShimmer offline benchmark: %.1f s @ %.0f Hz, %s blocks, %s\n",
+                options.seconds, options.sampleRate, options.randomBlocks ? "random" : "fixed",
+                options.parallel ? "parallel" : "serial");
+
+    std::printf("\n%8s %10s %10s %10s %10s\n", "block", "RTF", "p50 [us]", "p99 [us]", "max [us]");
+    for (const auto& r : results)
+        std::printf("%8d %10.1f %10.2f %10.2f %10.2f\n", r.blockSize, r.realTimeFactor, r.p50Us, r.p99Us, r.maxUs);
+
+    std::printf("\nStage cost in %s\n", unit);
+    std::printf("%8s", "block");
+    for (unsigned int s = 0; s < DSP::StageProfiler::NumStages; ++s)
+        std::printf(" %20s", DSP::StageProfiler::getStageName(static_cast<DSP::StageProfiler::Stage>(s)));
+    std::printf(" %20s\n", "Total");
+
+    for (const auto& r : results)
+    {
+        std::printf("%8d", r.blockSize);
+        for (unsigned int s = 0; s < DSP::StageProfiler::NumStages; ++s)
+            std::printf(" %20.1f", r.stageTicksPerSample[s]);
+        std::printf(" %20.1f\n", r.totalTicksPerSample);
+    }
+}
+
+// Chunked KeithBarrReverb ring against the sample by sample reference
+bool verifyKeithBarrRing(const juce::AudioBuffer<float>& input, const Options& options)
+{
+    const unsigned int numChannels { static_cast<unsigned int>(input.getNumChannels()) };
+    const int numSamples { input.getNumSamples() };
+
+    DSP::KeithBarrReverb chunked(numChannels, 0.6f);
+    DSP::KeithBarrReverb reference(numChannels, 0.6f);
+    chunked.prepare(options.sampleRate, numChannels);
+    reference.prepare(options.sampleRate, numChannels);
+    chunked.setDampingCoeff(0.6f);
+    reference.setDampingCoeff(0.6f);
+
+    juce::AudioBuffer<float> chunkedOut;
+    juce::AudioBuffer<float> referenceOut;
+    chunkedOut.makeCopyOf(input);
+    referenceOut.makeCopyOf(input);
+
+    juce::Random random(options.seed);
+    for (int pos = 0; pos < numSamples;)
+    {
+        const int n { std::min(1 + random.nextInt(1024), numSamples - pos) };
+
+        juce::AudioBuffer<float> a(chunkedOut.getArrayOfWritePointers(), static_cast<int>(numChannels), pos, n);
+        juce::AudioBuffer<float> b(referenceOut.getArrayOfWritePointers(), static_cast<int>(numChannels), pos, n);
+        chunked.process(a.getArrayOfWritePointers(), a.getArrayOfReadPointers(), numChannels, static_cast<unsigned int>(n));
+        reference.processPerSample(b.getArrayOfWritePointers(), b.getArrayOfReadPointers(), numChannels, 0, static_cast<unsigned int>(n));
+
+        pos += n;
+    }
+
+    for (unsigned int ch = 0; ch < numChannels; ++ch)
+        if (std::memcmp(chunkedOut.getReadPointer(static_cast<int>(ch)), referenceOut.getReadPointer(static_cast<int>(ch)),
+                        sizeof(float) * static_cast<size_t>(numSamples)) != 0)
+            return false;
+
+    return true;
+}
+
+// GranularPitchShifter output must not depend on how the input is split in blocks
+bool verifyPitchShifterBlockSize(const juce::AudioBuffer<float>& input, const Options& options)
+{
+    const unsigned int numChannels { static_cast<unsigned int>(input.getNumChannels()) };
+    const int numSamples { input.getNumSamples() };
+
+    DSP::GranularPitchShifter fixed(20.f, numChannels);
+    DSP::GranularPitchShifter varying(20.f, numChannels);
+    fixed.prepare(options.sampleRate);
+    varying.prepare(options.sampleRate);
+    fixed.setPitchRatio(2.f);
+    varying.setPitchRatio(2.f);
+
+    juce::AudioBuffer<float> fixedOut;
+    juce::AudioBuffer<float> varyingOut;
+    fixedOut.makeCopyOf(input);
+    varyingOut.makeCopyOf(input);
+
+    for (int pos = 0; pos < numSamples;)
+    {
+        const int n { std::min(256, numSamples - pos) };
+        juce::AudioBuffer<float> a(fixedOut.getArrayOfWritePointers(), static_cast<int>(numChannels), pos, n);
+        fixed.process(a.getArrayOfWritePointers(), a.getArrayOfReadPointers(), numChannels, static_cast<unsigned int>(n));
+        pos += n;
+    }
+
+    juce::Random random(options.seed);
+    for (int pos = 0; pos < numSamples;)
+    {
+        const int n { std::min(1 + random.nextInt(1024), numSamples - pos) };
+        juce::AudioBuffer<float> b(varyingOut.getArrayOfWritePointers(), static_cast<int>(numChannels), pos, n);
+        varying.process(b.getArrayOfWritePointers(), b.getArrayOfReadPointers(), numChannels, static_cast<unsigned int>(n));
+        pos += n;
+    }
+
+    for (unsigned int ch = 0; ch < numChannels; ++ch)
+        if (std::memcmp(fixedOut.getReadPointer(static_cast<int>(ch)), varyingOut.getReadPointer(static_cast<int>(ch)),
+                        sizeof(float) * static_cast<size_t>(numSamples)) != 0)
+            return false;
+
+    return true;
+}
+
+// Shimmer with the second pitch shifter on the worker thread against the serial one
+bool verifyShimmerParallel(const juce::AudioBuffer<float>& input, const Options& options)
+{
+    const unsigned int numChannels { static_cast<unsigned int>(input.getNumChannels()) };
+    const int numSamples { input.getNumSamples() };
+    const int blockSize { 2048 };
+
+    DSP::Shimmer serial(100.f, 5.f, numChannels);
+    DSP::Shimmer parallel(100.f, 5.f, numChannels);
+    serial.prepare(options.sampleRate, 100.f, numChannels, static_cast<unsigned int>(blockSize));
+    parallel.prepare(options.sampleRate, 100.f, numChannels, static_cast<unsigned int>(blockSize));
+    parallel.setParallelEnabled(true);
+    parallel.setParallelMinBlockSamples(1);
+
+    juce::AudioBuffer<float> serialOut;
+    juce::AudioBuffer<float> parallelOut;
+    serialOut.makeCopyOf(input);
+    parallelOut.makeCopyOf(input);
+
+    for (int pos = 0; pos < numSamples; pos += blockSize)
+    {
+        const int n { std::min(blockSize, numSamples - pos) };
+        juce::AudioBuffer<float> a(serialOut.getArrayOfWritePointers(), static_cast<int>(numChannels), pos, n);
+        juce::AudioBuffer<float> b(parallelOut.getArrayOfWritePointers(), static_cast<int>(numChannels), pos, n);
+        serial.process(a.getArrayOfWritePointers(), a.getArrayOfReadPointers(), numChannels, static_cast<unsigned int>(n));
+        parallel.process(b.getArrayOfWritePointers(), b.getArrayOfReadPointers(), numChannels, static_cast<unsigned int>(n));
+    }
+
+    parallel.setParallelEnabled(false);
+
+    for (unsigned int ch = 0; ch < numChannels; ++ch)
+        if (std::memcmp(serialOut.getReadPointer(static_cast<int>(ch)), parallelOut.getReadPointer(static_cast<int>(ch)),
+                        sizeof(float) * static_cast<size_t>(numSamples)) != 0)
+            return false;
+
+    return true;
+}
+
+// Every lane of a DattorroReverbBank against a DattorroReverb with the same settings
+bool verifyDattorroBank(const juce::AudioBuffer<float>& input, const Options& options)
+{
+    constexpr unsigned int numLanes { 4 };
+    const unsigned int numChannels { static_cast<unsigned int>(input.getNumChannels()) };
+    const int numSamples { input.getNumSamples() };
+    const int blockSize { 256 };
+
+    DSP::DattorroReverbBank bank(numLanes, 0.5f, 0.5f);
+    bank.prepare(options.sampleRate);
+
+    std::vector<std::unique_ptr<DSP::DattorroReverb>> reverbs;
+    std::vector<juce::AudioBuffer<float>> bankOut(numLanes);
+    std::vector<juce::AudioBuffer<float>> reverbOut(numLanes);
+    for (unsigned int l = 0; l < numLanes; ++l)
+    {
+        const float brightness { 0.2f + 0.2f * static_cast<float>(l) };
+        const float decay { 0.3f + 0.15f * static_cast<float>(l) };
+
+        reverbs.push_back(std::make_unique<DSP::DattorroReverb>(48000.0, numChannels, 0.5f, 0.5f));
+        reverbs.back()->prepare(options.sampleRate, numChannels);
+        reverbs.back()->setBrightness(brightness);
+        reverbs.back()->setDecay(decay);
+        bank.setBrightness(l, brightness);
+        bank.setDecay(l, decay);
+
+        // Each lane gets a differently scaled copy of the input
+        bankOut[l].makeCopyOf(input);
+        bankOut[l].applyGain(1.f / static_cast<float>(l + 1));
+        reverbOut[l].makeCopyOf(bankOut[l]);
+    }
+
+    for (int pos = 0; pos < numSamples; pos += blockSize)
+    {
+        const int n { std::min(blockSize, numSamples - pos) };
+
+        // Reserved upfront, the bank keeps pointers into the block buffers
+        std::vector<juce::AudioBuffer<float>> blocks;
+        blocks.reserve(numLanes);
+        for (unsigned int l = 0; l < numLanes; ++l)
+        {
+            juce::AudioBuffer<float> a(reverbOut[l].getArrayOfWritePointers(), static_cast<int>(numChannels), pos, n);
+            reverbs[l]->process(a.getArrayOfWritePointers(), a.getArrayOfReadPointers(), numChannels, static_cast<unsigned int>(n));
+
+            blocks.emplace_back(bankOut[l].getArrayOfWritePointers(), static_cast<int>(numChannels), pos, n);
+            bank.setLaneBuffers(l, blocks.back().getArrayOfWritePointers(), numChannels);
+        }
+
+        bank.process(static_cast<unsigned int>(n));
+    }
+
+    for (unsigned int l = 0; l < numLanes; ++l)
+        for (unsigned int ch = 0; ch < numChannels; ++ch)
+            if (std::memcmp(bankOut[l].getReadPointer(static_cast<int>(ch)), reverbOut[l].getReadPointer(static_cast<int>(ch)),
+                            sizeof(float) * static_cast<size_t>(numSamples)) != 0)
+                return false;
+
+    return true;
+}
+
+// Direct form I biquad cascade in double precision, the reference the ParametricEqualizer
+// forms are checked against
+class DirectFormIReference
+{
+public:
+    using Coeffs = std::array<double, DSP::Biquad::CoeffsPerSection>;
+
+    DirectFormIReference(const std::vector<Coeffs>& sectionCoeffs, unsigned int numChannels) :
+        coeffs { sectionCoeffs },
+        states(coeffs.size() * numChannels * 4, 0.0)
+    {
+    }
+
+    // Same float coefficients as the equalizer biquads
+    static std::vector<Coeffs> getBandCoeffs(const DSP::ParametricEqualizer& eq, unsigned int numBands)
+    {
+        std::vector<Coeffs> bandCoeffs;
+        for (unsigned int b = 0; b < numBands; ++b)
+        {
+            const std::array<float, DSP::Biquad::CoeffsPerSection> k { eq.getBandCoeffs(b) };
+            bandCoeffs.push_back({ k[0], k[1], k[2], k[3], k[4] });
+        }
+        return bandCoeffs;
+    }
+
+    // Audio EQ cookbook coefficients of a band computed in double precision, the response the
+    // float coefficients of the biquads drift from at low frequencies and high resonances
+    static Coeffs calculateCoeffs(DSP::ParametricEqualizer::FilterType type, double freq, double reso, double gain, double sampleRate)
+    {
+        using FilterType = DSP::ParametricEqualizer::FilterType;
+
+        const double A { std::pow(10.0, gain / 40.0) };
+        const double omega { 2.0 * juce::MathConstants<double>::pi * freq / sampleRate };
+        const double coso { std::cos(omega) };
+        const double alpha { std::sin(omega) / (2.0 * reso) };
+        const double beta { 2.0 * std::sqrt(A) * alpha };
+
+        // b0, b1, b2, a0, a1, a2
+        double k[6] { 1.0, 0.0, 0.0, 1.0, 0.0, 0.0 };
+        switch (type)
+        {
+        case FilterType::HighPass:
+            k[0] = (1.0 + coso) / 2.0; k[1] = -(1.0 + coso); k[2] = (1.0 + coso) / 2.0;
+            k[3] = 1.0 + alpha; k[4] = -2.0 * coso; k[5] = 1.0 - alpha;
+            break;
+
+        case FilterType::LowShelf:
+            k[0] = A * ((A + 1.0) - (A - 1.0) * coso + beta);
+            k[1] = 2.0 * A * ((A - 1.0) - (A + 1.0) * coso);
+            k[2] = A * ((A + 1.0) - (A - 1.0) * coso - beta);
+            k[3] = (A + 1.0) + (A - 1.0) * coso + beta;
+            k[4] = -2.0 * ((A - 1.0) + (A + 1.0) * coso);
+            k[5] = (A + 1.0) + (A - 1.0) * coso - beta;
+            break;
+
+        case FilterType::Peak:
+            k[0] = 1.0 + alpha * A; k[1] = -2.0 * coso; k[2] = 1.0 - alpha * A;
+            k[3] = 1.0 + alpha / A; k[4] = -2.0 * coso; k[5] = 1.0 - alpha / A;
+            break;
+
+        case FilterType::LowPass:
+            k[0] = (1.0 - coso) / 2.0; k[1] = 1.0 - coso; k[2] = (1.0 - coso) / 2.0;
+            k[3] = 1.0 + alpha; k[4] = -2.0 * coso; k[5] = 1.0 - alpha;
+            break;
+
+        case FilterType::HighShelf:
+            k[0] = A * ((A + 1.0) + (A - 1.0) * coso + beta);
+            k[1] = -2.0 * A * ((A - 1.0) + (A + 1.0) * coso);
+            k[2] = A * ((A + 1.0) + (A - 1.0) * coso - beta);
+            k[3] = (A + 1.0) - (A - 1.0) * coso + beta;
+            k[4] = 2.0 * ((A - 1.0) - (A + 1.0) * coso);
+            k[5] = (A + 1.0) - (A - 1.0) * coso - beta;
+            break;
+
+        default: break;
+        }
+
+        return { k[0] / k[3], k[1] / k[3], k[2] / k[3], k[4] / k[3], k[5] / k[3] };
+    }
+
+    void process(float* const* output, const float* const* input, unsigned int numChannels, unsigned int numSamples)
+    {
+        const size_t numSections { coeffs.size() };
+        for (unsigned int c = 0; c < numChannels; ++c)
+        {
+            for (unsigned int n = 0; n < numSamples; ++n)
+            {
+                double x { input[c][n] };
+                for (size_t s = 0; s < numSections; ++s)
+                {
+                    // [x1, x2, y1, y2] of the section
+                    double* const z { states.data() + (c * numSections + s) * 4 };
+                    const Coeffs& k { coeffs[s] };
+
+                    const double y { k[0] * x + k[1] * z[0] + k[2] * z[1] - k[3] * z[2] - k[4] * z[3] };
+                    z[1] = z[0];
+                    z[0] = x;
+                    z[3] = z[2];
+                    z[2] = y;
+                    x = y;
+                }
+                output[c][n] = static_cast<float>(x);
+            }
+        }
+    }
+
+private:
+    std::vector<Coeffs> coeffs;
+    std::vector<double> states;
+};
+
+// Largest difference between two buffers relative to the peak of the reference
+double getRelativeError(const juce::AudioBuffer<float>& output, const juce::AudioBuffer<float>& reference)
+{
+    double maxError { 0.0 };
+    double peak { 0.0 };
+    for (int ch = 0; ch < reference.getNumChannels(); ++ch)
+    {
+        const float* x { output.getReadPointer(ch) };
+        const float* y { reference.getReadPointer(ch) };
+        for (int n = 0; n < reference.getNumSamples(); ++n)
+        {
+            maxError = std::max(maxError, static_cast<double>(std::abs(x[n] - y[n])));
+            peak = std::max(peak, static_cast<double>(std::abs(y[n])));
+        }
+    }
+
+    return peak > 0.0 ? maxError / peak : maxError;
+}
+
+// ParametricEqualizer modes against direct form I references, for every filter type at low,
+// mid and high frequencies, low and high resonances, boosts and cuts.
+// The transposed direct form II biquads run the same float coefficients as their reference and
+// only round differently. Their round-off grows as the cutoff falls relative to the sample rate,
+// to about -57dB of the reference peak for a 100Hz shelf at a Q of 4 at 192kHz, so they have to
+// match within -50dB.
+// The smoothed mode state variable filters compute their coefficients on their own, with a tan()
+// table. Float biquad coefficients drift from the exact response at low frequencies and high
+// resonances, by -60dB for a 100Hz shelf at a Q of 4 and more below, so the smoothed mode is
+// checked against double precision cookbook coefficients instead, within -80dB.
+bool verifyEqualizerFilterTypes(const juce::AudioBuffer<float>& input, const Options& options)
+{
+    using FilterType = DSP::ParametricEqualizer::FilterType;
+
+    constexpr FilterType filterTypes[] { FilterType::Flat, FilterType::HighPass, FilterType::LowShelf,
+                                         FilterType::Peak, FilterType::LowPass, FilterType::HighShelf };
+    constexpr float frequencies[] { 100.f, 1000.f, 10000.f };
+    constexpr float resonances[] { 0.7071f, 4.f };
+    constexpr float gains[] { 6.f, -12.f };
+    constexpr double engineTolerance { 3.16e-3 };
+    constexpr double smoothedTolerance { 1e-4 };
+
+    const unsigned int numChannels { static_cast<unsigned int>(input.getNumChannels()) };
+    const int numSamples { input.getNumSamples() };
+
+    for (FilterType type : filterTypes)
+    {
+        for (float frequency : frequencies)
+        {
+            for (float resonance : resonances)
+            {
+                for (float gain : gains)
+                {
+                    DSP::ParametricEqualizer engine(1, numChannels);
+                    DSP::ParametricEqualizer smoothed(1, numChannels);
+                    for (DSP::ParametricEqualizer* eq : { &engine, &smoothed })
+                    {
+                        eq->prepare(options.sampleRate, numChannels);
+                        eq->setBandType(0, type);
+                        eq->setBandFrequency(0, frequency);
+                        eq->setBandResonance(0, resonance);
+                        eq->setBandGain(0, gain);
+                    }
+                    smoothed.setSmoothing(true);
+
+                    DirectFormIReference engineReference(DirectFormIReference::getBandCoeffs(engine, 1), numChannels);
+                    DirectFormIReference smoothedReference({ DirectFormIReference::calculateCoeffs(type, frequency, resonance, gain, options.sampleRate) },
+                                                           numChannels);
+
+                    juce::AudioBuffer<float> engineOut;
+                    juce::AudioBuffer<float> smoothedOut;
+                    juce::AudioBuffer<float> engineReferenceOut;
+                    juce::AudioBuffer<float> smoothedReferenceOut;
+                    engineOut.makeCopyOf(input);
+                    smoothedOut.makeCopyOf(input);
+                    engineReferenceOut.makeCopyOf(input);
+                    smoothedReferenceOut.makeCopyOf(input);
+
+                    juce::Random random(options.seed);
+                    for (int pos = 0; pos < numSamples;)
+                    {
+                        const int n { std::min(1 + random.nextInt(1024), numSamples - pos) };
+
+                        juce::AudioBuffer<float> a(engineOut.getArrayOfWritePointers(), static_cast<int>(numChannels), pos, n);
+                        juce::AudioBuffer<float> b(smoothedOut.getArrayOfWritePointers(), static_cast<int>(numChannels), pos, n);
+                        juce::AudioBuffer<float> c(engineReferenceOut.getArrayOfWritePointers(), static_cast<int>(numChannels), pos, n);
+                        juce::AudioBuffer<float> d(smoothedReferenceOut.getArrayOfWritePointers(), static_cast<int>(numChannels), pos, n);
+                        engine.process(a.getArrayOfWritePointers(), a.getArrayOfReadPointers(), numChannels, static_cast<unsigned int>(n));
+                        smoothed.process(b.getArrayOfWritePointers(), b.getArrayOfReadPointers(), numChannels, static_cast<unsigned int>(n));
+                        engineReference.process(c.getArrayOfWritePointers(), c.getArrayOfReadPointers(), numChannels, static_cast<unsigned int>(n));
+                        smoothedReference.process(d.getArrayOfWritePointers(), d.getArrayOfReadPointers(), numChannels, static_cast<unsigned int>(n));
+
+                        pos += n;
+                    }
+
+                    if (getRelativeError(engineOut, engineReferenceOut) > engineTolerance
+                        || getRelativeError(smoothedOut, smoothedReferenceOut) > smoothedTolerance)
+                        return false;
+                }
+            }
+        }
+    }
+
+    return true;
+}
+
+// Smoothed mode with the frequency and gain of every filter type jumping to random targets
+// every 1.3 to 10.7ms block, while a 200Hz sine plays. The output has to stay finite and below
+// the boost times the resonance, and the glides must not click: with cutoffs up to 1kHz, the
+// output never moves further between two samples than a 1kHz sine of the output peak does,
+// where the same steps without smoothing jump 2 to 13 times past it.
+bool verifyEqualizerGlide(const juce::AudioBuffer<float>& input, const Options& options)
+{
+    using FilterType = DSP::ParametricEqualizer::FilterType;
+
+    constexpr FilterType filterTypes[] { FilterType::HighPass, FilterType::LowShelf, FilterType::Peak,
+                                         FilterType::LowPass, FilterType::HighShelf };
+    constexpr double minFrequency { 100.0 };
+    constexpr double maxFrequency { 1000.0 };
+    constexpr float maxGain { 12.f };
+    constexpr float resonance { 4.f };
+    constexpr float inputLevel { 0.5f };
+
+    const unsigned int numChannels { static_cast<unsigned int>(input.getNumChannels()) };
+    const int numSamples { input.getNumSamples() };
+
+    const double w { juce::MathConstants<double>::twoPi * maxFrequency / options.sampleRate };
+    const int minBlockSamples { juce::roundToInt(64.0 * options.sampleRate / 48000.0) };
+    const double maxPeak { inputLevel * juce::Decibels::decibelsToGain(maxGain) * resonance };
+
+    for (FilterType type : filterTypes)
+    {
+        DSP::ParametricEqualizer eq(1, numChannels);
+        eq.prepare(options.sampleRate, numChannels);
+        eq.setSmoothing(true);
+        eq.setBandType(0, type);
+        eq.setBandResonance(0, resonance);
+
+        juce::AudioBuffer<float> output(static_cast<int>(numChannels), numSamples);
+        for (unsigned int ch = 0; ch < numChannels; ++ch)
+            for (int n = 0; n < numSamples; ++n)
+                output.setSample(static_cast<int>(ch), n, inputLevel * static_cast<float>(std::sin(juce::MathConstants<double>::twoPi * 200.0 * n / options.sampleRate)));
+
+        juce::Random random(options.seed);
+        for (int pos = 0; pos < numSamples;)
+        {
+            const int blockSamples { minBlockSamples + random.nextInt(7 * minBlockSamples + 1) };
+            const int n { std::min(blockSamples, numSamples - pos) };
+
+            // Glides take a whole block, a truncated last block keeps its targets
+            if (n == blockSamples)
+            {
+                eq.setBandFrequency(0, static_cast<float>(minFrequency * std::pow(maxFrequency / minFrequency, random.nextDouble())));
+                eq.setBandGain(0, maxGain * (2.f * random.nextFloat() - 1.f));
+            }
+
+            juce::AudioBuffer<float> block(output.getArrayOfWritePointers(), static_cast<int>(numChannels), pos, n);
+            eq.process(block.getArrayOfWritePointers(), block.getArrayOfReadPointers(), numChannels, static_cast<unsigned int>(n));
+            pos += n;
+        }
+
+        for (unsigned int ch = 0; ch < numChannels; ++ch)
+        {
+            const float* y { output.getReadPointer(static_cast<int>(ch)) };
+
+            double peak { 0.0 };
+            double maxDifference { 0.0 };
+            for (int n = 0; n < numSamples; ++n)
+            {
+                if (!std::isfinite(y[n]))
+                    return false;
+
+                peak = std::max(peak, static_cast<double>(std::abs(y[n])));
+                if (n >= 1)
+                    maxDifference = std::max(maxDifference, static_cast<double>(std::abs(y[n] - y[n - 1])));
+            }
+
+            if (peak > maxPeak || maxDifference > w * peak)
+                return false;
+        }
+    }
+
+    return true;
+}
+
+// Partitioned convolution against a direct convolution, with a response long enough to reach
+// the late segment and random block sizes. The FFTs round differently from the direct sum,
+// so the output only has to match within -80dB of the reference peak.
+bool verifyConvolutionReverb(const juce::AudioBuffer<float>& input, const Options& options)
+{
+    constexpr int irSamples { 3 * static_cast<int>(DSP::ConvolutionReverb::LateBlockSamples) };
+    constexpr double tolerance { 1e-4 };
+
+    const unsigned int numChannels { static_cast<unsigned int>(input.getNumChannels()) };
+    const int numSamples { std::min(input.getNumSamples(), irSamples + 2 * static_cast<int>(DSP::ConvolutionReverb::LateBlockSamples)) };
+    const juce::AudioBuffer<float> ir { makeImpulseResponse(static_cast<int>(numChannels), irSamples, options.seed) };
+
+    DSP::ConvolutionReverb reverb(numChannels);
+    reverb.prepare(options.sampleRate);
+    reverb.setImpulseResponse(ir.getArrayOfReadPointers(), numChannels, static_cast<unsigned int>(irSamples));
+
+    juce::AudioBuffer<float> output(static_cast<int>(numChannels), numSamples);
+    for (unsigned int ch = 0; ch < numChannels; ++ch)
+        output.copyFrom(static_cast<int>(ch), 0, input, static_cast<int>(ch), 0, numSamples);
+
+    juce::Random random(options.seed);
+    for (int pos = 0; pos < numSamples;)
+    {
+        const int n { std::min(1 + random.nextInt(1024), numSamples - pos) };
+        juce::AudioBuffer<float> block(output.getArrayOfWritePointers(), static_cast<int>(numChannels), pos, n);
+        reverb.process(block.getArrayOfWritePointers(), block.getArrayOfReadPointers(), numChannels, static_cast<unsigned int>(n));
+        pos += n;
+    }
+
+    for (unsigned int ch = 0; ch < numChannels; ++ch)
+    {
+        const float* x { input.getReadPointer(static_cast<int>(ch)) };
+        const float* h { ir.getReadPointer(static_cast<int>(ch)) };
+        const float* y { output.getReadPointer(static_cast<int>(ch)) };
+
+        std::vector<double> reference(static_cast<size_t>(numSamples), 0.0);
+        for (int n = 0; n < numSamples; ++n)
+            for (int k = 0; k < std::min(n + 1, irSamples); ++k)
+                reference[static_cast<size_t>(n)] += static_cast<double>(h[k]) * x[n - k];
+
+        double maxError { 0.0 };
+        double peak { 0.0 };
+        for (int n = 0; n < numSamples; ++n)
+        {
+            maxError = std::max(maxError, std::abs(y[n] - reference[static_cast<size_t>(n)]));
+            peak = std::max(peak, std::abs(reference[static_cast<size_t>(n)]));
+        }
+
+        if (maxError > tolerance * peak)
+            return false;
+    }
+
+    return true;
+}
+
+// Parameter events pushed at sample offsets of one long block must match
+// splitting the block by hand at the same offsets
+bool verifySampleAccurateEvents(const juce::AudioBuffer<float>& input, const Options& options)
+{
+    const int numChannels { input.getNumChannels() };
+    const int numSamples { std::min(input.getNumSamples(), 4096) };
+
+    struct Event
+    {
+        const juce::String& ID;
+        float value;
+        int sampleOffset;
+    };
+
+    // Offsets on the slice grid and further apart than the minimum sub-block
+    const Event events[] {
+        { Param::ID::Shift1, 1.5f, 512 },
+        { Param::ID::Buildup, 40.f, 1040 },
+        { Param::ID::Shift1, 3.f, 1040 },
+        { Param::ID::Buildup, 5.f, 3008 }
+    };
+
+    ShimmerAudioProcessor accurate;
+    ShimmerAudioProcessor split;
+    for (auto* processor : { &accurate, &split })
+    {
+        processor->setPlayConfigDetails(numChannels, numChannels, options.sampleRate, numSamples);
+        processor->prepareToPlay(options.sampleRate, numSamples);
+    }
+
+    juce::AudioBuffer<float> accurateOut(numChannels, numSamples);
+    juce::AudioBuffer<float> splitOut(numChannels, numSamples);
+    for (int ch = 0; ch < numChannels; ++ch)
+    {
+        accurateOut.copyFrom(ch, 0, input, ch, 0, numSamples);
+        splitOut.copyFrom(ch, 0, input, ch, 0, numSamples);
+    }
+
+    juce::MidiBuffer midi;
+
+    // One block, events at their offsets
+    auto& accurateParameters { accurate.getParameterManager() };
+    for (const auto& e : events)
+        accurateParameters.pushParameterEvent(accurateParameters.getParameterIndex(e.ID), e.value, e.sampleOffset);
+    accurate.processBlock(accurateOut, midi);
+
+    // Blocks ending at the events, events at the start of the next block
+    auto& splitParameters { split.getParameterManager() };
+    int pos { 0 };
+    for (size_t i = 0; i <= std::size(events); ++i)
+    {
+        const int end { i < std::size(events) ? events[i].sampleOffset : numSamples };
+        if (end > pos)
+        {
+            juce::AudioBuffer<float> block(splitOut.getArrayOfWritePointers(), numChannels, pos, end - pos);
+            split.processBlock(block, midi);
+            pos = end;
+        }
+
+        if (i < std::size(events))
+            splitParameters.pushParameterEvent(splitParameters.getParameterIndex(events[i].ID), events[i].value, 0);
+    }
+
+    accurate.releaseResources();
+    split.releaseResources();
+
+    for (int ch = 0; ch < numChannels; ++ch)
+        if (std::memcmp(accurateOut.getReadPointer(ch), splitOut.getReadPointer(ch), sizeof(float) * static_cast<size_t>(numSamples)) != 0)
+            return false;
+
+    return true;
+}
+
+// Parameter events the last slice of a block cannot split at, closer than the minimum
+// sub-block to its start or in an empty block, must still apply before the next block,
+// the same as events pushed at the start of the next block
+bool verifyEndOfBlockEvents(const juce::AudioBuffer<float>& input, const Options& options)
+{
+    const int numChannels { input.getNumChannels() };
+    const int blockSize { 512 };
+    const int numSamples { std::min(input.getNumSamples() / blockSize, 4) * blockSize };
+    if (numSamples < 2 * blockSize)
+        return false;
+
+    // A first change 8 samples before the end of the first block starts the last slice there,
+    // a second change 4 samples later is then within the minimum sub-block of that start
+    const auto render = [&](int mode)
+    {
+        ShimmerAudioProcessor processor;
+        processor.setPlayConfigDetails(numChannels, numChannels, options.sampleRate, blockSize);
+        processor.prepareToPlay(options.sampleRate, blockSize);
+
+        auto& parameters { processor.getParameterManager() };
+        const int index { parameters.getParameterIndex(Param::ID::Shift1) };
+
+        juce::AudioBuffer<float> output(numChannels, numSamples);
+        for (int ch = 0; ch < numChannels; ++ch)
+            output.copyFrom(ch, 0, input, ch, 0, numSamples);
+
+        juce::MidiBuffer midi;
+        for (int pos = 0; pos < numSamples; pos += blockSize)
+        {
+            if (pos == 0)
+            {
+                parameters.pushParameterEvent(index, 1.5f, blockSize - 8);
+                // 0: second change inside the first block
+                if (mode == 0)
+                    parameters.pushParameterEvent(index, 3.f, blockSize - 4);
+            }
+
+            // 1: second change in an empty block between the first two
+            if (pos == blockSize && mode == 1)
+            {
+                parameters.pushParameterEvent(index, 3.f, 0);
+                juce::AudioBuffer<float> empty(numChannels, 0);
+                processor.processBlock(empty, midi);
+            }
+
+            // 2: second change at the start of the second block
+            if (pos == blockSize && mode == 2)
+                parameters.pushParameterEvent(index, 3.f, 0);
+
+            juce::AudioBuffer<float> block(output.getArrayOfWritePointers(), numChannels, pos, blockSize);
+            processor.processBlock(block, midi);
+        }
+
+        processor.releaseResources();
+        return output;
+    };
+
+    const juce::AudioBuffer<float> lastSample { render(0) };
+    const juce::AudioBuffer<float> emptyBlock { render(1) };
+    const juce::AudioBuffer<float> nextBlock { render(2) };
+
+    for (int ch = 0; ch < numChannels; ++ch)
+    {
+        const size_t bytes { sizeof(float) * static_cast<size_t>(numSamples) };
+        if (std::memcmp(lastSample.getReadPointer(ch), nextBlock.getReadPointer(ch), bytes) != 0
+            || std::memcmp(emptyBlock.getReadPointer(ch), nextBlock.getReadPointer(ch), bytes) != 0)
+            return false;
+    }
+
+    return true;
+}
+
+// Run all checks, returns the process exit code
+int verify(const juce::AudioBuffer<float>& input, const Options& options)
+{
+    struct Check
+    {
+        const char* name;
+        bool (*run)(const juce::AudioBuffer<float>&, const Options&);
+    };
+
+    const Check checks[] {
+        { "KeithBarrReverb chunked ring", verifyKeithBarrRing },
+        { "GranularPitchShifter block size", verifyPitchShifterBlockSize },
+        { "Shimmer parallel pitch shifters", verifyShimmerParallel },
+        { "DattorroReverbBank lanes", verifyDattorroBank },
+        { "ParametricEqualizer filter types", verifyEqualizerFilterTypes },
+        { "ParametricEqualizer smoothed glide", verifyEqualizerGlide },
+        { "ConvolutionReverb partitions", verifyConvolutionReverb },
+        { "Sample accurate parameter events", verifySampleAccurateEvents },
+        { "Sample accurate parameter events, end of block", verifyEndOfBlockEvents }
+    };
+
+    int result { 0 };
+    for (const auto& check : checks)
+    {
+        const bool passed { check.run(input, options) };
+        std::printf("%-40s %s\n", check.name, passed ? "PASS" : "FAIL");
+        if (!passed)
+            result = 1;
+    }
+
+    return result;
+}
+
+// Render the processor like a few kinds of host would and report the allocations and
+// locks made inside its real-time sections, needs a build with MRTA_REALTIME_CHECKS
+// Returns the process exit code
+int realtimeCheck(ShimmerAudioProcessor& processor, const juce::AudioBuffer<float>& input, const Options& options)
+{
+    if (!mrta::RealtimeChecks::isEnabled())
+    {
+        std::printf("%s", mrta::RealtimeChecks::getReport().c_str());
+        return 2;
+    }
+
+    struct Scenario
+    {
+        const char* name;
+        int announcedBlockSize;
+        int maxBlockSize;
+        bool randomBlocks;
+        bool nonRealtime;
+        bool automation;
+    };
+
+    const Scenario scenarios[] {
+        { "fixed 512 sample blocks", 512, 512, false, false, false },
+        { "random blocks, automation", 512, 512, true, false, true },
+        { "blocks larger than announced", 64, 4096, false, false, false },
+        { "non-realtime 4096 sample blocks", 4096, 4096, false, true, true }
+    };
+
+    const int numChannels { input.getNumChannels() };
+    const int numSamples { input.getNumSamples() };
+
+    auto& apvts { processor.getParameterManager().getAPVTS() };
+    juce::RangedAudioParameter* const automated[] {
+        apvts.getParameter(Param::ID::Mix),
+        apvts.getParameter(Param::ID::Shift1),
+        apvts.getParameter(Param::ID::Damping),
+        apvts.getParameter(Param::ID::Decay)
+    };
+
+    juce::AudioBuffer<float> output;
+    juce::MidiBuffer midi;
+    juce::Random random(options.seed);
+
+    bool passed { true };
+    for (const auto& scenario : scenarios)
+    {
+        processor.setNonRealtime(scenario.nonRealtime);
+        processor.setPlayConfigDetails(numChannels, numChannels, options.sampleRate, scenario.announcedBlockSize);
+        processor.prepareToPlay(options.sampleRate, scenario.announcedBlockSize);
+        output.makeCopyOf(input);
+
+        mrta::RealtimeChecks::reset();
+
+        for (int pos = 0, block = 0; pos < numSamples; ++block)
+        {
+            int n { scenario.randomBlocks ? 1 + random.nextInt(scenario.maxBlockSize) : scenario.maxBlockSize };
+            n = std::min(n, numSamples - pos);
+
+            // Parameter changes arrive between blocks, like host automation
+            if (scenario.automation && (block % 8) == 0)
+                for (auto* parameter : automated)
+                    parameter->setValueNotifyingHost(random.nextFloat());
+
+            juce::AudioBuffer<float> slice(output.getArrayOfWritePointers(), numChannels, pos, n);
+            processor.processBlock(slice, midi);
+            pos += n;
+        }
+
+        processor.releaseResources();
+
+        const unsigned int numViolations { mrta::RealtimeChecks::getNumViolations() };
+        std::printf("%-40s %s\n", scenario.name, numViolations == 0 ? "PASS" : "FAIL");
+        if (numViolations > 0)
+        {
+            std::printf("%s", mrta::RealtimeChecks::getReport().c_str());
+            passed = false;
+        }
+    }
+
+    mrta::RealtimeChecks::reset();
+
+    // Summary per target
+    std::printf("\n%-40s %s\n", JucePlugin_Name, passed ? "PASS" : "FAIL");
+    return passed ? 0 : 1;
+}
+
+// Time the KB and Dattorro reverbs, run directly so no juce::ScopedNoDenormals applies,
+// over a noise burst and the silence after it, once without and once with their denormal
+// protection. Unprotected tails slow down as they decay into denormals.
+// Returns the process exit code
+int denormalTail(const Options& options)
+{
+    using Clock = std::chrono::steady_clock;
+
+    constexpr unsigned int numChannels { 2 };
+    constexpr double windowSeconds { 0.5 };
+
+    const unsigned int blockSize { static_cast<unsigned int>(options.blockSizes.front()) };
+    const unsigned int windowSamples { static_cast<unsigned int>(windowSeconds * options.sampleRate) };
+    const unsigned int numWindows { std::max(static_cast<unsigned int>(options.seconds / windowSeconds), 2u) };
+
+    // The burst fills the first window, the rest is silence
+    juce::AudioBuffer<float> burst(static_cast<int>(numChannels), static_cast<int>(windowSamples));
+    juce::Random random(options.seed);
+    for (unsigned int ch = 0; ch < numChannels; ++ch)
+        for (unsigned int n = 0; n < windowSamples; ++n)
+            burst.setSample(static_cast<int>(ch), static_cast<int>(n), 0.5f * (2.f * random.nextFloat() - 1.f));
+
+    // Make sure flush-to-zero is off, as in a plain offline tool
+    juce::FloatVectorOperations::disableDenormalisedNumberSupport(false);
+
+    std::vector<double> windowUs[2];
+    for (int safe = 0; safe < 2; ++safe)
+    {
+        DSP::KeithBarrReverb keithBarr(numChannels, Param::Ranges::DampCoeffDefault);
+        DSP::DattorroReverb dattorro(options.sampleRate, numChannels, Param::Ranges::BrightnessDefault, 0.3f);
+        keithBarr.prepare(options.sampleRate, numChannels);
+        dattorro.prepare(options.sampleRate, numChannels);
+        keithBarr.setDenormalSafe(safe != 0);
+        dattorro.setDenormalSafe(safe != 0);
+
+        juce::AudioBuffer<float> io(static_cast<int>(numChannels), static_cast<int>(blockSize));
+
+        for (unsigned int w = 0; w < numWindows; ++w)
+        {
+            double us { 0.0 };
+            for (unsigned int pos = 0; pos < windowSamples; pos += blockSize)
+            {
+                const unsigned int n { std::min(blockSize, windowSamples - pos) };
+                for (unsigned int ch = 0; ch < numChannels; ++ch)
+                {
+                    if (w == 0)
+                        io.copyFrom(static_cast<int>(ch), 0, burst, static_cast<int>(ch), static_cast<int>(pos), static_cast<int>(n));
+                    else
+                        io.clear(static_cast<int>(ch), 0, static_cast<int>(n));
+                }
+
+                float* const* ptrs { io.getArrayOfWritePointers() };
+                const auto start { Clock::now() };
+                keithBarr.process(ptrs, ptrs, numChannels, n);
+                dattorro.process(ptrs, ptrs, numChannels, n);
+                us += std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+            }
+            windowUs[safe].push_back(us);
+        }
+    }
+
+    std::printf("Denormal tail, %.0f Hz, block %u, %.1f s windows, flush-to-zero off\n",
+                options.sampleRate, blockSize, windowSeconds);
+    std::printf("%8s %14s %14s\n", "time s", "unprotected us", "protected us");
+    for (unsigned int w = 0; w < numWindows; ++w)
+        std::printf("%8.1f %14.0f %14.0f\n", w * windowSeconds, windowUs[0][w], windowUs[1][w]);
+
+    // Slowest silent window relative to the burst window
+    for (int safe = 0; safe < 2; ++safe)
+    {
+        const double slowest { *std::max_element(windowUs[safe].begin() + 1, windowUs[safe].end()) };
+        std::printf("%-12s slowest tail window %.2fx the burst window\n",
+                    safe != 0 ? "Protected" : "Unprotected", slowest / std::max(windowUs[safe].front(), 1e-9));
+    }
+
+    return 0;
+}
+
+// Decay time of a reverb in seconds from its impulse response, the T20 of the
+// Schroeder energy decay curve of both channels extrapolated to 60dB
+template <typename Reverb>
+double measureDecaySeconds(Reverb& reverb, double sampleRate, double seconds)
+{
+    constexpr unsigned int numChannels { 2 };
+    constexpr unsigned int blockSize { 256 };
+
+    const int numSamples { static_cast<int>(std::ceil(seconds * sampleRate)) };
+    juce::AudioBuffer<float> io(static_cast<int>(numChannels), numSamples);
+    io.clear();
+    io.setSample(0, 0, 1.f);
+    io.setSample(1, 0, 1.f);
+
+    for (int pos = 0; pos < numSamples; pos += static_cast<int>(blockSize))
+    {
+        juce::AudioBuffer<float> block(io.getArrayOfWritePointers(), static_cast<int>(numChannels), pos,
+                                       std::min(static_cast<int>(blockSize), numSamples - pos));
+        reverb.process(block.getArrayOfWritePointers(), block.getArrayOfReadPointers(), numChannels,
+                       static_cast<unsigned int>(block.getNumSamples()));
+    }
+
+    // Backward integrated energy
+    std::vector<double> energy(static_cast<size_t>(numSamples) + 1u, 0.0);
+    for (int n = numSamples - 1; n >= 0; --n)
+    {
+        const double left { io.getSample(0, n) };
+        const double right { io.getSample(1, n) };
+        energy[static_cast<size_t>(n)] = energy[static_cast<size_t>(n) + 1u] + left * left + right * right;
+    }
+
+    double start { -1.0 };
+    for (int n = 0; n < numSamples; ++n)
+    {
+        const double dB { 10.0 * std::log10(std::max(energy[static_cast<size_t>(n)] / energy.front(), 1e-300)) };
+        if (start < 0.0 && dB <= -5.0)
+            start = n / sampleRate;
+        if (dB <= -25.0)
+            return 3.0 * (n / sampleRate - start);
+    }
+
+    // Did not decay by 25dB within the render
+    return std::numeric_limits<double>::infinity();
+}
+
+// Render the impulse response of the KB and Dattorro reverbs at the supported sample
+// rates, their delays are set in milliseconds so the decay time must not follow the rate
+// Returns the process exit code
+int decayInvariance(const Options& options)
+{
+    constexpr double sampleRates[] { 44100.0, 48000.0, 88200.0, 96000.0, 176400.0, 192000.0 };
+    constexpr double referenceRate { 48000.0 };
+    // Delay lengths round to whole samples, so allow some drift
+    constexpr double tolerance { 0.1 };
+
+    auto measureKeithBarr = [&options](double sampleRate)
+    {
+        DSP::KeithBarrReverb reverb(2u, Param::Ranges::DampCoeffDefault);
+        reverb.prepare(sampleRate, 2u);
+        reverb.setDampingCoeff(Param::Ranges::DampCoeffDefault);
+        return measureDecaySeconds(reverb, sampleRate, options.seconds);
+    };
+
+    auto measureDattorro = [&options](double sampleRate)
+    {
+        DSP::DattorroReverb reverb(sampleRate, 2u, Param::Ranges::BrightnessDefault, 0.7f);
+        reverb.prepare(sampleRate, 2u);
+        reverb.setBrightness(Param::Ranges::BrightnessDefault);
+        reverb.setDecay(0.7f);
+        return measureDecaySeconds(reverb, sampleRate, options.seconds);
+    };
+
+    const double keithBarrReference { measureKeithBarr(referenceRate) };
+    const double dattorroReference { measureDattorro(referenceRate) };
+
+    std::printf("Decay time (T20 extrapolated to 60dB), %.1f s impulse responses\n", options.seconds);
+    std::printf("%10s %14s %14s\n", "rate Hz", "KB s", "Dattorro s");
+
+    int result { 0 };
+    for (double sampleRate : sampleRates)
+    {
+        const double keithBarr { measureKeithBarr(sampleRate) };
+        const double dattorro { measureDattorro(sampleRate) };
+        const bool passed { std::abs(keithBarr / keithBarrReference - 1.0) <= tolerance
+                            && std::abs(dattorro / dattorroReference - 1.0) <= tolerance };
+
+        std::printf("%10.0f %14.4f %14.4f %s\n", sampleRate, keithBarr, dattorro, passed ? "PASS" : "FAIL");
+        if (!passed)
+            result = 1;
+    }
+
+    return result;
+}
+
+// Run the convolution reverb over noise with a 10 s stereo impulse response, in blocks of
+// the first block size, and report its share of a core. The late partitions run on the
+// worker thread, so the load is the CPU time of the whole process, not the wall time.
+// Returns the process exit code
+int convolutionLoad(const Options& options)
+{
+    constexpr unsigned int numChannels { 2 };
+    constexpr double irSeconds { 10.0 };
+    constexpr double budget { 0.05 };
+
+    const unsigned int blockSize { static_cast<unsigned int>(options.blockSizes.front()) };
+    const int irSamples { static_cast<int>(irSeconds * options.sampleRate) };
+    const juce::AudioBuffer<float> ir { makeImpulseResponse(static_cast<int>(numChannels), irSamples, options.seed) };
+
+    DSP::ConvolutionReverb reverb(numChannels);
+    reverb.prepare(options.sampleRate);
+    reverb.setImpulseResponse(ir.getArrayOfReadPointers(), numChannels, static_cast<unsigned int>(irSamples));
+
+    // About one second of noise, looped a block at a time
+    const int noiseSamples { static_cast<int>(blockSize) * std::max(static_cast<int>(options.sampleRate) / static_cast<int>(blockSize), 1) };
+    juce::AudioBuffer<float> noise(static_cast<int>(numChannels), noiseSamples);
+    juce::Random random(options.seed);
+    for (unsigned int ch = 0; ch < numChannels; ++ch)
+        for (int n = 0; n < noiseSamples; ++n)
+            noise.setSample(static_cast<int>(ch), n, 0.5f * (2.f * random.nextFloat() - 1.f));
+
+    juce::AudioBuffer<float> io(static_cast<int>(numChannels), static_cast<int>(blockSize));
+    const int numSamples { static_cast<int>(std::ceil(options.seconds * options.sampleRate)) };
+
+    const std::clock_t start { std::clock() };
+    for (int pos = 0; pos < numSamples; pos += static_cast<int>(blockSize))
+    {
+        for (unsigned int ch = 0; ch < numChannels; ++ch)
+            io.copyFrom(static_cast<int>(ch), 0, noise, static_cast<int>(ch), pos % noiseSamples, static_cast<int>(blockSize));
+
+        reverb.process(io.getArrayOfWritePointers(), io.getArrayOfReadPointers(), numChannels, blockSize);
+    }
+    const double cpuSeconds { static_cast<double>(std::clock() - start) / CLOCKS_PER_SEC };
+
+    const double load { cpuSeconds * options.sampleRate / numSamples };
+    const bool passed { load <= budget };
+    std::printf("Convolution reverb, %.0f s stereo impulse response, %.0f Hz, block %u\n", irSeconds, options.sampleRate, blockSize);
+    std::printf("%.2f%% of a core, budget %.0f%% %s\n", 100.0 * load, 100.0 * budget, passed ? "PASS" : "FAIL");
+
+    return passed ? 0 : 1;
+}
+
+void writeOutput(const juce::File& file, const juce::AudioBuffer<float>& output, double sampleRate)
+{
+    file.deleteFile();
+
+    juce::WavAudioFormat wav;
+    std::unique_ptr<juce::OutputStream> stream { std::make_unique<juce::FileOutputStream>(file) };
+    std::unique_ptr<juce::AudioFormatWriter> writer { wav.createWriterFor(stream.get(), sampleRate,
+                                                                         static_cast<unsigned int>(output.getNumChannels()),
+                                                                         24, {}, 0) };
+    if (writer == nullptr)
+        juce::ConsoleApplication::fail("Could not write " + file.getFullPathName());
+
+    stream.release(); // now owned by the writer
+    writer->writeFromAudioSampleBuffer(output, 0, output.getNumSamples());
+}
+
+}
+
+int main(int argc, char* argv[])
+{
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+    return juce::ConsoleApplication::invokeCatchingFailures([&]
+    {
+        juce::ArgumentList args(argc, argv);
+
+        if (args.containsOption("--help|-h"))
+        {
+            printUsage();
+            return 0;
+        }
+
+        Options options { parseOptions(args) };
+
+        ShimmerAudioProcessor processor;
+        const int numChannels { std::max(processor.getMainBusNumInputChannels(), processor.getMainBusNumOutputChannels()) };
+
+        if (args.containsOption("--denormal-tail"))
+            return denormalTail(options);
+
+        if (args.containsOption("--decay-invariance"))
+            return decayInvariance(options);
+
+        if (args.containsOption("--convolution-load"))
+            return convolutionLoad(options);
+
+        const juce::AudioBuffer<float> input { loadInput(options, numChannels) };
+
+        if (args.containsOption("--verify"))
+            return verify(input, options);
+
+        if (args.containsOption("--realtime-check"))
+            return realtimeCheck(processor, input, options);
+
+        juce::AudioBuffer<float> output;
+
+        std::vector<RunResult> results;
+        for (int blockSize : options.blockSizes)
+            results.push_back(render(processor, input, output, options, blockSize));
+
+        printResults(results, options);
+
+        // Output of the last run
+        if (options.outputFile != juce::File())
+            writeOutput(options.outputFile, output, options.sampleRate);
+
+        return 0;
+    });
+}
\ No newline at end of file
@@ -0,0 +1,275 @@
+#include <JuceHeader.h>
+#include "PluginProcessor.h"
+#include "KeithBarrReverb.h"
+#include "DattorroReverb.h"
+#include "ImpulseResponseCache.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <limits>
+#include <vector>
+
+// Impulse response capture tool for the algorithmic reverbs of the Shimmer plugin
+// Renders the response of DattorroReverb for every decay and brightness grid point and of
+// KeithBarrReverb for every damping grid point, and writes them into a memory mappable
+// impulse response cache (DSP::ImpulseResponseCache).
+//
+// Usage:
+//   shimmer_ir_capture --output=<file.irc> [--sample-rate=<Hz>] [--seconds=<s>]
+//                      [--decay-steps=<n>] [--brightness-steps=<n>] [--damping-steps=<n>]
+//   shimmer_ir_capture --compare=<file.irc> [--tolerance-db=<dB>]
+//
+// Every response is rendered from a cleared reverb with a unit impulse on both channels,
+// and trimmed after it decays below TrimThreshold of its peak.
+// --compare renders the grid points of an existing cache again, at its sample rate, and
+// exits with 1 if any response differs from the cached one by more than the tolerance,
+// relative to its peak. Caches written before an optimization are its regression fingerprints.
+
+namespace
+{
+
+constexpr unsigned int NumChannels { 2 };
+constexpr unsigned int BlockSize { 256 };
+// -120dB
+constexpr float TrimThreshold { 1e-6f };
+
+struct Options
+{
+    juce::File outputFile;
+    juce::File compareFile;
+    double sampleRate { 48000.0 };
+    double seconds { 10.0 };
+    int decaySteps { 5 };
+    int brightnessSteps { 5 };
+    int dampingSteps { 5 };
+    double toleranceDb { -100.0 };
+};
+
+void printUsage()
+{
+    std::printf("Usage: shimmer_ir_capture --output=<file.irc> [--sample-rate=<Hz>] [--seconds=<s>]\n"
+                "                          [--decay-steps=<n>] [--brightness-steps=<n>] [--damping-steps=<n>]\n"
+                "       shimmer_ir_capture --compare=<file.irc> [--tolerance-db=<dB>]\n");
+}
+
+Options parseOptions(const juce::ArgumentList& args)
+{
+    Options options;
+
+    if (args.containsOption("--output"))
+        options.outputFile = args.getFileForOption("--output");
+
+    if (args.containsOption("--compare"))
+        options.compareFile = args.getExistingFileForOption("--compare");
+
+    if (args.containsOption("--sample-rate"))
+        options.sampleRate = std::max(args.getValueForOption("--sample-rate").getDoubleValue(), 8000.0);
+
+    if (args.containsOption("--seconds"))
+        options.seconds = std::max(args.getValueForOption("--seconds").getDoubleValue(), 0.1);
+
+    if (args.containsOption("--decay-steps"))
+        options.decaySteps = std::max(args.getValueForOption("--decay-steps").getIntValue(), 1);
+
+    if (args.containsOption("--brightness-steps"))
+        options.brightnessSteps = std::max(args.getValueForOption("--brightness-steps").getIntValue(), 1);
+
+    if (args.containsOption("--damping-steps"))
+        options.dampingSteps = std::max(args.getValueForOption("--damping-steps").getIntValue(), 1);
+
+    if (args.containsOption("--tolerance-db"))
+        options.toleranceDb = args.getValueForOption("--tolerance-db").getDoubleValue();
+
+    return options;
+}
+
+// Evenly spaced grid over a parameter range, the middle of the range for a single step
+std::vector<float> makeGrid(float min, float max, int steps)
+{
+    std::vector<float> grid;
+    for (int i = 0; i < steps; ++i)
+        grid.push_back(steps > 1 ? min + (max - min) * static_cast<float>(i) / static_cast<float>(steps - 1) : 0.5f * (min + max));
+    return grid;
+}
+
+// Response of a cleared reverb to a unit impulse on both channels
+template <typename Reverb>
+juce::AudioBuffer<float> renderResponse(Reverb& reverb, int numSamples)
+{
+    juce::AudioBuffer<float> io(static_cast<int>(NumChannels), numSamples);
+    io.clear();
+    for (unsigned int ch = 0; ch < NumChannels; ++ch)
+        io.setSample(static_cast<int>(ch), 0, 1.f);
+
+    for (int pos = 0; pos < numSamples; pos += static_cast<int>(BlockSize))
+    {
+        juce::AudioBuffer<float> block(io.getArrayOfWritePointers(), static_cast<int>(NumChannels), pos,
+                                       std::min(static_cast<int>(BlockSize), numSamples - pos));
+        reverb.process(block.getArrayOfWritePointers(), block.getArrayOfReadPointers(), NumChannels,
+                       static_cast<unsigned int>(block.getNumSamples()));
+    }
+
+    return io;
+}
+
+juce::AudioBuffer<float> renderEntry(const DSP::ImpulseResponseCache::Entry& entry, double sampleRate, int numSamples)
+{
+    if (entry.reverb == DSP::ImpulseResponseCache::KeithBarr)
+    {
+        DSP::KeithBarrReverb reverb(NumChannels, entry.damping);
+        reverb.prepare(sampleRate, NumChannels);
+        reverb.setDampingCoeff(entry.damping);
+        return renderResponse(reverb, numSamples);
+    }
+
+    DSP::DattorroReverb reverb(sampleRate, NumChannels, entry.brightness, entry.decay);
+    reverb.prepare(sampleRate, NumChannels);
+    reverb.setBrightness(entry.brightness);
+    reverb.setDecay(entry.decay);
+    return renderResponse(reverb, numSamples);
+}
+
+// Number of samples up to the last one above TrimThreshold of the peak
+int getTrimmedLength(const juce::AudioBuffer<float>& response)
+{
+    const float threshold { TrimThreshold * response.getMagnitude(0, response.getNumSamples()) };
+
+    int length { 1 };
+    for (int ch = 0; ch < response.getNumChannels(); ++ch)
+        for (int n = response.getNumSamples() - 1; n >= length; --n)
+            if (std::abs(response.getSample(ch, n)) > threshold)
+            {
+                length = n + 1;
+                break;
+            }
+
+    return length;
+}
+
+// Render every grid point and write the cache
+// Returns the process exit code
+int capture(const Options& options)
+{
+    const int maxSamples { static_cast<int>(std::ceil(options.seconds * options.sampleRate)) };
+
+    std::vector<DSP::ImpulseResponseCache::Entry> entries;
+    for (float decay : makeGrid(Param::Ranges::DecayMin, Param::Ranges::DecayMax, options.decaySteps))
+        for (float brightness : makeGrid(Param::Ranges::BrightnessMin, Param::Ranges::BrightnessMax, options.brightnessSteps))
+            entries.push_back({ DSP::ImpulseResponseCache::Dattorro, NumChannels, 0, 0, decay, brightness, 0.f, 0.f, 0 });
+    for (float damping : makeGrid(Param::Ranges::DampCoeffMin, Param::Ranges::DampCoeffMax, options.dampingSteps))
+        entries.push_back({ DSP::ImpulseResponseCache::KeithBarr, NumChannels, 0, 0, 0.f, 0.f, damping, 0.f, 0 });
+
+    std::vector<juce::AudioBuffer<float>> responses;
+    for (auto& entry : entries)
+    {
+        responses.push_back(renderEntry(entry, options.sampleRate, maxSamples));
+        entry.numSamples = static_cast<uint32_t>(getTrimmedLength(responses.back()));
+
+        std::printf("%-9s decay %.3f brightness %.3f damping %.3f: %.3f s\n",
+                    entry.reverb == DSP::ImpulseResponseCache::Dattorro ? "Dattorro" : "KeithBarr",
+                    entry.decay, entry.brightness, entry.damping, entry.numSamples / options.sampleRate);
+    }
+
+    DSP::ImpulseResponseCache::Header header {};
+    header.sampleRate = options.sampleRate;
+    const uint64_t fileSize { DSP::ImpulseResponseCache::layout(header, entries) };
+
+    options.outputFile.deleteFile();
+    juce::FileOutputStream stream(options.outputFile);
+    if (stream.failedToOpen())
+        juce::ConsoleApplication::fail("Could not write " + options.outputFile.getFullPathName());
+
+    stream.write(&header, sizeof(header));
+    stream.writeRepeatedByte(0, header.entriesOffset - sizeof(header));
+    stream.write(entries.data(), entries.size() * sizeof(DSP::ImpulseResponseCache::Entry));
+
+    for (size_t i = 0; i < entries.size(); ++i)
+    {
+        stream.writeRepeatedByte(0, entries[i].dataOffset - static_cast<uint64_t>(stream.getPosition()));
+        for (unsigned int ch = 0; ch < NumChannels; ++ch)
+            stream.write(responses[i].getReadPointer(static_cast<int>(ch)), entries[i].numSamples * sizeof(float));
+    }
+
+    stream.flush();
+    if (stream.getStatus().failed() || static_cast<uint64_t>(stream.getPosition()) != fileSize)
+        juce::ConsoleApplication::fail("Could not write " + options.outputFile.getFullPathName());
+
+    std::printf("Wrote %zu responses at %.0f Hz, %.1f MB, to %s\n", entries.size(), options.sampleRate,
+                static_cast<double>(fileSize) / (1024.0 * 1024.0), options.outputFile.getFullPathName().toRawUTF8());
+
+    return 0;
+}
+
+// Render the grid points of a cache again and compare them with the cached responses
+// Returns the process exit code
+int compare(const Options& options)
+{
+    juce::MemoryMappedFile mappedFile(options.compareFile, juce::MemoryMappedFile::readOnly);
+    const DSP::ImpulseResponseCache cache(mappedFile.getData(), mappedFile.getSize());
+    if (!cache.isValid())
+        juce::ConsoleApplication::fail("Not an impulse response cache: " + options.compareFile.getFullPathName());
+
+    std::printf("Comparing %u responses at %.0f Hz, tolerance %.1f dB\n", cache.getNumEntries(), cache.getSampleRate(), options.toleranceDb);
+
+    int result { 0 };
+    for (unsigned int i = 0; i < cache.getNumEntries(); ++i)
+    {
+        const auto& entry { cache.getEntry(i) };
+        const int numSamples { static_cast<int>(entry.numSamples) };
+        const juce::AudioBuffer<float> response { renderEntry(entry, cache.getSampleRate(), numSamples) };
+
+        double maxError { 0.0 };
+        double peak { 0.0 };
+        for (unsigned int ch = 0; ch < std::min(entry.numChannels, NumChannels); ++ch)
+        {
+            const float* cached { cache.getChannel(i, ch) };
+            const float* rendered { response.getReadPointer(static_cast<int>(ch)) };
+            for (int n = 0; n < numSamples; ++n)
+            {
+                maxError = std::max(maxError, static_cast<double>(std::abs(rendered[n] - cached[n])));
+                peak = std::max(peak, static_cast<double>(std::abs(cached[n])));
+            }
+        }
+
+        const double errorDb { maxError > 0.0 ? 20.0 * std::log10(maxError / std::max(peak, 1e-30)) : -std::numeric_limits<double>::infinity() };
+        const bool passed { errorDb <= options.toleranceDb };
+
+        std::printf("%-9s decay %.3f brightness %.3f damping %.3f: %8.1f dB %s\n",
+                    entry.reverb == DSP::ImpulseResponseCache::Dattorro ? "Dattorro" : "KeithBarr",
+                    entry.decay, entry.brightness, entry.damping, errorDb, passed ? "PASS" : "FAIL");
+        if (!passed)
+            result = 1;
+    }
+
+    return result;
+}
+
+}
+
+int main(int argc, char* argv[])
+{
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+    return juce::ConsoleApplication::invokeCatchingFailures([&]
+    {
+        juce::ArgumentList args(argc, argv);
+
+        if (args.containsOption("--help|-h"))
+        {
+            printUsage();
+            return 0;
+        }
+
+        const Options options { parseOptions(args) };
+
+        if (options.compareFile != juce::File())
+            return compare(options);
+
+        if (options.outputFile != juce::File())
+            return capture(options);
+
+        printUsage();
+        return 1;
+    });
+}
\ No newline at end of file
@@ -181,6 +181,7 @@ void SynthAudioProcessor::releaseResources()
 void SynthAudioProcessor::processBlock(juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages)
 {
     juce::ScopedNoDenormals noDenormals;
+    mrta::RealtimeScope realtimeScope("SynthAudioProcessor::processBlock");
     paramManager.updateParameters();
 
     buffer.clear();